@@ -0,0 +1,48 @@
+if ("${TEXTURE_COOKER}" STREQUAL "")
+    message(FATAL_ERROR "Missing required variable TEXTURE_COOKER (texture cooker executable path)")
+endif ()
+
+if (NOT EXISTS ${TEXTURE_COOKER})
+    message(FATAL_ERROR "Could not find texture cooker [${TEXTURE_COOKER}]")
+endif ()
+
+if ("${TEXTURES_SOURCE_DIR}" STREQUAL "")
+    message(FATAL_ERROR "Missing required variable TEXTURES_SOURCE_DIR (texture source image directory path)")
+endif ()
+
+if (NOT EXISTS ${TEXTURES_SOURCE_DIR})
+    message(FATAL_ERROR "Could not find texture source image directory [${TEXTURES_SOURCE_DIR}]")
+endif ()
+
+if ("${TEXTURES_OUTPUT_DIR}" STREQUAL "")
+    message(FATAL_ERROR "Missing required variable TEXTURES_OUTPUT_DIR (cooked texture output directory path)")
+endif ()
+
+# Optional: Set TEXTURES_PREMULTIPLIED_ALPHA to cook textures with premultiplied alpha.
+set(COOKER_OPTIONS "")
+if (TEXTURES_PREMULTIPLIED_ALPHA)
+    list(APPEND COOKER_OPTIONS "--premultiplied-alpha")
+endif ()
+
+file(GLOB_RECURSE TEXTURE_FILES RELATIVE ${TEXTURES_SOURCE_DIR} "${TEXTURES_SOURCE_DIR}/*.png" "${TEXTURES_SOURCE_DIR}/*.jpg")
+
+foreach (TEXTURE_FILE ${TEXTURE_FILES})
+    set(INPUT_FILE "${TEXTURES_SOURCE_DIR}/${TEXTURE_FILE}")
+    string(REGEX REPLACE "\\.[^.]*$" ".sttex" OUTPUT_FILE_NAME ${TEXTURE_FILE})
+    set(OUTPUT_FILE "${TEXTURES_OUTPUT_DIR}/${OUTPUT_FILE_NAME}")
+
+    # Only cook images that have changed since they were last cooked.
+    if (EXISTS ${OUTPUT_FILE} AND ${OUTPUT_FILE} IS_NEWER_THAN ${INPUT_FILE})
+        continue()
+    endif ()
+
+    execute_process(
+            COMMAND ${TEXTURE_COOKER} ${COOKER_OPTIONS} ${INPUT_FILE} ${OUTPUT_FILE}
+            RESULT_VARIABLE result
+    )
+    if (result EQUAL 0)
+        message("Cooked texture [${INPUT_FILE}] to [${OUTPUT_FILE}]")
+    else ()
+        message(FATAL_ERROR "Could not cook texture [${INPUT_FILE}]")
+    endif ()
+endforeach ()
@@ -32,6 +32,7 @@
 #include "graphics/st_bitmap_font.h"
 #include "graphics/st_camera.h"
 #include "graphics/st_imgui_renderer.h"
+#include "graphics/st_particle_system.h"
 #include "graphics/st_spritesheet.h"
 #include "graphics/st_view_projection.h"
 
@@ -57,8 +58,10 @@
 #include "resource/st_resource_loader.h"
 
 // Scene
+#include "scene/st_components.h"
 #include "scene/st_entity.h"
 #include "scene/st_scene.h"
+#include "scene/st_sprite_render_system.h"
 
 // Shapes
 #include "shapes/st_ellipse.h"
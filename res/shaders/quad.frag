@@ -4,15 +4,30 @@
 layout(set = 0, binding = 0) uniform sampler2D texture_samplers[16];
 
 // Data exposed from the vertex shader.
-layout(location = 0) in struct VertexOutput {
+layout(location = 0) in VertexOutput {
     vec4 color;
     vec2 texture_coordinate;
-    float texture_index;
+    flat uint texture_index;
+    flat uint texture_premultiplied_alpha;
 } vertex_output;
 
 // The final fragment color.
 layout(location = 0) out vec4 fragment_color;
 
+// Whether fully transparent fragments are discarded. Enabled for pipelines that blend and write depth (static batches),
+// so that transparent parts of their quads don't hide the quads behind them.
+layout(constant_id = 0) const bool alpha_discard_enabled = false;
+
 void main() {
-    fragment_color = texture(texture_samplers[int(vertex_output.texture_index)], vertex_output.texture_coordinate) * vertex_output.color;
+    vec4 texture_color = texture(texture_samplers[vertex_output.texture_index], vertex_output.texture_coordinate);
+
+    // Quads are blended with premultiplied alpha, so textures with straight alpha are premultiplied when sampled.
+    if (vertex_output.texture_premultiplied_alpha == 0u) {
+        texture_color.rgb *= texture_color.a;
+    }
+
+    fragment_color = texture_color * vertex_output.color;
+    if (alpha_discard_enabled && fragment_color.a == 0.0) {
+        discard;
+    }
 }
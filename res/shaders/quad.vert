@@ -10,21 +10,25 @@ layout(location = 0) in vec4 position;
 layout(location = 1) in vec2 texture_coordinate;
 
 // Binding 1: Instance vertex buffer.
-layout(location = 2) in vec4 model_1;
-layout(location = 3) in vec4 model_2;
-layout(location = 4) in vec4 model_3;
-layout(location = 5) in vec4 model_4;
-layout(location = 6) in vec4 color;
-layout(location = 7) in vec4 texture_rectangle;
-layout(location = 8) in float texture_index;
+layout(location = 2) in vec4 transform; // Linear part of the 2D affine transform: x-axis (xy), y-axis (zw).
+layout(location = 3) in vec3 translation; // Position (xy) and depth (z).
+layout(location = 4) in vec4 color; // Packed as RGBA8 (unorm).
+layout(location = 5) in vec4 texture_rectangle; // Packed as 4x unorm16.
+layout(location = 6) in uint texture_index; // The highest bit is set for textures with premultiplied alpha.
+layout(location = 7) in uint layer;
 
 // Data exposed to fragment shader.
-layout(location = 0) out struct VertexOutput {
+layout(location = 0) out VertexOutput {
     vec4 color;
     vec2 texture_coordinate;
-    float texture_index;
+    flat uint texture_index;
+    flat uint texture_premultiplied_alpha;
 } vertex_output;
 
+// Set in the texture index of quads whose texture has premultiplied alpha.
+// Must match `quad_texture_index_premultiplied_alpha_bit` in st_quad_vertex.h.
+const uint TEXTURE_PREMULTIPLIED_ALPHA = 0x80000000u;
+
 // Determine fragment shader texture coordinate (UV).
 //
 // Definitions:
@@ -54,11 +58,45 @@ vec2 get_texture_coordinate() {
     return mix(texture_rectangle.xy, texture_rectangle.zw, texture_coordinate);
 }
 
+// Transform the base quad vertex to world space with the instance's 2D affine transform.
+//
+// This is equivalent to multiplying with a model matrix whose first two columns are the x- and y-axes of the transform
+// and whose last column is the translation, but without having to pass a full 4x4 matrix per instance.
+vec4 get_world_position() {
+    vec2 world_position = transform.xy * position.x + transform.zw * position.y + translation.xy;
+    return vec4(world_position, translation.z, 1.0);
+}
+
+// The number of bits of the projected depth of a quad that are kept in the depth that is tested.
+const uint QUANTIZED_DEPTH_BITS = 7u;
+const uint QUANTIZED_DEPTH_MAX = (1u << QUANTIZED_DEPTH_BITS) - 1u;
+
+// Map the layer and the projected depth of the quad to a depth between the near plane (0) and the far plane (1).
+//
+// The layer (16 bits) and the projected depth quantized to 7 bits make up a 23-bit depth order, where higher layers
+// are always closer, and quads with a lower depth are closer within a layer. Every depth is a multiple of 2^-23, so
+// neighbouring orders stay distinct in both 32-bit float and 24-bit unorm depth buffers. The depth buffer is cleared
+// to the far plane, so even layer 0 passes the depth test against an empty depth buffer.
+//
+// Only opaque quads, static batches and tile layers write depth, so the depth orders translucent quads against those,
+// but not against each other. Translucent quads are ordered by layer and depth when deferred rendering sorts them.
+// Must match get_layer_depth() in the tile layer vertex shader.
+float get_layer_depth(float projected_depth) {
+    uint quantized_depth = uint(clamp(projected_depth, 0.0, 1.0) * float(QUANTIZED_DEPTH_MAX) + 0.5);
+    uint depth_order = (layer << QUANTIZED_DEPTH_BITS) | (QUANTIZED_DEPTH_MAX - quantized_depth);
+    return 1.0 - float(depth_order + 1u) / 8388608.0;
+}
+
 void main() {
-    mat4 model = mat4(model_1, model_2, model_3, model_4);
-    gl_Position = view_projection.projection * view_projection.view * model * position;
+    gl_Position = view_projection.projection * view_projection.view * get_world_position();
+
+    // The depth that is tested is the depth of the layer, and the projected depth of the quad only orders quads within
+    // the layer. Scaled by w so that it's unchanged by the perspective divide.
+    gl_Position.z = get_layer_depth(gl_Position.z / gl_Position.w) * gl_Position.w;
 
-    vertex_output.color = color;
-    vertex_output.texture_index = texture_index;
+    // Quads are blended with premultiplied alpha, so the color is premultiplied as well.
+    vertex_output.color = vec4(color.rgb * color.a, color.a);
+    vertex_output.texture_index = texture_index & ~TEXTURE_PREMULTIPLIED_ALPHA;
+    vertex_output.texture_premultiplied_alpha = texture_index & TEXTURE_PREMULTIPLIED_ALPHA;
     vertex_output.texture_coordinate = get_texture_coordinate();
 }
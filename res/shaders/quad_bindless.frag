@@ -0,0 +1,36 @@
+#version 450
+
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Set 0: Bindless textures. All textures are bound at once and indexed with the persistent index of the texture.
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+// Data exposed from the vertex shader.
+layout(location = 0) in VertexOutput {
+    vec4 color;
+    vec2 texture_coordinate;
+    flat uint texture_index;
+    flat uint texture_premultiplied_alpha;
+} vertex_output;
+
+// The final fragment color.
+layout(location = 0) out vec4 fragment_color;
+
+// Whether fully transparent fragments are discarded. Enabled for pipelines that blend and write depth (static batches),
+// so that transparent parts of their quads don't hide the quads behind them.
+layout(constant_id = 0) const bool alpha_discard_enabled = false;
+
+void main() {
+    // The texture index can differ between quads in the same draw call, so it must be marked as non-uniform.
+    vec4 texture_color = texture(textures[nonuniformEXT(vertex_output.texture_index)], vertex_output.texture_coordinate);
+
+    // Quads are blended with premultiplied alpha, so textures with straight alpha are premultiplied when sampled.
+    if (vertex_output.texture_premultiplied_alpha == 0u) {
+        texture_color.rgb *= texture_color.a;
+    }
+
+    fragment_color = texture_color * vertex_output.color;
+    if (alpha_discard_enabled && fragment_color.a == 0.0) {
+        discard;
+    }
+}
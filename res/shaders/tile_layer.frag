@@ -0,0 +1,37 @@
+#version 450
+
+// The tileset texture of the draw. Without descriptor indexing, the index of a sampler array must be uniform within a
+// draw, so the layer is drawn once per tileset texture. Must match the offset in `TileLayerPushConstants`.
+layout(push_constant) uniform TileLayer {
+    layout(offset = 92) uint texture_index;
+} tile_layer;
+
+// Set 0, Binding 2: Tileset textures.
+layout(set = 0, binding = 2) uniform sampler2D texture_samplers[16];
+
+// Data exposed from the vertex shader.
+layout(location = 0) in VertexOutput {
+    vec2 texture_coordinate;
+    flat uint texture_index;
+    flat uint texture_premultiplied_alpha;
+} vertex_output;
+
+// The final fragment color.
+layout(location = 0) out vec4 fragment_color;
+
+void main() {
+    vec4 color = texture(texture_samplers[tile_layer.texture_index], vertex_output.texture_coordinate);
+
+    // Tiles write depth, so their fully transparent parts are discarded, or they would hide the layers and quads that
+    // are drawn behind them afterwards.
+    if (color.a == 0.0) {
+        discard;
+    }
+
+    // Tiles are blended with premultiplied alpha, so tilesets with straight alpha are premultiplied when sampled.
+    if (vertex_output.texture_premultiplied_alpha == 0u) {
+        color.rgb *= color.a;
+    }
+
+    fragment_color = color;
+}
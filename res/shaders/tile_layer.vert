@@ -0,0 +1,121 @@
+#version 450
+
+layout(push_constant) uniform TileLayer {
+    mat4 view_projection;
+    vec2 offset; // World-space offset of the layer, including its parallax offset.
+    vec2 tile_size;
+    uint width;
+    uint height;
+    uint layer;
+    uint texture_index; // The only tileset texture to draw tiles of, or ALL_TEXTURES.
+} tile_layer;
+
+struct TileData {
+    vec4 texture_rectangle;
+    uint texture_index; // The highest bit is set for textures with premultiplied alpha.
+};
+
+// Set 0, Binding 0: Global tile IDs (GIDs) of the layer, including the Tiled flip bits, one per tile (row-major).
+layout(std430, set = 0, binding = 0) readonly buffer TileIds {
+    uint tile_ids[];
+};
+
+// Set 0, Binding 1: Texture rectangle and tileset texture of every tile, indexed by GID (without flip bits).
+layout(std430, set = 0, binding = 1) readonly buffer TileDataLookup {
+    TileData tile_data[];
+};
+
+// Data exposed to fragment shader.
+layout(location = 0) out VertexOutput {
+    vec2 texture_coordinate;
+    flat uint texture_index;
+    flat uint texture_premultiplied_alpha;
+} vertex_output;
+
+// Tiled stores transformations in the highest bits of the GID.
+// See: https://doc.mapeditor.org/en/stable/reference/global-tile-ids/#gid-tile-flipping
+const uint FLIPPED_HORIZONTALLY = 0x80000000u;
+const uint FLIPPED_VERTICALLY = 0x40000000u;
+const uint FLIPPED_DIAGONALLY = 0x20000000u;
+const uint TILE_ID_MASK = 0x0FFFFFFFu;
+
+// Set in the texture index of tiles whose tileset texture has premultiplied alpha.
+// Must match `quad_texture_index_premultiplied_alpha_bit` in st_quad_vertex.h.
+const uint TEXTURE_PREMULTIPLIED_ALPHA = 0x80000000u;
+
+// Draw the tiles of all tileset textures. Must match `tile_layer_all_textures` in st_tile_layer.h.
+const uint ALL_TEXTURES = 0xFFFFFFFFu;
+
+// The corners of the two triangles that make up a tile, in the same order as the base quad indices (0, 1, 2, 2, 3, 0).
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), // Top left
+    vec2(1.0, 0.0), // Top right
+    vec2(1.0, 1.0), // Bottom right
+    vec2(1.0, 1.0), // Bottom right
+    vec2(0.0, 1.0), // Bottom left
+    vec2(0.0, 0.0)  // Top left
+);
+
+// Determine which corner of the tile image to sample for a corner of the tile.
+//
+// Tiled flips the tile image diagonally (swapping x and y) first, and then horizontally and vertically. To find the
+// texture coordinate for a corner, the inverse is applied to the corner: horizontal and vertical flips first, and then
+// the diagonal flip.
+vec2 get_tile_texture_coordinate(vec2 corner, uint flags) {
+    vec2 texture_coordinate = corner;
+    if ((flags & FLIPPED_HORIZONTALLY) != 0u) {
+        texture_coordinate.x = 1.0 - texture_coordinate.x;
+    }
+    if ((flags & FLIPPED_VERTICALLY) != 0u) {
+        texture_coordinate.y = 1.0 - texture_coordinate.y;
+    }
+    if ((flags & FLIPPED_DIAGONALLY) != 0u) {
+        texture_coordinate = texture_coordinate.yx;
+    }
+    return texture_coordinate;
+}
+
+// The number of bits of the projected depth of a tile that are kept in the depth that is tested.
+const uint QUANTIZED_DEPTH_BITS = 7u;
+const uint QUANTIZED_DEPTH_MAX = (1u << QUANTIZED_DEPTH_BITS) - 1u;
+
+// Map the layer and the projected depth of the tile to a depth between the near plane (0) and the far plane (1), where
+// higher layers are closer. Tiles are at depth 0 in world space, so they are ordered like quads at depth 0.
+// Must match get_layer_depth() in the quad vertex shader.
+float get_layer_depth(float projected_depth) {
+    uint quantized_depth = uint(clamp(projected_depth, 0.0, 1.0) * float(QUANTIZED_DEPTH_MAX) + 0.5);
+    uint depth_order = (tile_layer.layer << QUANTIZED_DEPTH_BITS) | (QUANTIZED_DEPTH_MAX - quantized_depth);
+    return 1.0 - float(depth_order + 1u) / 8388608.0;
+}
+
+void main() {
+    uint tile_index = gl_InstanceIndex;
+    uint gid = tile_ids[tile_index];
+    uint tile_id = gid & TILE_ID_MASK;
+
+    // Empty tiles (GID 0), and tiles of other tileset textures than the one of the draw, are collapsed to a single
+    // point outside of the clip volume, so they produce no fragments.
+    bool other_texture = tile_layer.texture_index != ALL_TEXTURES
+        && (tile_data[tile_id].texture_index & ~TEXTURE_PREMULTIPLIED_ALPHA) != tile_layer.texture_index;
+    if (tile_id == 0u || other_texture) {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+        vertex_output.texture_coordinate = vec2(0.0);
+        vertex_output.texture_index = 0u;
+        vertex_output.texture_premultiplied_alpha = 0u;
+        return;
+    }
+
+    vec2 corner = corners[gl_VertexIndex];
+    vec2 tile_position = vec2(tile_index % tile_layer.width, tile_index / tile_layer.width);
+    vec2 world_position = (tile_position + corner) * tile_layer.tile_size + tile_layer.offset;
+
+    gl_Position = tile_layer.view_projection * vec4(world_position, 0.0, 1.0);
+    gl_Position.z = get_layer_depth(gl_Position.z / gl_Position.w) * gl_Position.w;
+
+    TileData tile = tile_data[tile_id];
+    vec2 tile_texture_coordinate = get_tile_texture_coordinate(corner, gid);
+
+    vertex_output.texture_coordinate = mix(tile.texture_rectangle.xy, tile.texture_rectangle.zw, tile_texture_coordinate);
+    vertex_output.texture_index = tile.texture_index & ~TEXTURE_PREMULTIPLIED_ALPHA;
+    vertex_output.texture_premultiplied_alpha = tile.texture_index & TEXTURE_PREMULTIPLIED_ALPHA;
+}
@@ -0,0 +1,16 @@
+#version 450
+
+// Set 0, Binding 0: The low-resolution render target.
+layout(set = 0, binding = 0) uniform sampler2D render_target;
+
+// Data exposed from the vertex shader.
+layout(location = 0) in VertexOutput {
+    vec2 texture_coordinate;
+} vertex_output;
+
+// The final fragment color.
+layout(location = 0) out vec4 fragment_color;
+
+void main() {
+    fragment_color = texture(render_target, vertex_output.texture_coordinate);
+}
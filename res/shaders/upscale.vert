@@ -0,0 +1,14 @@
+#version 450
+
+// Data exposed to fragment shader.
+layout(location = 0) out VertexOutput {
+    vec2 texture_coordinate;
+} vertex_output;
+
+void main() {
+    // A single triangle that covers the whole viewport, generated from the vertex index (0, 1, 2) without any vertex
+    // input. The parts of the triangle that are outside of the viewport are clipped.
+    vec2 texture_coordinate = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(texture_coordinate * 2.0 - 1.0, 0.0, 1.0);
+    vertex_output.texture_coordinate = texture_coordinate;
+}
@@ -1,69 +1,88 @@
 #include "st_bitmap_font.h"
 
 namespace Storytime {
-    BitmapFont::BitmapFont(const BitmapFontConfig& config) : config(config) {}
+    BitmapFont::BitmapFont(const BitmapFontConfig& config) : config(config) {
+        ST_ASSERT_NOT_NULL(config.texture);
+
+        f32 texture_width = (f32) config.texture->get_width();
+        f32 texture_height = (f32) config.texture->get_height();
+
+        // Precompute the texture rectangle of every glyph, packed the way the renderer uploads it.
+        for (const auto& [character, coordinate] : config.coordinates) {
+            auto [column, row] = coordinate;
+
+            f32 x_left = (f32) column * config.glyph_width;
+            f32 x_right = x_left + config.glyph_width;
+            f32 y_top = (f32) row * config.glyph_height;
+            f32 y_bottom = y_top + config.glyph_height;
+
+            glm::vec4 texture_rectangle = {
+                x_left / texture_width,
+                y_top / texture_height,
+                x_right / texture_width,
+                y_bottom / texture_height,
+            };
+
+            BitmapGlyph& glyph = glyphs[(u8) character];
+            glyph.texture_rectangle = glm::packUnorm4x16(texture_rectangle);
+            glyph.valid = true;
+        }
+    }
 
     void BitmapFont::render_text(const std::string& text, const BitmapTextConfig& text_config) const {
-        float gw = config.glyph_width;
-        float gh = config.glyph_height;
-        float ts = config.texture->get_width();
+        text_quads.clear();
+        layout_text(text, text_config, text_quads);
+        render_glyphs(text_quads);
+    }
 
-        f32 size_x = text_config.font_size * (gw / gh);
+    void BitmapFont::layout_text(std::string_view text, const BitmapTextConfig& text_config, std::vector<QuadInstanceData>& quads) const {
+        f32 size_x = text_config.font_size * (config.glyph_width / config.glyph_height);
         f32 size_y = text_config.font_size;
 
-        glm::vec3 position = text_config.position;
+        // Glyphs are only scaled and translated, so the transform is the same for all of them.
+        glm::vec4 transform = { size_x, 0.0f, 0.0f, size_y };
+
+        glm::vec2 position = glm::vec2(text_config.position);
+
+        quads.reserve(quads.size() + (text_config.debug ? text.size() * 2 : text.size()));
 
-        for (int i = 0; i < text.size(); ++i) {
-            const char value = text[i];
+        for (u32 i = 0; i < text.size(); i++) {
+            const char character = text[i];
 
-            if (value == '\n') {
+            if (character == '\n') {
                 position.y += size_y;
                 position.x = text_config.position.x;
                 continue;
             }
 
-            auto it = config.coordinates.find(value);
-
-            u32 col = it->second.first;
-            u32 row = it->second.second;
-
-            float xa = static_cast<float>(col) * gw;
-            float xb = xa + gw;
-
-            float ya = static_cast<float>(row) * gh;
-            float yb = ya + gh;
-
-            float xat = xa / ts;
-            float xbt = xb / ts;
-
-            float yat = ya / ts;
-            float ybt = yb / ts;
-
-            glm::vec4 c = { xat, yat, xbt, ybt };
-
-            glm::vec3 p = { position.x, position.y, 0.0f };
-            glm::vec3 s = { size_x, size_y, 0.0f };
-
-            glm::mat4 translation = glm::translate(glm::mat4(1.0f), p);
-            glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(0.0f), { 0.0f, 0.0f, 1.0f });
-            glm::mat4 scale = glm::scale(glm::mat4(1.0f), s);
-
-            glm::mat4 model = translation * rotation * scale;
+            const BitmapGlyph& glyph = glyphs[(u8) character];
+            if (!glyph.valid) {
+                position.x += size_x;
+                continue;
+            }
 
-            Quad quad{};
-            quad.texture = config.texture;
-            quad.model = model;
-            quad.texture_rectangle = c;
+            QuadInstanceData quad{};
+            quad.transform = transform;
+            quad.position = position;
+            quad.texture_rectangle = glyph.texture_rectangle;
 
             if (text_config.debug) {
-                Quad debug_quad = quad;
-                debug_quad.color = { (f32) i, (f32) i, (f32) i, 0.5f };
-                config.renderer.render_quad(debug_quad);
+                QuadInstanceData debug_quad = quad;
+                debug_quad.color = glm::packUnorm4x8(glm::vec4{ (f32) i, (f32) i, (f32) i, 0.5f });
+                quads.push_back(debug_quad);
             }
 
-            config.renderer.render_quad(quad);
+            quads.push_back(quad);
 
             position.x += size_x;
         }
     }
+
+    void BitmapFont::render_glyphs(const std::vector<QuadInstanceData>& quads) const {
+        config.renderer.render_quads(config.texture, quads.data(), (u32) quads.size());
+    }
+
+    const BitmapGlyph& BitmapFont::get_glyph(char character) const {
+        return glyphs[(u8) character];
+    }
 }
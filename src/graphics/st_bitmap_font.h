@@ -18,13 +18,41 @@ namespace Storytime {
         bool debug = false;
     };
 
+    struct BitmapGlyph {
+        /// The texture rectangle of the glyph, packed like `QuadInstanceData::texture_rectangle` (four unorm16 values).
+        u64 texture_rectangle = 0;
+
+        /// Whether the font has a glyph for the character.
+        bool valid = false;
+    };
+
     class BitmapFont {
+    public:
+        static constexpr u32 glyph_count = 256;
+
     private:
         BitmapFontConfig config;
 
+        /// Glyphs indexed by character, so that laying out text doesn't need a map lookup per character.
+        std::array<BitmapGlyph, glyph_count> glyphs{};
+
+        /// Reused by `render_text` so that laying out text doesn't allocate every frame.
+        mutable std::vector<QuadInstanceData> text_quads;
+
     public:
         BitmapFont(const BitmapFontConfig& config);
 
+        /// Lay out and render text. Text that doesn't change from frame to frame should be rendered with a `TextMesh`
+        /// instead, which only lays it out when it changes.
         void render_text(const std::string& text, const BitmapTextConfig& text_config = {}) const;
+
+        /// Lay out the text as quad instances, one per glyph, appended to `quads`. Characters that the font has no
+        /// glyph for are skipped, but still advance the position.
+        void layout_text(std::string_view text, const BitmapTextConfig& text_config, std::vector<QuadInstanceData>& quads) const;
+
+        /// Render quad instances that have been laid out by this font.
+        void render_glyphs(const std::vector<QuadInstanceData>& quads) const;
+
+        const BitmapGlyph& get_glyph(char character) const;
     };
 }
@@ -1,21 +1,60 @@
 #pragma once
 
+#include "graphics/st_quad_culling.h"
 #include "graphics/st_quad_vertex.h"
+#include "graphics/st_view_projection.h"
+#include "graphics/st_vulkan_buffer.h"
 #include "graphics/st_vulkan_command_buffer.h"
 #include "graphics/st_vulkan_descriptor_set.h"
 #include "graphics/st_vulkan_image.h"
 #include "graphics/st_vulkan_queue.h"
 #include "graphics/st_vulkan_uniform_buffer.h"
 #include "graphics/st_vulkan_vertex_buffer.h"
+#include "utils/st_radix_sort.h"
 
 namespace Storytime {
     struct Batch {
-        VulkanVertexBuffer vertex_buffer{};
+        /// The index of the first quad of the batch in the instance buffer of its frame.
+        u32 first_quad = 0;
         VulkanDescriptorSet descriptor_set = nullptr;
-        std::vector<QuadInstanceData> quads{};
+        /// Write cursor for quad instances. Points directly into the mapped instance buffer of the frame when direct
+        /// instance writes are enabled, otherwise into `staged_quads`, which is uploaded to the instance buffer when
+        /// flushed.
+        QuadInstanceData* quads = nullptr;
+        std::vector<QuadInstanceData> staged_quads{};
         u32 quad_index = 0;
-        std::vector<std::shared_ptr<VulkanImage>> textures{};
+        /// The textures bound to the batch's sampler slots. The batch does not own the textures, they are kept alive by
+        /// the `textures` of its frame.
+        std::vector<const VulkanImage*> textures{};
+        /// Lookup from texture ID (see `VulkanImage::get_id`) to its sampler slot in `textures`.
+        std::unordered_map<u32, u32> texture_slots{};
         u32 texture_index = 0;
+        /// The IDs of the textures that were last written to the descriptor set, by sampler slot. Used to skip writing
+        /// the descriptor set when the batch is flushed with the same textures as last time.
+        std::vector<u32> descriptor_texture_ids{};
+        /// Whether the batch holds opaque quads, which are drawn with the opaque quad pipeline.
+        bool opaque = false;
+    };
+
+    /// A quad that has been packed ahead of being added to a batch, f.ex. after all deferred quads have been sorted, or
+    /// when the render context it was rendered to is merged.
+    struct QuadCommand {
+        QuadInstanceData instance_data{};
+        /// Not owned, kept alive by the `textures` of the frame (or the render context) that the quad was rendered to.
+        const VulkanImage* texture = nullptr;
+        bool opaque = false;
+    };
+
+    /// Timestamps that are written to fixed queries of the timestamp query pool of every frame. Every range begins at
+    /// an even query and ends at the following odd query. The queries after these are used for ranges around draws.
+    enum class GpuTimestamp : u32 {
+        FRAME_BEGIN = 0,
+        FRAME_END = 1,
+        SCENE_BEGIN = 2,
+        SCENE_END = 3,
+        IMGUI_BEGIN = 4,
+        IMGUI_END = 5,
+        COUNT = 6,
     };
 
     struct Frame {
@@ -29,5 +68,50 @@ namespace Storytime {
         VulkanUniformBuffer uniform_buffer{};
         std::vector<Batch> batches{};
         u32 batch_index = 0;
+        /// The instance data of all batches, in one buffer so that consecutive batches can be drawn with one indirect
+        /// draw. Every batch owns a fixed range of quads, starting at its `first_quad`.
+        VulkanVertexBuffer instance_buffer{};
+        /// One indexed indirect draw command per batch, at the index of the batch.
+        VulkanBuffer indirect_buffer{};
+        VkDrawIndexedIndirectCommand* indirect_commands = nullptr;
+        /// The number of batches that the instance and indirect buffers have room for.
+        u32 batch_capacity = 0;
+        /// Instance and indirect buffers that the frame has outgrown. They may still be read by the previous submission
+        /// of the frame, so they are kept alive until the frame is rendered again.
+        std::vector<VulkanVertexBuffer> retired_instance_buffers{};
+        std::vector<VulkanBuffer> retired_indirect_buffers{};
+        /// Batches that have been flushed but not drawn yet, to be drawn together.
+        u32 pending_draw_batch_index = 0;
+        u32 pending_draw_batch_count = 0;
+        /// Keeps the textures that the batches and quad commands of the frame refer to alive until the frame has
+        /// finished rendering, with one reference per texture by texture ID. Released when the frame is rendered again.
+        std::unordered_map<u32, Shared<VulkanImage>> textures{};
+        /// The ID of the texture that was last added to `textures`, so that runs of quads with the same texture skip
+        /// the lookup (0 = none, texture IDs start at 1).
+        u32 last_retained_texture_id = 0;
+        /// Quads submitted for deferred rendering, in submission order, and their sort keys.
+        std::vector<QuadCommand> quad_commands{};
+        std::vector<RadixSortEntry> quad_sort_entries{};
+        std::vector<RadixSortEntry> quad_sort_scratch{};
+        /// View projections set for deferred rendering. Quads refer to them by index in their sort key.
+        std::vector<ViewProjection> view_projections{};
+        /// Scratch buffer that `render_quads` compacts the quads that survive culling into, reused between calls.
+        std::vector<QuadInstanceData> visible_quads{};
+        /// The world-space rectangles visible through each of the view projections, when quad culling is enabled.
+        std::vector<QuadCullRectangle> view_cull_rectangles{};
+        /// The quad pipeline (opaque, translucent or static batch) that is bound to the command buffer, if any.
+        VkPipeline quad_graphics_pipeline = nullptr;
+        /// The view projection that was last pushed to the command buffer for the quad pipeline.
+        ViewProjection view_projection{};
+        /// The world-space rectangle visible through the current view projection, when quad culling is enabled.
+        QuadCullRectangle cull_rectangle{};
+        bool cull_rectangle_set = false;
+        /// Timestamps written by the GPU while rendering the frame. They are read back when the frame is rendered
+        /// again, once its fence has been waited on.
+        VkQueryPool timestamp_query_pool = nullptr;
+        /// The number of queries that were used by the last submission of the frame, or zero if there are no results.
+        u32 timestamp_query_count = 0;
+        /// Query results and their availability, reused between frames.
+        std::vector<u64> timestamp_results{};
     };
 }
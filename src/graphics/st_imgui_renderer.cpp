@@ -38,7 +38,7 @@ namespace Storytime {
         vulkan_init_info.PipelineInfoMain.RenderPass = config.swapchain.get_render_pass();
         vulkan_init_info.PipelineInfoMain.Subpass = 0;
         vulkan_init_info.PipelineInfoMain.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
-        vulkan_init_info.PipelineCache = nullptr;
+        vulkan_init_info.PipelineCache = config.device.get_pipeline_cache();
         vulkan_init_info.Allocator = nullptr;
         vulkan_init_info.CheckVkResultFn = on_check_vk_result;
         ImGui_ImplVulkan_Init(&vulkan_init_info);
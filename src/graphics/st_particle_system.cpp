@@ -0,0 +1,147 @@
+#include "st_particle_system.h"
+#include "system/st_random.h"
+
+namespace Storytime {
+    ParticleSystem::ParticleSystem(const Config& config)
+        : config(config.assert_valid()),
+          position_x(config.capacity),
+          position_y(config.capacity),
+          depth(config.capacity),
+          velocity_x(config.capacity),
+          velocity_y(config.capacity),
+          lifetime(config.capacity),
+          inverse_max_lifetime(config.capacity),
+          size(config.capacity),
+          color(config.capacity)
+    {
+    }
+
+    u32 ParticleSystem::get_count() const {
+        return count;
+    }
+
+    u32 ParticleSystem::get_capacity() const {
+        return config.capacity;
+    }
+
+    void ParticleSystem::emit(const ParticleEmitConfig& emit_config) {
+        u32 emit_count = std::min(emit_config.count, config.capacity - count);
+        u32 packed_color = glm::packUnorm4x8(emit_config.color);
+
+        for (u32 i = count; i < count + emit_count; i++) {
+            position_x[i] = emit_config.position.x + Random::get_float(-emit_config.position_variance.x, emit_config.position_variance.x);
+            position_y[i] = emit_config.position.y + Random::get_float(-emit_config.position_variance.y, emit_config.position_variance.y);
+            depth[i] = emit_config.position.z;
+            velocity_x[i] = emit_config.velocity.x + Random::get_float(-emit_config.velocity_variance.x, emit_config.velocity_variance.x);
+            velocity_y[i] = emit_config.velocity.y + Random::get_float(-emit_config.velocity_variance.y, emit_config.velocity_variance.y);
+            f32 max_lifetime = std::max(emit_config.lifetime + Random::get_float(-emit_config.lifetime_variance, emit_config.lifetime_variance), 0.0001f);
+            lifetime[i] = max_lifetime;
+            inverse_max_lifetime[i] = 1.0f / max_lifetime;
+            size[i] = emit_config.size + Random::get_float(-emit_config.size_variance, emit_config.size_variance);
+            color[i] = packed_color;
+        }
+
+        count += emit_count;
+    }
+
+    void ParticleSystem::update(f64 timestep) {
+        integrate((f32) timestep);
+        remove_dead_particles();
+    }
+
+    void ParticleSystem::render() const {
+        //
+        // Write the particles as quad instances straight into the renderer's instance memory.
+        //
+        // The reservation may be smaller than what's left to render when the current batch fills up, in which case
+        // the rest is written to the next batch.
+        //
+
+        constexpr u32 alpha_shift = 24;
+        constexpr u32 rgb_mask = 0x00FFFFFF;
+        const u64 texture_rectangle = QuadInstanceData{}.texture_rectangle;
+
+        u32 rendered_count = 0;
+        while (rendered_count < count) {
+            QuadReservation reservation = config.renderer.reserve_quads(config.texture, count - rendered_count, config.layer);
+            ST_ASSERT_GREATER_THAN_ZERO(reservation.capacity);
+
+            for (u32 i = 0; i < reservation.capacity; i++) {
+                u32 particle = rendered_count + i;
+                f32 particle_size = size[particle];
+                f32 half_size = particle_size * 0.5f;
+
+                u32 particle_color = color[particle];
+                if (config.fade_out) {
+                    f32 alpha = (f32) (particle_color >> alpha_shift) * lifetime[particle] * inverse_max_lifetime[particle];
+                    particle_color = (particle_color & rgb_mask) | ((u32) alpha << alpha_shift);
+                }
+
+                // Particles are centered on their position.
+                QuadInstanceData& quad = reservation.quads[i];
+                quad.transform = { particle_size, 0.0f, 0.0f, particle_size };
+                quad.position = { position_x[particle] - half_size, position_y[particle] - half_size };
+                quad.depth = depth[particle];
+                quad.color = particle_color;
+                quad.texture_rectangle = texture_rectangle;
+                quad.texture_index = reservation.texture_index;
+                quad.layer = reservation.layer;
+            }
+
+            config.renderer.commit_quads(reservation.capacity);
+            rendered_count += reservation.capacity;
+        }
+    }
+
+    void ParticleSystem::clear() {
+        count = 0;
+    }
+
+    void ParticleSystem::integrate(f32 timestep) {
+        // Every loop touches only a few of the arrays, with no dependencies between iterations, so they are compiled
+        // to SIMD instructions.
+        f32* __restrict px = position_x.data();
+        f32* __restrict py = position_y.data();
+        f32* __restrict vx = velocity_x.data();
+        f32* __restrict vy = velocity_y.data();
+        f32* __restrict life = lifetime.data();
+
+        f32 acceleration_x = config.acceleration.x * timestep;
+        f32 acceleration_y = config.acceleration.y * timestep;
+
+        for (u32 i = 0; i < count; i++) {
+            vx[i] += acceleration_x;
+            vy[i] += acceleration_y;
+        }
+        for (u32 i = 0; i < count; i++) {
+            px[i] += vx[i] * timestep;
+            py[i] += vy[i] * timestep;
+        }
+        for (u32 i = 0; i < count; i++) {
+            life[i] -= timestep;
+        }
+    }
+
+    void ParticleSystem::remove_dead_particles() {
+        // Iterate backwards, so that the particle that is moved into a removed slot has already been checked.
+        for (u32 i = count; i > 0; i--) {
+            if (lifetime[i - 1] <= 0.0f) {
+                remove_particle(i - 1);
+            }
+        }
+    }
+
+    void ParticleSystem::remove_particle(u32 index) {
+        u32 last = count - 1;
+        position_x[index] = position_x[last];
+        position_y[index] = position_y[last];
+        depth[index] = depth[last];
+        velocity_x[index] = velocity_x[last];
+        velocity_y[index] = velocity_y[last];
+        lifetime[index] = lifetime[last];
+        inverse_max_lifetime[index] = inverse_max_lifetime[last];
+        size[index] = size[last];
+        color[index] = color[last];
+        count--;
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "graphics/st_renderer.h"
+#include "graphics/st_texture.h"
+
+namespace Storytime {
+    struct ParticleSystemConfig {
+        Renderer& renderer;
+        Shared<Texture> texture = nullptr; /// Defaults to the renderer's placeholder texture (a white square).
+        u32 capacity = 200'000;
+        u16 layer = 0;
+
+        /// Acceleration applied to all particles, f.ex. gravity.
+        glm::vec2 acceleration = { 0.0f, 0.0f };
+
+        /// Fade particles out by scaling their alpha with the fraction of their lifetime that remains.
+        bool fade_out = true;
+
+        const ParticleSystemConfig& assert_valid() const {
+            ST_ASSERT_GREATER_THAN_ZERO(capacity);
+            return *this;
+        }
+    };
+
+    struct ParticleEmitConfig {
+        u32 count = 1;
+        glm::vec3 position = { 0.0f, 0.0f, 0.0f };
+        glm::vec2 position_variance = { 0.0f, 0.0f };
+        glm::vec2 velocity = { 0.0f, 0.0f };
+        glm::vec2 velocity_variance = { 0.0f, 0.0f };
+        f32 lifetime = 1.0f;
+        f32 lifetime_variance = 0.0f;
+        f32 size = 1.0f;
+        f32 size_variance = 0.0f;
+        glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    };
+
+    ///
+    /// Simulates and renders large numbers of short-lived particles.
+    ///
+    /// Particles are stored as a structure of arrays, one contiguous array per attribute, so that the update loops
+    /// read and write only the attributes they need and can be vectorized by the compiler. Dead particles are removed
+    /// by moving the last particle into their slot, which keeps the live particles tightly packed at the front.
+    ///
+    /// Particles are written as quad instances straight into the renderer's batch memory. The system should be updated
+    /// from the fixed timestep `App::update`, and rendered from `App::render`.
+    ///
+    class ParticleSystem {
+    public:
+        typedef ParticleSystemConfig Config;
+
+    private:
+        Config config;
+        u32 count = 0;
+        std::vector<f32> position_x;
+        std::vector<f32> position_y;
+        std::vector<f32> depth;
+        std::vector<f32> velocity_x;
+        std::vector<f32> velocity_y;
+        std::vector<f32> lifetime;
+        std::vector<f32> inverse_max_lifetime;
+        std::vector<f32> size;
+        std::vector<u32> color;
+
+    public:
+        ParticleSystem(const Config& config);
+
+        u32 get_count() const;
+
+        u32 get_capacity() const;
+
+        /// Spawn particles. Particles that don't fit within the capacity are dropped.
+        void emit(const ParticleEmitConfig& emit_config);
+
+        void update(f64 timestep);
+
+        void render() const;
+
+        void clear();
+
+    private:
+        void integrate(f32 timestep);
+
+        void remove_dead_particles();
+
+        void remove_particle(u32 index);
+    };
+}
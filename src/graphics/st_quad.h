@@ -16,5 +16,18 @@ namespace Storytime {
 
         /// Normalized coordinates for a rectangular area on the texture to sample from. Defaults to the entire texture.
         glm::vec4 texture_rectangle = glm::vec4{ 0.0f, 0.0f, 1.0f, 1.0f };
+
+        /// The layer of the quad. Quads on higher layers are closer than quads on lower layers, and within a layer the
+        /// depth of the quad (the Z-translation of its model matrix, quantized to 7 bits of its projected depth) orders
+        /// them. The layer and depth are enforced by depth testing against what writes depth: opaque quads, static
+        /// batches and tile layers. Translucent quads don't write depth, so they are only ordered among each other when
+        /// deferred rendering sorts them. Otherwise they are drawn in the order they are submitted.
+        u16 layer = 0;
+
+        /// Whether the quad is fully opaque. Opaque quads are drawn without blending and write depth, and when deferred
+        /// rendering is enabled their layers are drawn front-to-back before all other quads, so that the fragments they
+        /// hide on lower layers are rejected by the depth test before they are shaded. Quads with any transparent
+        /// texels must not be opaque.
+        bool opaque = false;
     };
 }
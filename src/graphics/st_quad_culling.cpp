@@ -0,0 +1,26 @@
+#include "st_quad_culling.h"
+
+namespace Storytime {
+    QuadCullRectangle get_quad_cull_rectangle(const ViewProjection& view_projection) {
+        glm::mat4 inverse_view_projection = glm::inverse((glm::mat4) view_projection);
+
+        constexpr std::array<glm::vec4, 4> corners = {
+            glm::vec4(-1.0f, -1.0f, 0.0f, 1.0f),
+            glm::vec4(1.0f, -1.0f, 0.0f, 1.0f),
+            glm::vec4(1.0f, 1.0f, 0.0f, 1.0f),
+            glm::vec4(-1.0f, 1.0f, 0.0f, 1.0f),
+        };
+
+        QuadCullRectangle cull_rectangle{
+            .min = glm::vec2(std::numeric_limits<f32>::max()),
+            .max = glm::vec2(std::numeric_limits<f32>::lowest()),
+        };
+        for (const glm::vec4& corner : corners) {
+            glm::vec4 world_corner = inverse_view_projection * corner;
+            glm::vec2 world_position = glm::vec2(world_corner) / world_corner.w;
+            cull_rectangle.min = glm::min(cull_rectangle.min, world_position);
+            cull_rectangle.max = glm::max(cull_rectangle.max, world_position);
+        }
+        return cull_rectangle;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "graphics/st_quad_vertex.h"
+#include "graphics/st_view_projection.h"
+
+namespace Storytime {
+    /// An axis-aligned rectangle in world space that quads are culled against.
+    struct QuadCullRectangle {
+        glm::vec2 min{};
+        glm::vec2 max{};
+    };
+
+    /// Get the world-space rectangle that is visible through a view projection, by transforming the corners of the
+    /// normalized device coordinates back to world space.
+    QuadCullRectangle get_quad_cull_rectangle(const ViewProjection& view_projection);
+
+    /// Check if the world-space bounds of a quad overlap the cull rectangle. The quad is the unit square transformed by
+    /// its x-axis, y-axis and position (see @QuadInstanceData), so its bounds are found by adding the negative and
+    /// positive components of the axes to the position.
+    ///
+    /// The test is branchless, so the compiler can vectorize it when it's called in a loop over many quads.
+    inline bool is_quad_visible(const glm::vec2& x_axis, const glm::vec2& y_axis, const glm::vec2& position, const QuadCullRectangle& cull_rectangle) {
+        glm::vec2 quad_min = position + glm::min(x_axis, 0.0f) + glm::min(y_axis, 0.0f);
+        glm::vec2 quad_max = position + glm::max(x_axis, 0.0f) + glm::max(y_axis, 0.0f);
+        return (quad_min.x <= cull_rectangle.max.x)
+            & (quad_max.x >= cull_rectangle.min.x)
+            & (quad_min.y <= cull_rectangle.max.y)
+            & (quad_max.y >= cull_rectangle.min.y);
+    }
+
+    inline bool is_quad_visible(const glm::mat4& model, const QuadCullRectangle& cull_rectangle) {
+        return is_quad_visible(glm::vec2(model[0]), glm::vec2(model[1]), glm::vec2(model[3]), cull_rectangle);
+    }
+
+    inline bool is_quad_visible(const QuadInstanceData& quad_instance_data, const QuadCullRectangle& cull_rectangle) {
+        const glm::vec4& transform = quad_instance_data.transform;
+        return is_quad_visible(glm::vec2(transform.x, transform.y), glm::vec2(transform.z, transform.w), quad_instance_data.position, cull_rectangle);
+    }
+}
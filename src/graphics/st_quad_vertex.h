@@ -10,16 +10,37 @@ namespace Storytime {
     };
 
     struct QuadInstanceData {
-        /// The model matrix of the quad that make up its transform in world space.
-        glm::mat4 model = glm::mat4(1.0f);
+        /// The linear part (scale, rotation and shear) of the 2D affine transform of the quad, stored as the first two
+        /// columns of its model matrix: (x-axis.x, x-axis.y, y-axis.x, y-axis.y).
+        glm::vec4 transform = { 1.0f, 0.0f, 0.0f, 1.0f };
 
-        /// The color of the quad. If a texture is supplied, the color will be blended with the texture.
-        glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+        /// The translation of the quad in world space.
+        glm::vec2 position = { 0.0f, 0.0f };
 
-        /// Normalized coordinates for a rectangular area on the texture to sample from. Defaults to the entire texture.
-        glm::vec4 texture_rectangle = { 0.0f, 0.0f, 1.0f, 1.0f };
+        /// The depth of the quad in world space. Orders quads within a layer, lower depth is closer. The vertex shader
+        /// quantizes its projected depth to 7 bits for the depth test, and deferred rendering sorts translucent quads
+        /// by it.
+        f32 depth = 0.0f;
 
-        /// The index of the texture to sample from.
-        f32 texture_index = 0.0f;
+        /// The color of the quad packed as RGBA8 (unorm). If a texture is supplied, the color will be blended with the
+        /// texture.
+        u32 color = 0xFFFFFFFF;
+
+        /// Normalized coordinates for a rectangular area on the texture to sample from, packed as four unorm16 values.
+        /// Defaults to the entire texture (0, 0, 1, 1).
+        u64 texture_rectangle = 0xFFFFFFFF00000000;
+
+        /// The index of the texture to sample from. The highest bit is set when the texture has premultiplied alpha,
+        /// see `quad_texture_index_premultiplied_alpha_bit`.
+        u32 texture_index = 0;
+
+        /// The layer of the quad (see `Quad::layer`), which the vertex shader maps to the depth that is depth tested.
+        u32 layer = 0;
     };
+
+    static_assert(sizeof(QuadInstanceData) <= 48, "Quad instance data should stay compact");
+
+    /// Set in the texture index of quads (and tiles) whose texture has premultiplied alpha. Quads are always blended
+    /// with premultiplied alpha, so the fragment shaders premultiply the texels of textures without this bit.
+    constexpr u32 quad_texture_index_premultiplied_alpha_bit = 1u << 31;
 }
@@ -0,0 +1,46 @@
+#include "st_render_context.h"
+
+#include "graphics/st_renderer.h"
+
+namespace Storytime {
+    RenderContext::RenderContext(const Config& config) : config(config) {
+    }
+
+    const std::string& RenderContext::get_name() const {
+        return config.name;
+    }
+
+    i32 RenderContext::get_priority() const {
+        return config.priority;
+    }
+
+    void RenderContext::set_priority(i32 priority) {
+        config.priority = priority;
+    }
+
+    const std::vector<QuadCommand>& RenderContext::get_quad_commands() const {
+        return quad_commands;
+    }
+
+    const std::unordered_map<u32, Shared<Texture>>& RenderContext::get_textures() const {
+        return textures;
+    }
+
+    void RenderContext::render_quad(const Quad& quad) {
+        // The texture index is assigned by the renderer when the context is merged into a frame, because it depends on
+        // the batch (or bindless texture array) the quad ends up in. Quads without a texture use the placeholder.
+        QuadCommand& quad_command = quad_commands.emplace_back();
+        Renderer::write_quad_instance_data(quad_command.instance_data, quad, 0);
+        quad_command.opaque = quad.opaque;
+
+        if (quad.texture != nullptr) {
+            quad_command.texture = quad.texture.get();
+            textures.try_emplace(quad.texture->get_id(), quad.texture);
+        }
+    }
+
+    void RenderContext::clear() {
+        quad_commands.clear();
+        textures.clear();
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "graphics/st_frame.h"
+#include "graphics/st_quad.h"
+
+namespace Storytime {
+    struct RenderContextConfig {
+        std::string name = "RenderContext";
+        /// Contexts are merged into the frame in ascending priority, so higher priority contexts are rendered later.
+        i32 priority = 0;
+    };
+
+    /// A list of quads that can be rendered to from any thread, and is submitted to the @Renderer from the main thread.
+    ///
+    /// Quads are packed into the compact instance format when they are rendered to the context, so the work of
+    /// independent layers (f.ex. tilemap, entities, particles and text) can be spread across threads. A context is not
+    /// synchronized, so it must only be rendered to by one thread at a time.
+    class RenderContext {
+    public:
+        typedef RenderContextConfig Config;
+
+    private:
+        Config config;
+        std::vector<QuadCommand> quad_commands{};
+        std::unordered_map<u32, Shared<Texture>> textures{};
+
+    public:
+        explicit RenderContext(const Config& config = {});
+
+        const std::string& get_name() const;
+
+        i32 get_priority() const;
+
+        void set_priority(i32 priority);
+
+        const std::vector<QuadCommand>& get_quad_commands() const;
+
+        /// The textures of the rendered quads by their ID. Keeps the textures alive until the context is cleared.
+        const std::unordered_map<u32, Shared<Texture>>& get_textures() const;
+
+        void render_quad(const Quad& quad);
+
+        /// Remove all quads and textures, but keep the allocated memory to be reused.
+        void clear();
+    };
+}
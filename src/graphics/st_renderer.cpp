@@ -1,6 +1,8 @@
 #include "st_renderer.h"
 
+#include "system/st_clock.h"
 #include "system/st_defer.h"
+#include "utils/st_png.h"
 
 namespace Storytime {
 
@@ -8,21 +10,48 @@ namespace Storytime {
         : config(config.assert_valid()),
           init_command_pool(create_init_command_pool()),
           frame_command_pool(create_frame_command_pool()),
-          batch_descriptor_pool(create_batch_descriptor_pool()),
           batch_descriptor_set_layout(create_batch_descriptor_set_layout()),
-          quad_graphics_pipeline(create_quad_graphics_pipeline()),
+          tile_layer_descriptor_set_layout(create_tile_layer_descriptor_set_layout()),
+          bindless_textures_enabled(config.device.is_descriptor_indexing_enabled()),
+          bindless_texture_capacity(get_bindless_texture_capacity()),
+          indirect_draws_enabled(is_indirect_draws_supported()),
+          timestamp_valid_bits(get_timestamp_valid_bits()),
+          timestamp_period_ns(config.device.get_physical_device().get_properties().limits.timestampPeriod),
+          gpu_timestamps_enabled(is_gpu_timestamps_supported()),
+          gpu_draw_timestamps_enabled(config.gpu_draw_timestamps_enabled),
+          bindless_descriptor_pool(create_bindless_descriptor_pool()),
+          bindless_descriptor_set_layout(create_bindless_descriptor_set_layout()),
+          bindless_descriptor_set(allocate_bindless_descriptor_set()),
+          quad_graphics_pipeline(create_quad_graphics_pipeline(false, false)),
+          opaque_quad_graphics_pipeline(create_quad_graphics_pipeline(true, false)),
+          static_batch_graphics_pipeline(create_quad_graphics_pipeline(false, true)),
+          tile_layer_graphics_pipeline(create_tile_layer_graphics_pipeline()),
           base_quad_vertex_buffer(create_base_quad_vertex_buffer()),
           base_quad_index_buffer(create_base_quad_index_buffer()),
           texture_sampler(create_texture_sampler()),
           placeholder_texture(create_placeholder_texture()),
-          frames(create_frames())
+          frames(create_frames()),
+          render_target(create_render_target()),
+          upscale_descriptor_set_layout(create_upscale_descriptor_set_layout()),
+          upscale_descriptor_set(allocate_upscale_descriptor_set()),
+          upscale_graphics_pipeline(create_upscale_graphics_pipeline())
     {
+        // The placeholder texture is registered first so that it always has index 0 in the bindless texture array.
+        register_texture(placeholder_texture);
+
+        // The render target is the only image that the upscale pass ever samples, so its descriptor is written once.
+        if (render_target != nullptr) {
+            write_upscale_descriptors();
+        }
     }
 
     Renderer::~Renderer() {
+        destroy_upscale_descriptor_set_layout();
         destroy_frames();
         destroy_placeholder_texture();
         destroy_texture_sampler();
+        destroy_bindless_descriptor_set_layout();
+        destroy_tile_layer_descriptor_set_layout();
         destroy_batch_descriptor_set_layout();
     }
 
@@ -43,7 +72,19 @@ namespace Storytime {
         begin_frame_command_buffer(command_buffer);
         config.device.begin_cmd_label(command_buffer, "CommandBuffer");
 
-        config.swapchain.begin_render_pass(command_buffer);
+        // The results of the last submission of the frame are read in `begin_render`, before this command buffer is
+        // submitted. Queries must be reset outside of a render pass before they can be written again.
+        if (gpu_timestamps_enabled) {
+            command_buffer.reset_query_pool(frame.timestamp_query_pool, 0, timestamp_query_capacity);
+            write_timestamp(frame, (u32) GpuTimestamp::FRAME_BEGIN);
+        }
+
+        // The scene is rendered to the render target when there is one, and upscaled to the swapchain in `end_render`.
+        if (render_target != nullptr) {
+            render_target->begin_render_pass(command_buffer);
+        } else {
+            config.swapchain.begin_render_pass(command_buffer);
+        }
 
         return &frame;
     }
@@ -56,6 +97,10 @@ namespace Storytime {
 
         config.swapchain.end_render_pass(command_buffer);
 
+        if (gpu_timestamps_enabled) {
+            write_timestamp(frame, (u32) GpuTimestamp::FRAME_END);
+        }
+
         config.device.end_cmd_label(command_buffer);
         end_frame_command_buffer(command_buffer);
 
@@ -65,30 +110,46 @@ namespace Storytime {
         frame_index = (frame_index + 1) % config.frame_count;
     }
 
-    void Renderer::begin_render() const {
+    void Renderer::begin_render() {
         ST_ASSERT_IN_BOUNDS(frame_index, frames);
-        const Frame& frame = frames.at(frame_index);
+        Frame& frame = frames.at(frame_index);
 
-        const VulkanCommandBuffer& command_buffer = frame.command_buffer;
+        // The command buffer has been reset since the last frame, so nothing is bound to it.
+        frame.quad_graphics_pipeline = nullptr;
+        bind_quad_graphics_pipeline(frame, false);
 
-        config.device.insert_cmd_label(command_buffer, "Bind graphics pipeline");
-        command_buffer.bind_pipeline({
-            .pipeline = quad_graphics_pipeline,
-            .bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
-        });
+        // The previous submission of the frame has finished (its fence was waited on in `begin_frame`), so the buffers
+        // it outgrew are no longer read, and its timestamps are available.
+        frame.retired_instance_buffers.clear();
+        frame.retired_indirect_buffers.clear();
+        frame.textures.clear();
+        frame.last_retained_texture_id = 0;
+
+        if (gpu_timestamps_enabled) {
+            if (frame.timestamp_query_count > 0) {
+                read_timestamps(frame);
+            }
+            frame.timestamp_query_count = (u32) GpuTimestamp::COUNT;
+            write_timestamp(frame, (u32) GpuTimestamp::SCENE_BEGIN);
+        }
     }
 
     void Renderer::end_render() {
         ST_ASSERT_IN_BOUNDS(frame_index, frames);
         Frame& frame = frames.at(frame_index);
-        if (frame.batch_index >= frame.batches.size()) {
-            return;
+        if (!submitted_render_contexts.empty()) {
+            merge_render_contexts(frame);
         }
-        Batch& batch = frame.batches.at(frame.batch_index);
-        if (batch.quad_index <= 0) {
-            return;
+        if (config.deferred_rendering_enabled) {
+            render_deferred_quads(frame);
+        }
+        flush_current_batch(frame);
+        if (render_target != nullptr) {
+            upscale_render_target(frame);
+        }
+        if (gpu_timestamps_enabled) {
+            write_timestamp(frame, (u32) GpuTimestamp::SCENE_END);
         }
-        flush(frame, batch);
     }
 
     void Renderer::set_view_projection(const ViewProjection& view_projection) {
@@ -103,14 +164,109 @@ namespace Storytime {
         ST_ASSERT_IN_BOUNDS(frame_index, frames);
         Frame& frame = frames.at(frame_index);
 
-        ST_ASSERT_IN_BOUNDS(frame.batch_index, frame.batches);
-        const Batch& batch = frame.batches.at(frame.batch_index);
+        // Deferred quads are sorted by the view projection they were submitted with, and the view projections are set
+        // when the sorted quads are added to batches.
+        if (config.deferred_rendering_enabled) {
+            if (frame.view_projections.size() >= max_view_projections_per_frame) {
+                ST_THROW("Could not set view projection, maximum view projections per frame [" << max_view_projections_per_frame << "] exceeded");
+            }
+            frame.view_projections.push_back(view_projection);
+            if (config.quad_culling_enabled) {
+                frame.view_cull_rectangles.push_back(get_quad_cull_rectangle(view_projection));
+            }
+            return;
+        }
+
+        if (config.quad_culling_enabled) {
+            frame.cull_rectangle = get_quad_cull_rectangle(view_projection);
+            frame.cull_rectangle_set = true;
+        }
 
         // Flush any active batch before setting the new projection. It cannot be changed in the middle of a batch.
-        if (batch.quad_index > 0) {
-            flush(frame, batch);
+        flush_current_batch(frame);
+
+        push_view_projection(frame, view_projection);
+    }
+
+    bool Renderer::is_quad_culled(const Frame& frame, const glm::mat4& model) const {
+        if (!config.quad_culling_enabled || !frame.cull_rectangle_set) {
+            return false;
+        }
+        bool visible = is_quad_visible(model, frame.cull_rectangle);
+        config.metrics.visible_quad_count += visible;
+        config.metrics.culled_quad_count += !visible;
+        return !visible;
+    }
+
+    bool Renderer::is_quad_culled(const Frame& frame, const QuadInstanceData& quad_instance_data) const {
+        if (!config.quad_culling_enabled || !frame.cull_rectangle_set) {
+            return false;
+        }
+        bool visible = is_quad_visible(quad_instance_data, frame.cull_rectangle);
+        config.metrics.visible_quad_count += visible;
+        config.metrics.culled_quad_count += !visible;
+        return !visible;
+    }
+
+    u32 Renderer::cull_quads(Frame& frame, const QuadInstanceData* quads, u32 quad_count) const {
+        std::vector<QuadInstanceData>& visible_quads = frame.visible_quads;
+        if (visible_quads.size() < quad_count) {
+            visible_quads.resize(quad_count);
+        }
+
+        // Compact the visible quads into the scratch buffer, keeping their order. Like `cull_deferred_quads`, every
+        // quad is written and the write index is advanced by the result of the visibility test, so the loop doesn't
+        // branch on it.
+        u32 visible_quad_count = 0;
+        for (u32 i = 0; i < quad_count; i++) {
+            bool visible = is_quad_visible(quads[i], frame.cull_rectangle);
+            visible_quads[visible_quad_count] = quads[i];
+            visible_quad_count += visible;
+        }
+
+        config.metrics.visible_quad_count += visible_quad_count;
+        config.metrics.culled_quad_count += quad_count - visible_quad_count;
+        return visible_quad_count;
+    }
+
+    void Renderer::cull_deferred_quads(Frame& frame) const {
+        std::vector<RadixSortEntry>& quad_sort_entries = frame.quad_sort_entries;
+        u32 quad_count = (u32) quad_sort_entries.size();
+
+        // Compact the sort entries in place, keeping the visible quads in submission order. Every entry is written and
+        // the write index is advanced by the result of the visibility test, so the loop doesn't branch on it.
+        u32 visible_quad_count = 0;
+        for (u32 i = 0; i < quad_count; i++) {
+            const RadixSortEntry quad_sort_entry = quad_sort_entries[i];
+
+            // Quads are always submitted with the index of a view projection that has already been set, or the first
+            // one if they were submitted before it, so there is always a cull rectangle for the view.
+            u32 view_index = (u32) (quad_sort_entry.key >> quad_sort_key_view_shift);
+            ST_ASSERT_IN_BOUNDS(view_index, frame.view_cull_rectangles);
+            ST_ASSERT_IN_BOUNDS(quad_sort_entry.index, frame.quad_commands);
+
+            const QuadInstanceData& quad_instance_data = frame.quad_commands[quad_sort_entry.index].instance_data;
+            bool visible = is_quad_visible(quad_instance_data, frame.view_cull_rectangles[view_index]);
+
+            quad_sort_entries[visible_quad_count] = quad_sort_entry;
+            visible_quad_count += visible;
+        }
+        quad_sort_entries.resize(visible_quad_count);
+
+        config.metrics.visible_quad_count += visible_quad_count;
+        config.metrics.culled_quad_count += quad_count - visible_quad_count;
+    }
+
+    const ViewProjection& Renderer::get_current_view_projection(const Frame& frame) const {
+        // Deferred view projections are only pushed when the deferred quads are batched, so use the latest one.
+        if (config.deferred_rendering_enabled && !frame.view_projections.empty()) {
+            return frame.view_projections.back();
         }
+        return frame.view_projection;
+    }
 
+    void Renderer::push_view_projection(Frame& frame, const ViewProjection& view_projection) const {
+        frame.view_projection = view_projection;
         frame.command_buffer.push_constants({
             .pipeline_layout = quad_graphics_pipeline.get_pipeline_layout(),
             .shader_stage = VK_SHADER_STAGE_VERTEX_BIT,
@@ -123,17 +279,183 @@ namespace Storytime {
         ST_ASSERT_IN_BOUNDS(frame_index, frames);
         Frame& frame = frames.at(frame_index);
 
-        if (frame.batch_index >= frame.batches.size()) {
-            ST_LOG_W("Maximum batches exceeded for frame [{}], dropping quad", frame_index);
+        const Shared<VulkanImage>& texture = quad.texture != nullptr && quad.texture->is_ready() ? quad.texture : placeholder_texture;
+        ST_ASSERT_NOT_NULL(texture);
+
+        if (config.deferred_rendering_enabled) {
+            retain_texture(frame, texture);
+            defer_quad(frame, quad, texture);
             return;
         }
 
-        ST_ASSERT_IN_BOUNDS(frame.batch_index, frame.batches);
-        Batch& batch = frame.batches.at(frame.batch_index);
+        // Skip quads that are completely outside the view before anything is written to the batch, or retained.
+        if (is_quad_culled(frame, quad.model)) {
+            return;
+        }
+
+        Batch& batch = get_quad_batch(frame, quad.opaque);
+        u32 texture_index = get_quad_texture_index(frame, batch, texture);
+
+        //
+        // Add quad to quad batch as instance data with the texture sampler index.
+        //
 
-        std::vector<QuadInstanceData>& quad_batch = batch.quads;
-        std::vector<Shared<VulkanImage>>& texture_batch = batch.textures;
+        // Write the instance data through the batch cursor. With direct instance writes enabled, this is the mapped
+        // instance vertex buffer itself, so the quad is written exactly once and never copied again.
+        ST_ASSERT_NOT_NULL(batch.quads);
+        ST_ASSERT(batch.quad_index < max_quads_per_batch, "Quad index [" << batch.quad_index << "] must be less than the batch capacity [" << max_quads_per_batch << "]");
+        QuadInstanceData& quad_instance_data = batch.quads[batch.quad_index];
 
+        write_quad_instance_data(quad_instance_data, quad, texture_index);
+
+        commit_quad(frame, batch);
+    }
+
+    void Renderer::render_quads(const Shared<Texture>& texture, const QuadInstanceData* quads, u32 quad_count, u16 layer, bool opaque) {
+        ST_ASSERT_IN_BOUNDS(frame_index, frames);
+        Frame& frame = frames.at(frame_index);
+        if (quad_count == 0) {
+            return;
+        }
+        ST_ASSERT_NOT_NULL(quads);
+
+        const Shared<VulkanImage>& quads_texture = texture != nullptr && texture->is_ready() ? texture : placeholder_texture;
+        ST_ASSERT_NOT_NULL(quads_texture);
+
+        if (config.deferred_rendering_enabled) {
+            retain_texture(frame, quads_texture);
+            u32 bindless_texture_index = bindless_textures_enabled ? get_bindless_texture_index(quads_texture) : 0;
+            QuadCommand quad_command{};
+            quad_command.texture = quads_texture.get();
+            quad_command.opaque = opaque;
+            for (u32 i = 0; i < quad_count; i++) {
+                quad_command.instance_data = quads[i];
+                quad_command.instance_data.texture_index = bindless_texture_index;
+                quad_command.instance_data.layer = layer;
+                defer_quad_command(frame, quad_command);
+            }
+            return;
+        }
+
+        // Cull all of the quads up front, so the quads that are written below are all visible.
+        const QuadInstanceData* visible_quads = quads;
+        u32 visible_quad_count = quad_count;
+        if (config.quad_culling_enabled && frame.cull_rectangle_set) {
+            visible_quad_count = cull_quads(frame, quads, quad_count);
+            visible_quads = frame.visible_quads.data();
+        }
+
+        // Write the quads in runs that fill up the room left in the current batch. The batch texture slot only has to
+        // be looked up once per run, as a run never spills over into another batch.
+        u32 written_quad_count = 0;
+        while (written_quad_count < visible_quad_count) {
+            Batch& batch = get_quad_batch(frame, opaque);
+            ST_ASSERT_NOT_NULL(batch.quads);
+            ST_ASSERT(batch.quad_index < max_quads_per_batch, "Quad index [" << batch.quad_index << "] must be less than the batch capacity [" << max_quads_per_batch << "]");
+
+            u32 texture_index = get_quad_texture_index(frame, batch, quads_texture);
+            u32 run_quad_count = std::min(visible_quad_count - written_quad_count, max_quads_per_batch - batch.quad_index);
+
+            QuadInstanceData* batch_quads = batch.quads + batch.quad_index;
+            const QuadInstanceData* run_quads = visible_quads + written_quad_count;
+            for (u32 i = 0; i < run_quad_count; i++) {
+                batch_quads[i] = run_quads[i];
+                batch_quads[i].texture_index = texture_index;
+                batch_quads[i].layer = layer;
+            }
+
+            commit_quad(frame, batch, run_quad_count);
+            written_quad_count += run_quad_count;
+        }
+    }
+
+    QuadReservation Renderer::reserve_quads(const Shared<Texture>& texture, u32 quad_count, u16 layer, bool opaque) {
+        ST_ASSERT_IN_BOUNDS(frame_index, frames);
+        Frame& frame = frames.at(frame_index);
+        ST_ASSERT_GREATER_THAN_ZERO(quad_count);
+
+        const Shared<VulkanImage>& reservation_texture = texture != nullptr && texture->is_ready() ? texture : placeholder_texture;
+        ST_ASSERT_NOT_NULL(reservation_texture);
+        reserved_texture = reservation_texture.get();
+        reserved_opaque = opaque;
+
+        // Deferred quads are sorted before they are batched, so they are reserved in a scratch buffer and deferred
+        // when they are committed.
+        if (config.deferred_rendering_enabled) {
+            retain_texture(frame, reservation_texture);
+            reserved_quads.resize(quad_count);
+            return {
+                .quads = reserved_quads.data(),
+                .capacity = quad_count,
+                .texture_index = bindless_textures_enabled ? get_bindless_texture_index(reservation_texture) : 0,
+                .layer = layer,
+            };
+        }
+
+        Batch& batch = get_quad_batch(frame, opaque);
+        ST_ASSERT_NOT_NULL(batch.quads);
+        u32 texture_index = get_quad_texture_index(frame, batch, reservation_texture);
+        return {
+            .quads = batch.quads + batch.quad_index,
+            .capacity = std::min(quad_count, max_quads_per_batch - batch.quad_index),
+            .texture_index = texture_index,
+            .layer = layer,
+        };
+    }
+
+    void Renderer::commit_quads(u32 quad_count) {
+        ST_ASSERT_IN_BOUNDS(frame_index, frames);
+        Frame& frame = frames.at(frame_index);
+        ST_ASSERT_NOT_NULL(reserved_texture);
+
+        if (config.deferred_rendering_enabled) {
+            ST_ASSERT(quad_count <= reserved_quads.size(), "Committed quads [" << quad_count << "] must have been reserved [" << reserved_quads.size() << "]");
+            QuadCommand quad_command{};
+            quad_command.texture = reserved_texture;
+            quad_command.opaque = reserved_opaque;
+            for (u32 i = 0; i < quad_count; i++) {
+                quad_command.instance_data = reserved_quads[i];
+                defer_quad_command(frame, quad_command);
+            }
+        } else if (quad_count > 0) {
+            Batch& batch = get_current_batch(frame);
+            ST_ASSERT(batch.quad_index + quad_count <= max_quads_per_batch, "Committed quads [" << quad_count << "] must fit in the batch");
+            commit_quad(frame, batch, quad_count);
+        }
+
+        reserved_texture = nullptr;
+    }
+
+    void Renderer::retain_texture(Frame& frame, const Shared<VulkanImage>& texture) {
+        // Only the first quad of a texture in the frame copies the shared pointer, and runs of quads with the same
+        // texture don't even look it up.
+        u32 texture_id = texture->get_id();
+        if (texture_id == frame.last_retained_texture_id) {
+            return;
+        }
+        frame.textures.try_emplace(texture_id, texture);
+        frame.last_retained_texture_id = texture_id;
+    }
+
+    u32 Renderer::get_quad_texture_index(Frame& frame, Batch& batch, const Shared<VulkanImage>& texture) {
+        // Use the persistent index of the texture in the bindless texture array when it's enabled. All textures are
+        // bound to every batch, so a batch never has to be flushed because of its textures.
+        if (bindless_textures_enabled) {
+            retain_texture(frame, texture);
+            return get_bindless_texture_index(texture);
+        }
+
+        // The textures of a batch are unique, so a texture only has to be retained when it gets a new slot in the
+        // batch. Quads that find their texture in the batch are kept alive by the quad that added it.
+        u32 batch_texture_count = batch.texture_index;
+        u32 texture_index = get_batch_texture_index(batch, *texture);
+        if (batch.texture_index > batch_texture_count) {
+            retain_texture(frame, texture);
+        }
+        return texture_index;
+    }
+
+    u32 Renderer::get_batch_texture_index(Batch& batch, const VulkanImage& texture) const {
         //
         // Determine texture sampler index and add texture to texture batch if needed.
         //
@@ -143,40 +465,35 @@ namespace Storytime {
         // 1. Check if the texture is already added to the batch.
         // 2. Pass it to the fragment shader so it can select the correct texture to sample from.
         //
+        // Textures are looked up by their ID instead of comparing shared pointers, which keeps the lookup
+        // constant-time and avoids touching the (atomic) reference counts of the shared pointers for every quad.
+        //
+        // The returned index includes the premultiplied alpha bit of the texture, so it's only used as instance data.
+        //
 
-        const Shared<VulkanImage>& texture = quad.texture != nullptr ? quad.texture : placeholder_texture;
-        i32 texture_index = -1;
-        for (i32 i = 0; i < batch.texture_index; i++) {
-            if (texture == texture_batch.at(i)) {
-                texture_index = i;
-                break;
-            }
+        auto [texture_slot, texture_added] = batch.texture_slots.try_emplace(texture.get_id(), batch.texture_index);
+        if (!texture_added) {
+            return texture_slot->second | get_texture_index_flags(texture);
         }
-        if (texture_index == -1) {
-            texture_index = batch.texture_index;
-            ST_ASSERT_IN_BOUNDS(texture_index, texture_batch);
-            texture_batch.at(texture_index) = texture;
-            batch.texture_index++;
-            config.metrics.texture_count++;
-        }
-        ST_ASSERT(texture_index > -1, "Invalid quad texture index [" << texture_index << "]");
 
-        //
-        // Add quad to quad batch as instance data with the texture sampler index.
-        //
+        u32 texture_index = batch.texture_index;
+        ST_ASSERT_IN_BOUNDS(texture_index, batch.textures);
+        batch.textures[texture_index] = &texture;
+        batch.texture_index++;
+        config.metrics.texture_count++;
 
-        ST_ASSERT_IN_BOUNDS(batch.quad_index, quad_batch);
-        QuadInstanceData& quad_instance_data = quad_batch.at(batch.quad_index);
+        return texture_index | get_texture_index_flags(texture);
+    }
 
-        quad_instance_data.texture_index = (f32) texture_index;
-        quad_instance_data.texture_rectangle = quad.texture_rectangle;
-        quad_instance_data.color = quad.color;
-        quad_instance_data.model = quad.model;
+    u32 Renderer::get_texture_index_flags(const VulkanImage& texture) {
+        return texture.is_premultiplied_alpha() ? quad_texture_index_premultiplied_alpha_bit : 0;
+    }
 
-        batch.quad_index++;
-        config.metrics.quad_count++;
+    void Renderer::commit_quad(Frame& frame, Batch& batch, u32 quad_count) const {
+        batch.quad_index += quad_count;
+        config.metrics.quad_count += quad_count;
 
-        bool batch_is_full = batch.quad_index >= quad_batch.size() || batch.texture_index >= texture_batch.size();
+        bool batch_is_full = batch.quad_index >= max_quads_per_batch || (!bindless_textures_enabled && batch.texture_index >= batch.textures.size());
         if (batch_is_full) {
             flush(frame, batch);
         }
@@ -189,167 +506,1287 @@ namespace Storytime {
         config.metrics.vertex_count = config.metrics.quad_count * max_vertices_per_quad;
     }
 
-    void Renderer::flush(Frame& frame, const Batch& batch) const {
-        const VulkanCommandBuffer& command_buffer = frame.command_buffer;
+    void Renderer::defer_quad(Frame& frame, const Quad& quad, const Shared<VulkanImage>& texture) {
+        // Batch texture slots are not known until the quads have been sorted, and are assigned when they are batched.
+        u32 texture_index = bindless_textures_enabled ? get_bindless_texture_index(texture) : 0;
 
-        //
-        // Vertices & Indices
-        //
+        QuadCommand quad_command{};
+        write_quad_instance_data(quad_command.instance_data, quad, texture_index);
+        quad_command.texture = texture.get();
+        quad_command.opaque = quad.opaque;
 
-        // Upload the quad instance data to the instance vertex buffer.
-        batch.vertex_buffer.set_data(batch.quads.data());
+        defer_quad_command(frame, quad_command);
+    }
 
-        // Bind both the base and instance vertex buffers. The base quad will be reused to draw all quad instances.
-        config.device.insert_cmd_label(command_buffer, "Bind vertex buffers");
-        VkBuffer vertex_buffers[] = {
-            base_quad_vertex_buffer, // Binding 0 (Base vertices)
-            batch.vertex_buffer, // Binding 1 (Instance vertices)
-        };
-        VkDeviceSize vertex_buffer_offsets[] = {
-            0, // Binding 0 (Base vertices)
-            0 // Binding 1 (Instance vertices)
-        };
-        command_buffer.bind_vertex_buffers({
-            .first_binding = 0, // Binding 0 (Base vertices)
-            .binding_count = 2,
-            .vertex_buffers = vertex_buffers,
-            .offsets = vertex_buffer_offsets,
-        });
+    void Renderer::defer_quad_command(Frame& frame, const QuadCommand& quad_command) {
+        ST_ASSERT_NOT_NULL(quad_command.texture);
 
-        // Bind the base quad index buffer that contains the indices for the base quad.
-        // We only need indices for the single base quad because all submitted quads are instanced.
-        config.device.insert_cmd_label(command_buffer, "Bind index buffer");
-        command_buffer.bind_index_buffer({
-            .index_buffer = base_quad_index_buffer,
-            .index_type = index_type,
-            .offset = 0,
+        // Quads are sorted by the latest view projection that has been set. Quads that are submitted before the first
+        // view projection of the frame use the first one.
+        u32 view_index = frame.view_projections.empty() ? 0 : (u32) frame.view_projections.size() - 1;
+
+        frame.quad_sort_entries.push_back({
+            .key = get_quad_sort_key(view_index, quad_command.opaque, (u16) quad_command.instance_data.layer, quad_command.texture->get_id(), quad_command.instance_data.depth),
+            .index = (u32) frame.quad_commands.size(),
         });
+        frame.quad_commands.push_back(quad_command);
+    }
 
-        //
-        // Descriptors
-        //
+    void Renderer::add_quad_command(Frame& frame, const QuadCommand& quad_command) {
+        Batch& batch = get_quad_batch(frame, quad_command.opaque);
+        ST_ASSERT_NOT_NULL(batch.quads);
+        QuadInstanceData& quad_instance_data = batch.quads[batch.quad_index];
 
-        // Write all descriptors that are specific to this batch (f.ex. texture samplers).
-        write_batch_descriptors(batch);
+        quad_instance_data = quad_command.instance_data;
+        if (!bindless_textures_enabled) {
+            ST_ASSERT_NOT_NULL(quad_command.texture);
+            quad_instance_data.texture_index = get_batch_texture_index(batch, *quad_command.texture);
+        }
 
-        // Bind the descriptor set that contains the descriptors.
-        config.device.insert_cmd_label(command_buffer, "Bind batch descriptor set");
-        command_buffer.bind_descriptor_sets({
-            .pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
-            .pipeline_layout = quad_graphics_pipeline.get_pipeline_layout(),
-            .first_set = 0, // Set 0 (per-batch)
-            .descriptor_set_count = 1,
-            .descriptor_sets = (VkDescriptorSet*) &batch.descriptor_set,
+        commit_quad(frame, batch);
+    }
+
+    void Renderer::merge_render_contexts(Frame& frame) {
+        // Contexts are merged in ascending priority. The sort is stable, so contexts with the same priority are merged
+        // in the order they were submitted, which keeps the result deterministic however the threads were scheduled.
+        std::ranges::stable_sort(submitted_render_contexts, [](const RenderContext* a, const RenderContext* b) {
+            return a->get_priority() < b->get_priority();
         });
 
-        //
-        // Draw
-        //
+        for (RenderContext* render_context : submitted_render_contexts) {
+            ST_ASSERT_NOT_NULL(render_context);
 
-        // Draw all the instanced quads in the batch using the base quad vertices and indices.
-        config.device.insert_cmd_label(command_buffer, "Draw indexed");
-        command_buffer.draw_indexed({
-            .index_count = (u32) base_quad_indices.size(),
-            .instance_count = batch.quad_index,
-            .first_index = 0,
-            .vertex_offset = 0,
-            .first_instance = 0,
-        });
+            // The context is cleared once it's merged, so the frame takes over keeping its textures alive. Register any
+            // textures that don't have a bindless index yet, so the instances below can use their indices without
+            // touching the shared pointers.
+            for (const auto& [texture_id, texture] : render_context->get_textures()) {
+                retain_texture(frame, texture);
+                if (bindless_textures_enabled && texture->is_ready()) {
+                    get_bindless_texture_index(texture);
+                }
+            }
 
-        //
-        // End batch
-        //
+            for (QuadCommand quad_command : render_context->get_quad_commands()) {
+                // Textures that are still being uploaded are drawn with the placeholder texture until they are ready.
+                if (quad_command.texture == nullptr || !quad_command.texture->is_ready()) {
+                    quad_command.texture = placeholder_texture.get();
+                }
+                if (bindless_textures_enabled) {
+                    quad_command.instance_data.texture_index = quad_command.texture->get_descriptor_index() | get_texture_index_flags(*quad_command.texture);
+                }
+                if (config.deferred_rendering_enabled) {
+                    defer_quad_command(frame, quad_command);
+                } else if (!is_quad_culled(frame, quad_command.instance_data)) {
+                    add_quad_command(frame, quad_command);
+                }
+            }
 
-        // Advance to the next batch. Don't need to clean up/reset anything here because no batches are reused in the
-        // same frame. A frame will continue to use the next available batch until all batches have been used.
-        frame.batch_index++;
+            render_context->clear();
+        }
 
-        // Update metrics
-        config.metrics.draw_calls++;
+        submitted_render_contexts.clear();
     }
 
-    void Renderer::reset(Frame& frame) const {
-        // Reset used batches in frame
-        for (u32 i = 0; i <= frame.batch_index; i++) {
-            Batch& batch = frame.batches.at(i);
-            batch.quad_index = 0;
+    void Renderer::render_deferred_quads(Frame& frame) {
+        if (frame.quad_commands.empty()) {
+            return;
+        }
 
-            // Reset used textures in batch
-            for (u32 j = 0; j <= batch.texture_index; j++) {
-                batch.textures.at(j) = placeholder_texture;
+        TimePoint start_time = Time::now();
+
+        // Cull all deferred quads before sorting, so quads outside of their view are never sorted or batched.
+        if (config.quad_culling_enabled && !frame.view_cull_rectangles.empty()) {
+            cull_deferred_quads(frame);
+        }
+
+        // Sort the quads so that quads which share a view projection, layer and texture end up next to each other,
+        // and can be added to the same batch. The sort is stable, so quads with equal keys keep their submission order.
+        radix_sort(frame.quad_sort_entries, frame.quad_sort_scratch);
+
+        u32 current_view_index = std::numeric_limits<u32>::max();
+
+        for (const RadixSortEntry& quad_sort_entry : frame.quad_sort_entries) {
+
+            // Flush the active batch and set the new view projection when the sorted quads move on to the next view.
+            u32 view_index = (u32) (quad_sort_entry.key >> quad_sort_key_view_shift);
+            if (view_index != current_view_index && view_index < frame.view_projections.size()) {
+                flush_current_batch(frame);
+                push_view_projection(frame, frame.view_projections[view_index]);
+                current_view_index = view_index;
             }
-            batch.texture_index = 0;
+
+            ST_ASSERT_IN_BOUNDS(quad_sort_entry.index, frame.quad_commands);
+            add_quad_command(frame, frame.quad_commands[quad_sort_entry.index]);
         }
 
-        // Reset frame
-        frame.batch_index = 0;
+        frame.quad_commands.clear();
+        frame.quad_sort_entries.clear();
+        frame.view_projections.clear();
+        frame.view_cull_rectangles.clear();
 
-        // Reset metrics
-        config.metrics.draw_calls = 0;
-        config.metrics.quad_count = 0;
-        config.metrics.index_count = 0;
-        config.metrics.vertex_count = 0;
-        config.metrics.texture_count = 0;
+        config.metrics.quad_sort_duration_ms = Time::as<Microseconds>(Time::now() - start_time).count() / 1000.0;
     }
 
-    void Renderer::begin_frame_command_buffer(const VulkanCommandBuffer& command_buffer) const {
-        ST_ASSERT_THROW_VK(
-            command_buffer.reset(),
-            "Could not reset frame command buffer"
-        );
-        ST_ASSERT_THROW_VK(
-            command_buffer.begin(),
-            "Could not begin frame command buffer"
-        );
-    }
+    u64 Renderer::get_quad_sort_key(u32 view_index, bool opaque, u16 layer, u32 texture_id, f32 depth) {
+        //
+        // Sort key layout (most significant bits first):
+        //
+        // | View (8) | Pass (1) | Layer (16) | Texture (23) | Depth (16) |
+        //
+        // Opaque quads (pass 0) are drawn before all other quads (pass 1) of the view. Their layers are drawn
+        // front-to-back (highest layer first), so that the fragments they hide on lower layers are rejected by the
+        // depth test before they are shaded. Translucent quads are drawn back-to-front (lowest layer first), so that
+        // they are blended with whatever is behind them.
+        //
+        // The vertex shader encodes the depth of the quad within its layer in the depth that is tested, so opaque quads
+        // are ordered by the depth test alone and are only grouped by texture within a layer, without any depth bits.
+        // Translucent quads don't write depth, so quads of the same texture are drawn back-to-front (highest depth
+        // first) within a layer. Overlapping translucent quads of different textures should be on separate layers.
+        //
+        // Texture IDs are truncated to 23 bits. Two textures whose IDs collide are merely not guaranteed to end up
+        // next to each other, which can cost an extra batch but never renders anything incorrectly.
+        //
+        // The depth is mapped to an unsigned integer with the same ordering as the float (flip all bits of negative
+        // numbers and only the sign bit of positive numbers), and only its most significant bits are kept.
+        //
 
-    void Renderer::end_frame_command_buffer(const VulkanCommandBuffer& command_buffer) const {
-        ST_ASSERT_THROW_VK(
-            command_buffer.end(),
-            "Could not end frame command buffer"
-        );
-    }
+        u32 depth_bits = std::bit_cast<u32>(depth);
+        depth_bits ^= (depth_bits & 0x80000000) != 0 ? 0xFFFFFFFF : 0x80000000;
 
-    void Renderer::write_batch_descriptors(const Batch& batch) const {
-        const VulkanDescriptorSet& descriptor_set = batch.descriptor_set;
-        const std::vector<Shared<VulkanImage>>& textures = batch.textures;
+        u16 layer_bits = opaque ? (u16) ~layer : layer;
+        u16 depth_order_bits = opaque ? 0 : (u16) ~(depth_bits >> 16);
 
-        ST_ASSERT(
-            textures.size() == max_textures_per_batch,
-            "Number of textures [" << textures.size() << "] must be equal to number of sampler descriptors [" << max_textures_per_batch << "]"
-        );
+        u64 view_key = (u64) (view_index & 0xFF) << quad_sort_key_view_shift;
+        u64 pass_key = (u64) (opaque ? 0 : 1) << quad_sort_key_pass_shift;
+        u64 layer_key = (u64) layer_bits << quad_sort_key_layer_shift;
+        u64 texture_key = (u64) (texture_id & 0x7FFFFF) << quad_sort_key_texture_shift;
+        u64 depth_key = depth_order_bits;
 
-        std::vector<VkDescriptorImageInfo> image_descriptor_infos(textures.size());
-        for (u32 i = 0; i < image_descriptor_infos.size(); i++) {
-            const Shared<VulkanImage>& texture = textures.at(i);
-            ST_ASSERT_NOT_NULL(texture);
+        return view_key | pass_key | layer_key | texture_key | depth_key;
+    }
 
-            VkImageView image_view = texture->get_view();
-            ST_ASSERT_NOT_NULL(image_view);
+    void Renderer::write_quad_instance_data(QuadInstanceData& quad_instance_data, const Quad& quad, u32 texture_index) {
+        //
+        // Pack the quad into the compact 2D instance format.
+        //
+        // The model matrix is reduced to a 2D affine transform: the x and y axes of the matrix (scale, rotation and
+        // shear in the XY-plane) and its translation. The Z-translation is kept as depth, any other 3D components of
+        // the matrix are ignored as quads are always rendered flat in the XY-plane.
+        //
+        // Color and texture rectangle are packed as normalized integers (RGBA8 and unorm16) and are unpacked by the
+        // vertex input stage, according to the attribute formats in the pipeline's vertex input description.
+        //
 
-            image_descriptor_infos.at(i).imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            image_descriptor_infos.at(i).imageView = image_view;
-            image_descriptor_infos.at(i).sampler = texture_sampler;
-        }
+        const glm::mat4& model = quad.model;
+        quad_instance_data.transform = glm::vec4(model[0][0], model[0][1], model[1][0], model[1][1]);
+        quad_instance_data.position = glm::vec2(model[3][0], model[3][1]);
+        quad_instance_data.depth = model[3][2];
+        quad_instance_data.color = glm::packUnorm4x8(quad.color);
+        quad_instance_data.texture_rectangle = glm::packUnorm4x16(quad.texture_rectangle);
+        quad_instance_data.texture_index = texture_index;
+        quad_instance_data.layer = quad.layer;
+    }
 
-        VkWriteDescriptorSet descriptor_write{};
-        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-        descriptor_write.dstSet = descriptor_set;
-        descriptor_write.dstBinding = 0;
-        descriptor_write.dstArrayElement = 0;
-        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        descriptor_write.descriptorCount = image_descriptor_infos.size();
-        descriptor_write.pImageInfo = image_descriptor_infos.data();
+    Batch& Renderer::get_quad_batch(Frame& frame, bool opaque) {
+        // Opaque and translucent quads are drawn with different pipelines, so they can't share a batch.
+        Batch* batch = &get_current_batch(frame);
+        if (batch->quad_index > 0 && batch->opaque != opaque) {
+            flush(frame, *batch);
+            batch = &get_current_batch(frame);
+        }
+        batch->opaque = opaque;
+        return *batch;
+    }
 
-        descriptor_set.write(config.device, descriptor_write);
+    void Renderer::bind_quad_graphics_pipeline(Frame& frame, bool opaque) const {
+        if (opaque) {
+            bind_quad_graphics_pipeline(frame, opaque_quad_graphics_pipeline, "Bind opaque quad graphics pipeline");
+        } else {
+            bind_quad_graphics_pipeline(frame, quad_graphics_pipeline, "Bind quad graphics pipeline");
+        }
     }
 
-    VulkanCommandPool Renderer::create_init_command_pool() {
-        return VulkanCommandPool({
-            .name = std::format("{} init command pool", config.name),
-            .device = config.device,
-            .queue_family_index = config.device.get_graphics_queue_family_index(),
-            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+    void Renderer::bind_quad_graphics_pipeline(Frame& frame, VkPipeline pipeline, const char* label) const {
+        if (frame.quad_graphics_pipeline == pipeline) {
+            return;
+        }
+
+        // All quad pipelines have identical layouts, so the view projection and descriptor sets that are bound stay
+        // valid when switching between them.
+        config.device.insert_cmd_label(frame.command_buffer, label);
+        frame.command_buffer.bind_pipeline({
+            .pipeline = pipeline,
+            .bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        });
+        frame.quad_graphics_pipeline = pipeline;
+    }
+
+    Batch& Renderer::get_current_batch(Frame& frame) {
+        // All batches of the frame have been used, allocate a new one. It's kept in the frame and reused in the
+        // following frames, so this only happens the first time a frame needs more batches than it has ever needed.
+        if (frame.batch_index >= frame.batches.size()) {
+            u32 frame_number = frame_index + 1;
+            u32 batch_number = frame.batch_index + 1;
+            ST_LOG_D("Allocating batch [{}] for frame [{}/{}]", batch_number, frame_number, config.frame_count);
+            if (frame.batches.size() >= frame.batch_capacity) {
+                create_batch_buffers(frame, frame_number, frame.batch_capacity * 2);
+            }
+            frame.batches.push_back(create_batch(frame, frame_number, frame.batch_index));
+        }
+        ST_ASSERT_IN_BOUNDS(frame.batch_index, frame.batches);
+        return frame.batches[frame.batch_index];
+    }
+
+    void Renderer::flush_current_batch(Frame& frame) const {
+        if (frame.batch_index < frame.batches.size() && frame.batches.at(frame.batch_index).quad_index > 0) {
+            flush(frame, frame.batches.at(frame.batch_index));
+        }
+
+        // Whatever is recorded next (f.ex. a new view projection or a tile layer) must come after the flushed batches.
+        draw_pending_batches(frame);
+    }
+
+    void Renderer::flush(Frame& frame, Batch& batch) const {
+        ST_ASSERT(&batch == &frame.batches.at(frame.batch_index), "Only the current batch can be flushed");
+
+        //
+        // Instances
+        //
+
+        // Upload the staged quad instance data to the batch's range of the instance buffer. Only the instances that
+        // have been submitted to this batch are copied, the rest of the range is never read by the draw. When direct
+        // instance writes are enabled, the quads are already in the instance buffer and there is nothing to upload.
+        if (!config.direct_instance_writes_enabled) {
+            VkDeviceSize instance_data_size = sizeof(QuadInstanceData) * batch.quad_index;
+            VkDeviceSize instance_data_offset = sizeof(QuadInstanceData) * batch.first_quad;
+            frame.instance_buffer.set_data(batch.staged_quads.data(), instance_data_size, instance_data_offset);
+            config.metrics.instance_bytes_uploaded += instance_data_size;
+        }
+
+        //
+        // Draw command
+        //
+
+        // Batches are drawn together when they use the same pipeline. Batches that are drawn with a different pipeline,
+        // or that bind their own textures, end the pending draw.
+        if (frame.pending_draw_batch_count > 0) {
+            const Batch& pending_batch = frame.batches.at(frame.pending_draw_batch_index);
+            if (!indirect_draws_enabled || pending_batch.opaque != batch.opaque) {
+                draw_pending_batches(frame);
+            }
+        }
+        if (frame.pending_draw_batch_count == 0) {
+            frame.pending_draw_batch_index = frame.batch_index;
+        }
+
+        // Draw all the instanced quads in the batch using the base quad vertices and indices.
+        ST_ASSERT(frame.batch_index < frame.batch_capacity, "Batch index [" << frame.batch_index << "] must be less than the batch capacity [" << frame.batch_capacity << "] of the frame");
+        VkDrawIndexedIndirectCommand& indirect_command = frame.indirect_commands[frame.batch_index];
+        indirect_command.indexCount = (u32) base_quad_indices.size();
+        indirect_command.instanceCount = batch.quad_index;
+        indirect_command.firstIndex = 0;
+        indirect_command.vertexOffset = 0;
+        indirect_command.firstInstance = batch.first_quad;
+        frame.pending_draw_batch_count++;
+
+        //
+        // End batch
+        //
+
+        // Advance to the next batch. Don't need to clean up/reset anything here because no batches are reused in the
+        // same frame. A frame will continue to use the next available batch, and allocate new ones when all batches
+        // have been used.
+        frame.batch_index++;
+
+        if (!indirect_draws_enabled) {
+            draw_pending_batches(frame);
+        }
+    }
+
+    void Renderer::draw_pending_batches(Frame& frame) const {
+        if (frame.pending_draw_batch_count == 0) {
+            return;
+        }
+        const VulkanCommandBuffer& command_buffer = frame.command_buffer;
+        Batch& batch = frame.batches.at(frame.pending_draw_batch_index);
+
+        bind_quad_graphics_pipeline(frame, batch.opaque);
+        bind_quad_buffers(command_buffer, frame.instance_buffer);
+
+        //
+        // Descriptors
+        //
+
+        // Write all descriptors that are specific to this batch (f.ex. texture samplers). Without bindless textures,
+        // every batch is drawn on its own.
+        if (!bindless_textures_enabled) {
+            write_batch_descriptors(batch);
+        }
+
+        bind_texture_descriptor_set(command_buffer, batch.descriptor_set);
+
+        //
+        // Draw
+        //
+
+        // Time the draw when draws are timed individually, as long as the frame has queries left.
+        bool draw_timed = gpu_timestamps_enabled && gpu_draw_timestamps_enabled && frame.timestamp_query_count + 2 <= timestamp_query_capacity;
+        if (draw_timed) {
+            write_timestamp(frame, frame.timestamp_query_count++);
+        }
+
+        if (indirect_draws_enabled) {
+            // Draw all pending batches with the draw commands that were written to the indirect buffer when they were
+            // flushed. Every command selects the range of the instance buffer that belongs to its batch.
+            config.device.insert_cmd_label(command_buffer, "Draw indexed indirect");
+            command_buffer.draw_indexed_indirect({
+                .buffer = frame.indirect_buffer,
+                .offset = sizeof(VkDrawIndexedIndirectCommand) * frame.pending_draw_batch_index,
+                .draw_count = frame.pending_draw_batch_count,
+                .stride = sizeof(VkDrawIndexedIndirectCommand),
+            });
+        } else {
+            ST_ASSERT(frame.pending_draw_batch_count == 1, "Batches must be drawn one at a time without indirect draws");
+            const VkDrawIndexedIndirectCommand& indirect_command = frame.indirect_commands[frame.pending_draw_batch_index];
+            config.device.insert_cmd_label(command_buffer, "Draw indexed");
+            command_buffer.draw_indexed({
+                .index_count = indirect_command.indexCount,
+                .instance_count = indirect_command.instanceCount,
+                .first_index = indirect_command.firstIndex,
+                .vertex_offset = indirect_command.vertexOffset,
+                .first_instance = indirect_command.firstInstance,
+            });
+        }
+
+        if (draw_timed) {
+            write_timestamp(frame, frame.timestamp_query_count++);
+        }
+
+        frame.pending_draw_batch_count = 0;
+
+        // Update metrics
+        config.metrics.draw_calls++;
+    }
+
+    void Renderer::bind_quad_buffers(const VulkanCommandBuffer& command_buffer, VkBuffer instance_vertex_buffer) const {
+        // Bind both the base and instance vertex buffers. The base quad will be reused to draw all quad instances.
+        config.device.insert_cmd_label(command_buffer, "Bind vertex buffers");
+        VkBuffer vertex_buffers[] = {
+            base_quad_vertex_buffer, // Binding 0 (Base vertices)
+            instance_vertex_buffer, // Binding 1 (Instance vertices)
+        };
+        VkDeviceSize vertex_buffer_offsets[] = {
+            0, // Binding 0 (Base vertices)
+            0 // Binding 1 (Instance vertices)
+        };
+        command_buffer.bind_vertex_buffers({
+            .first_binding = 0, // Binding 0 (Base vertices)
+            .binding_count = 2,
+            .vertex_buffers = vertex_buffers,
+            .offsets = vertex_buffer_offsets,
+        });
+
+        // Bind the base quad index buffer that contains the indices for the base quad.
+        // We only need indices for the single base quad because all submitted quads are instanced.
+        config.device.insert_cmd_label(command_buffer, "Bind index buffer");
+        command_buffer.bind_index_buffer({
+            .index_buffer = base_quad_index_buffer,
+            .index_type = index_type,
+            .offset = 0,
+        });
+    }
+
+    void Renderer::bind_texture_descriptor_set(const VulkanCommandBuffer& command_buffer, const VulkanDescriptorSet& descriptor_set) const {
+        if (bindless_textures_enabled) {
+            // Bind the bindless texture array. It already contains all textures, so there is nothing to write.
+            config.device.insert_cmd_label(command_buffer, "Bind bindless descriptor set");
+            command_buffer.bind_descriptor_sets({
+                .pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                .pipeline_layout = quad_graphics_pipeline.get_pipeline_layout(),
+                .first_set = 0, // Set 0 (bindless textures)
+                .descriptor_set_count = 1,
+                .descriptor_sets = (VkDescriptorSet*) &bindless_descriptor_set,
+            });
+        } else {
+            // Bind the descriptor set that contains the texture samplers of the batch.
+            config.device.insert_cmd_label(command_buffer, "Bind batch descriptor set");
+            command_buffer.bind_descriptor_sets({
+                .pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
+                .pipeline_layout = quad_graphics_pipeline.get_pipeline_layout(),
+                .first_set = 0, // Set 0 (per-batch)
+                .descriptor_set_count = 1,
+                .descriptor_sets = (VkDescriptorSet*) &descriptor_set,
+            });
+        }
+    }
+
+    void Renderer::upscale_render_target(Frame& frame) const {
+        const VulkanCommandBuffer& command_buffer = frame.command_buffer;
+
+        // Everything that is drawn after this point (f.ex. ImGui) is drawn to the swapchain at window resolution, which
+        // is why the swapchain render pass is left open for `end_frame` to end.
+        render_target->end_render_pass(command_buffer);
+        config.swapchain.begin_render_pass(command_buffer);
+
+        config.device.insert_cmd_label(command_buffer, "Set upscale viewport");
+        command_buffer.set_viewport(get_upscale_viewport());
+
+        config.device.insert_cmd_label(command_buffer, "Bind upscale graphics pipeline");
+        upscale_graphics_pipeline->bind(command_buffer);
+
+        config.device.insert_cmd_label(command_buffer, "Bind upscale descriptor set");
+        command_buffer.bind_descriptor_sets({
+            .pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .pipeline_layout = upscale_graphics_pipeline->get_pipeline_layout(),
+            .first_set = 0, // Set 0 (render target)
+            .descriptor_set_count = 1,
+            .descriptor_sets = (VkDescriptorSet*) &upscale_descriptor_set,
+        });
+
+        config.device.insert_cmd_label(command_buffer, "Draw upscaled render target");
+        command_buffer.draw({
+            .vertex_count = upscale_vertex_count,
+            .instance_count = 1,
+            .first_vertex = 0,
+            .first_instance = 0,
+        });
+
+        // Restore the full viewport that was set by the swapchain render pass.
+        const VkExtent2D& swapchain_extent = config.swapchain.get_image_extent();
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = (f32) swapchain_extent.width;
+        viewport.height = (f32) swapchain_extent.height;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        command_buffer.set_viewport(viewport);
+
+        // The quad pipelines are no longer bound.
+        frame.quad_graphics_pipeline = nullptr;
+
+        config.metrics.draw_calls++;
+    }
+
+    VkViewport Renderer::get_upscale_viewport() const {
+        VkExtent2D render_target_extent = render_target->get_extent();
+        const VkExtent2D& swapchain_extent = config.swapchain.get_image_extent();
+
+        f32 scale = std::min(
+            (f32) swapchain_extent.width / (f32) render_target_extent.width,
+            (f32) swapchain_extent.height / (f32) render_target_extent.height
+        );
+
+        // A window that is smaller than the internal resolution can't fit a whole multiple of it, so the render target
+        // is scaled down to fit instead.
+        if (config.integer_scaling_enabled && scale >= 1.0f) {
+            scale = std::floor(scale);
+        }
+
+        f32 width = (f32) render_target_extent.width * scale;
+        f32 height = (f32) render_target_extent.height * scale;
+
+        // Center the upscaled image. The offset is rounded to whole pixels so that the pixel grids line up.
+        VkViewport viewport{};
+        viewport.x = std::floor(((f32) swapchain_extent.width - width) / 2.0f);
+        viewport.y = std::floor(((f32) swapchain_extent.height - height) / 2.0f);
+        viewport.width = width;
+        viewport.height = height;
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        return viewport;
+    }
+
+    void Renderer::reset(Frame& frame) const {
+        // Keep track of the largest number of batches used by any frame, so the initial batch count can be tuned.
+        config.metrics.batch_high_water_mark = std::max(config.metrics.batch_high_water_mark, (u64) frame.batch_index);
+
+        // Reset used batches in frame (including the current batch, which may have been written to but not flushed)
+        for (u32 i = 0; i <= frame.batch_index && i < frame.batches.size(); i++) {
+            Batch& batch = frame.batches.at(i);
+            batch.quad_index = 0;
+
+            // Reset used textures in batch
+            for (u32 j = 0; j < batch.texture_index; j++) {
+                batch.textures.at(j) = placeholder_texture.get();
+            }
+            batch.texture_slots.clear();
+            batch.texture_index = 0;
+        }
+
+        // Reset frame
+        frame.batch_index = 0;
+        frame.pending_draw_batch_count = 0;
+        frame.quad_commands.clear();
+        frame.quad_sort_entries.clear();
+        frame.view_projections.clear();
+        frame.view_cull_rectangles.clear();
+        frame.cull_rectangle_set = false;
+
+        // Reset metrics
+        config.metrics.draw_calls = 0;
+        config.metrics.quad_count = 0;
+        config.metrics.index_count = 0;
+        config.metrics.vertex_count = 0;
+        config.metrics.texture_count = 0;
+        config.metrics.instance_bytes_uploaded = 0;
+        config.metrics.quad_sort_duration_ms = 0.0;
+        config.metrics.visible_quad_count = 0;
+        config.metrics.culled_quad_count = 0;
+        config.metrics.static_quad_count = 0;
+        config.metrics.tile_count = 0;
+        config.metrics.descriptor_writes = 0;
+    }
+
+    void Renderer::begin_frame_command_buffer(const VulkanCommandBuffer& command_buffer) const {
+        ST_ASSERT_THROW_VK(
+            command_buffer.reset(),
+            "Could not reset frame command buffer"
+        );
+        ST_ASSERT_THROW_VK(
+            command_buffer.begin(),
+            "Could not begin frame command buffer"
+        );
+    }
+
+    void Renderer::end_frame_command_buffer(const VulkanCommandBuffer& command_buffer) const {
+        ST_ASSERT_THROW_VK(
+            command_buffer.end(),
+            "Could not end frame command buffer"
+        );
+    }
+
+    void Renderer::write_static_batch(StaticBatch& static_batch, const std::vector<Quad>& quads) {
+        ST_ASSERT(quads.size() <= std::numeric_limits<u32>::max(), "Quad count [" << quads.size() << "] must fit in 32 bits");
+        u32 quad_count = (u32) quads.size();
+
+        static_batch.segments.clear();
+        static_batch.textures.clear();
+
+        std::vector<QuadInstanceData> quad_instances(quad_count);
+        std::unordered_set<u32> texture_ids;
+
+        // The texture slots of the current segment, when bindless textures are disabled.
+        std::unordered_map<u32, u32> texture_slots;
+        std::vector<const VulkanImage*> segment_textures(max_textures_per_batch, placeholder_texture.get());
+        u32 segment_first_instance = 0;
+
+        auto add_segment = [&](u32 segment_end_instance) {
+            StaticBatchSegment& segment = static_batch.segments.emplace_back();
+            segment.first_instance = segment_first_instance;
+            segment.instance_count = segment_end_instance - segment_first_instance;
+
+            if (!bindless_textures_enabled) {
+                u32 segment_index = (u32) static_batch.segments.size() - 1;
+                if (segment_index >= static_batch.descriptor_sets.size()) {
+                    std::string descriptor_set_name = std::format("{} {} descriptor set {}", config.name, static_batch.name, segment_index + 1);
+                    static_batch.descriptor_sets.push_back(allocate_batch_descriptor_set(descriptor_set_name));
+                }
+                segment.descriptor_set = static_batch.descriptor_sets[segment_index];
+                write_texture_descriptors(segment.descriptor_set, segment_textures);
+            }
+
+            segment_first_instance = segment_end_instance;
+        };
+
+        for (u32 i = 0; i < quad_count; i++) {
+            const Quad& quad = quads[i];
+
+            // The batch keeps its textures for as long as it exists, so they must be ready, or it would be drawn with
+            // the placeholder texture forever. See `write_static_batch_if_ready`.
+            const Shared<VulkanImage>& texture = quad.texture != nullptr ? quad.texture : placeholder_texture;
+            ST_ASSERT_NOT_NULL(texture);
+            ST_ASSERT(texture->is_ready(), "Texture [" << texture->get_name() << "] of static batch [" << static_batch.name << "] must be ready");
+
+            if (texture_ids.insert(texture->get_id()).second) {
+                static_batch.textures.push_back(texture);
+            }
+
+            u32 texture_index;
+            if (bindless_textures_enabled) {
+                texture_index = get_bindless_texture_index(texture);
+            } else {
+                // Start a new segment when the current one has run out of texture slots.
+                auto texture_slot = texture_slots.find(texture->get_id());
+                if (texture_slot == texture_slots.end()) {
+                    if (texture_slots.size() >= max_textures_per_batch) {
+                        add_segment(i);
+                        texture_slots.clear();
+                        std::ranges::fill(segment_textures, placeholder_texture.get());
+                    }
+                    texture_slot = texture_slots.emplace(texture->get_id(), (u32) texture_slots.size()).first;
+                    segment_textures[texture_slot->second] = texture.get();
+                }
+                texture_index = texture_slot->second | get_texture_index_flags(*texture);
+            }
+
+            write_quad_instance_data(quad_instances[i], quad, texture_index);
+        }
+
+        if (quad_count > 0) {
+            add_segment(quad_count);
+        }
+
+        // Only allocate a new vertex buffer when the quads don't fit in the current one.
+        if (quad_count > static_batch.quad_capacity || static_batch.quad_capacity == 0) {
+            u32 quad_capacity = std::max(quad_count, 1u);
+            static_batch.vertex_buffer = VulkanVertexBuffer({
+                .name = std::format("{} {} vertex buffer", config.name, static_batch.name),
+                .device = &config.device,
+                .size = sizeof(QuadInstanceData) * quad_capacity,
+                .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                .memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            });
+            static_batch.quad_capacity = quad_capacity;
+        }
+        static_batch.quad_count = quad_count;
+
+        if (quad_count == 0) {
+            return;
+        }
+
+        upload_buffer_data(static_batch.vertex_buffer, quad_instances.data(), sizeof(QuadInstanceData) * quad_count);
+    }
+
+    bool Renderer::write_static_batch_if_ready(StaticBatch& static_batch) {
+        if (static_batch.pending_quads.empty()) {
+            return true;
+        }
+        for (const Quad& quad : static_batch.pending_quads) {
+            if (quad.texture != nullptr && !quad.texture->is_ready()) {
+                return false;
+            }
+        }
+        write_static_batch(static_batch, static_batch.pending_quads);
+        static_batch.pending_quads = {};
+        return true;
+    }
+
+    void Renderer::write_tile_layer_descriptors(const TileLayer& tile_layer) const {
+        VkDescriptorBufferInfo tile_id_buffer_info{};
+        tile_id_buffer_info.buffer = tile_layer.tile_id_buffer;
+        tile_id_buffer_info.offset = 0;
+        tile_id_buffer_info.range = VK_WHOLE_SIZE;
+
+        VkDescriptorBufferInfo tile_data_buffer_info{};
+        tile_data_buffer_info.buffer = tile_layer.tile_data_buffer;
+        tile_data_buffer_info.offset = 0;
+        tile_data_buffer_info.range = VK_WHOLE_SIZE;
+
+        // Unused sampler slots are filled with the placeholder texture, all descriptors in the array must be valid.
+        std::vector<VkDescriptorImageInfo> image_descriptor_infos(max_textures_per_batch);
+        for (u32 i = 0; i < image_descriptor_infos.size(); i++) {
+            const VulkanImage* texture = i < tile_layer.textures.size() ? tile_layer.textures[i].get() : placeholder_texture.get();
+            ST_ASSERT_NOT_NULL(texture);
+            image_descriptor_infos.at(i).imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            image_descriptor_infos.at(i).imageView = texture->get_view();
+            image_descriptor_infos.at(i).sampler = texture_sampler;
+        }
+
+        std::vector<VkWriteDescriptorSet> descriptor_writes(3);
+
+        descriptor_writes[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_writes[0].dstSet = tile_layer.descriptor_set;
+        descriptor_writes[0].dstBinding = 0;
+        descriptor_writes[0].dstArrayElement = 0;
+        descriptor_writes[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_writes[0].descriptorCount = 1;
+        descriptor_writes[0].pBufferInfo = &tile_id_buffer_info;
+
+        descriptor_writes[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_writes[1].dstSet = tile_layer.descriptor_set;
+        descriptor_writes[1].dstBinding = 1;
+        descriptor_writes[1].dstArrayElement = 0;
+        descriptor_writes[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_writes[1].descriptorCount = 1;
+        descriptor_writes[1].pBufferInfo = &tile_data_buffer_info;
+
+        descriptor_writes[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_writes[2].dstSet = tile_layer.descriptor_set;
+        descriptor_writes[2].dstBinding = 2;
+        descriptor_writes[2].dstArrayElement = 0;
+        descriptor_writes[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_writes[2].descriptorCount = image_descriptor_infos.size();
+        descriptor_writes[2].pImageInfo = image_descriptor_infos.data();
+
+        tile_layer.descriptor_set.write(config.device, descriptor_writes);
+        config.metrics.descriptor_writes++;
+    }
+
+    bool Renderer::write_tile_layer_descriptors_if_ready(TileLayer& tile_layer) const {
+        if (tile_layer.descriptors_written) {
+            return true;
+        }
+        for (const Shared<Texture>& texture : tile_layer.textures) {
+            if (!texture->is_ready()) {
+                return false;
+            }
+        }
+        write_tile_layer_descriptors(tile_layer);
+        tile_layer.descriptors_written = true;
+        return true;
+    }
+
+    void Renderer::write_upscale_descriptors() const {
+        VkDescriptorImageInfo image_descriptor_info{};
+        image_descriptor_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        image_descriptor_info.imageView = render_target->get_color_image().get_view();
+        image_descriptor_info.sampler = texture_sampler; // Nearest filtering keeps the upscaled pixels sharp.
+
+        VkWriteDescriptorSet descriptor_write{};
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstSet = upscale_descriptor_set;
+        descriptor_write.dstBinding = 0;
+        descriptor_write.dstArrayElement = 0;
+        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_write.descriptorCount = 1;
+        descriptor_write.pImageInfo = &image_descriptor_info;
+
+        upscale_descriptor_set.write(config.device, descriptor_write);
+        config.metrics.descriptor_writes++;
+    }
+
+    std::vector<u32> Renderer::get_tile_ids(const TiledLayer& tiled_layer) {
+        u32 tile_count = (u32) (tiled_layer.width * tiled_layer.height);
+        if (tiled_layer.data.size() != tile_count) {
+            ST_THROW("Could not get tile IDs of layer [" << tiled_layer.name << "], expected [" << tile_count << "] tiles but got [" << tiled_layer.data.size() << "] (infinite maps are not supported)");
+        }
+        // GIDs are stored as signed integers, but are unsigned 32-bit values where the highest bits are the flip flags.
+        std::vector<u32> tile_ids(tile_count);
+        for (u32 i = 0; i < tile_count; i++) {
+            tile_ids[i] = (u32) tiled_layer.data[i];
+        }
+        return tile_ids;
+    }
+
+    VulkanBuffer Renderer::create_storage_buffer(const void* data, VkDeviceSize size, std::string_view name) const {
+        VulkanBuffer storage_buffer({
+            .device = &config.device,
+            .name = std::string(name),
+            .size = size,
+            .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        });
+        set_storage_buffer_data(storage_buffer, data, size);
+        return storage_buffer;
+    }
+
+    void Renderer::set_storage_buffer_data(const VulkanBuffer& storage_buffer, const void* data, VkDeviceSize size) const {
+        upload_buffer_data(storage_buffer, data, size);
+    }
+
+    void Renderer::upload_buffer_data(VkBuffer buffer, const void* data, VkDeviceSize size) const {
+        // Data that is larger than the staging ring is uploaded in chunks, with a submission per chunk so that the ring
+        // can reuse the memory of a chunk once its copy has completed.
+        VulkanStagingRing& staging_ring = config.device.get_staging_ring();
+        VkDeviceSize chunk_size = staging_ring.get_size();
+        for (VkDeviceSize offset = 0; offset < size; offset += chunk_size) {
+            VkDeviceSize copy_size = std::min(chunk_size, size - offset);
+            init_command_pool.record_and_submit_commands([&](const VulkanCommandBuffer& command_buffer) {
+                VulkanStagingRegion staging_region = staging_ring.stage((const u8*) data + offset, copy_size);
+
+                VkBufferCopy copy_region{};
+                copy_region.srcOffset = staging_region.offset;
+                copy_region.dstOffset = offset;
+                copy_region.size = copy_size;
+
+                constexpr u32 copy_region_count = 1;
+                command_buffer.copy_buffer(staging_region.buffer, buffer, copy_region_count, &copy_region);
+            });
+        }
+    }
+
+    void Renderer::write_batch_descriptors(Batch& batch) const {
+        //
+        // Only write the descriptor set when its textures have changed.
+        //
+        // Batches are reused every frame, and a scene usually renders the same textures in the same order from one
+        // frame to the next, so the batch's sampler slots often hold exactly the textures its descriptor set already
+        // refers to. The texture IDs of the slots are compared directly instead of a hash of them, which is just as
+        // cheap for a handful of slots and can never mistake a different set of textures for the cached one.
+        //
+
+        std::vector<u32>& descriptor_texture_ids = batch.descriptor_texture_ids;
+        ST_ASSERT(descriptor_texture_ids.size() == batch.textures.size(), "Batch must have a cached texture ID per sampler slot");
+
+        bool textures_changed = false;
+        for (u32 i = 0; i < batch.textures.size(); i++) {
+            const VulkanImage* texture = batch.textures[i];
+            ST_ASSERT_NOT_NULL(texture);
+            u32 texture_id = texture->get_id();
+            textures_changed |= descriptor_texture_ids[i] != texture_id;
+            descriptor_texture_ids[i] = texture_id;
+        }
+        if (!textures_changed) {
+            return;
+        }
+
+        write_texture_descriptors(batch.descriptor_set, batch.textures);
+    }
+
+    void Renderer::write_texture_descriptors(const VulkanDescriptorSet& descriptor_set, const std::vector<const VulkanImage*>& textures) const {
+        ST_ASSERT(
+            textures.size() == max_textures_per_batch,
+            "Number of textures [" << textures.size() << "] must be equal to number of sampler descriptors [" << max_textures_per_batch << "]"
+        );
+
+        // Fixed-size storage on the stack, so writing descriptors never allocates.
+        std::array<VkDescriptorImageInfo, max_textures_per_batch> image_descriptor_infos{};
+        for (u32 i = 0; i < image_descriptor_infos.size(); i++) {
+            const VulkanImage* texture = textures[i];
+            ST_ASSERT_NOT_NULL(texture);
+
+            VkImageView image_view = texture->get_view();
+            ST_ASSERT_NOT_NULL(image_view);
+
+            image_descriptor_infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            image_descriptor_infos[i].imageView = image_view;
+            image_descriptor_infos[i].sampler = texture_sampler;
+        }
+
+        VkWriteDescriptorSet descriptor_write{};
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstSet = descriptor_set;
+        descriptor_write.dstBinding = 0;
+        descriptor_write.dstArrayElement = 0;
+        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_write.descriptorCount = image_descriptor_infos.size();
+        descriptor_write.pImageInfo = image_descriptor_infos.data();
+
+        descriptor_set.write(config.device, descriptor_write);
+        config.metrics.descriptor_writes++;
+    }
+
+    StaticBatch Renderer::create_static_batch(const std::vector<Quad>& quads, std::string_view name) {
+        StaticBatch static_batch{};
+        static_batch.name = name;
+        static_batch.pending_quads = quads;
+        write_static_batch_if_ready(static_batch);
+        return static_batch;
+    }
+
+    void Renderer::rebuild_static_batch(StaticBatch& static_batch, const std::vector<Quad>& quads) {
+        wait_until_idle();
+        static_batch.pending_quads = quads;
+        write_static_batch_if_ready(static_batch);
+    }
+
+    void Renderer::render_static_batch(StaticBatch& static_batch) {
+        // Textures that are loaded asynchronously may still be uploading. The batch is not drawn until all of them are
+        // ready, so that their quads are written with the real textures instead of the placeholder texture.
+        if (!write_static_batch_if_ready(static_batch)) {
+            return;
+        }
+        if (static_batch.quad_count == 0) {
+            return;
+        }
+
+        ST_ASSERT_IN_BOUNDS(frame_index, frames);
+        Frame& frame = frames.at(frame_index);
+
+        const VulkanCommandBuffer& command_buffer = frame.command_buffer;
+
+        // Flush any active batch first, so the static batch is drawn in the order it was rendered.
+        flush_current_batch(frame);
+
+        // Deferred view projections are only set when the deferred quads are batched, so set the latest one here.
+        if (config.deferred_rendering_enabled && !frame.view_projections.empty()) {
+            push_view_projection(frame, get_current_view_projection(frame));
+        }
+
+        std::string label_name = std::format("Static batch {}", static_batch.name);
+        config.device.begin_cmd_label(command_buffer, label_name.c_str());
+
+        bind_quad_graphics_pipeline(frame, static_batch_graphics_pipeline, "Bind static batch graphics pipeline");
+
+        bind_quad_buffers(command_buffer, static_batch.vertex_buffer);
+
+        for (const StaticBatchSegment& segment : static_batch.segments) {
+            bind_texture_descriptor_set(command_buffer, segment.descriptor_set);
+
+            config.device.insert_cmd_label(command_buffer, "Draw indexed");
+            command_buffer.draw_indexed({
+                .index_count = (u32) base_quad_indices.size(),
+                .instance_count = segment.instance_count,
+                .first_index = 0,
+                .vertex_offset = 0,
+                .first_instance = segment.first_instance,
+            });
+
+            config.metrics.draw_calls++;
+        }
+
+        config.device.end_cmd_label(command_buffer);
+
+        config.metrics.static_quad_count += static_batch.quad_count;
+    }
+
+    void Renderer::destroy_static_batch(StaticBatch& static_batch) {
+        wait_until_idle();
+        for (const VulkanDescriptorSet& descriptor_set : static_batch.descriptor_sets) {
+            free_batch_descriptor_sets.push_back(descriptor_set);
+        }
+        static_batch = StaticBatch{};
+    }
+
+    TileLayer Renderer::create_tile_layer(const TiledMap& tiled_map, const TiledLayer& tiled_layer, const std::vector<Shared<Texture>>& tileset_textures) {
+        if (tiled_map.tilesets.size() != tileset_textures.size()) {
+            ST_THROW("Could not create tile layer [" << tiled_layer.name << "], expected [" << tiled_map.tilesets.size() << "] tileset textures but got [" << tileset_textures.size() << "]");
+        }
+        if (tileset_textures.size() > max_textures_per_batch) {
+            ST_THROW("Could not create tile layer [" << tiled_layer.name << "], tileset count [" << tileset_textures.size() << "] exceeded the limit [" << max_textures_per_batch << "]");
+        }
+
+        TileLayer tile_layer{};
+        tile_layer.name = tiled_layer.name;
+        tile_layer.width = (u32) tiled_layer.width;
+        tile_layer.height = (u32) tiled_layer.height;
+        tile_layer.tile_size = glm::vec2(tiled_map.tilewidth, tiled_map.tileheight);
+        tile_layer.offset = glm::vec2(tiled_layer.offsetx, tiled_layer.offsety);
+        tile_layer.parallax = glm::vec2(tiled_layer.parallaxx, tiled_layer.parallaxy);
+        tile_layer.textures = tileset_textures;
+
+        //
+        // Tile data lookup table
+        //
+        // The tilesets of the map cover consecutive ranges of global tile IDs (GIDs), starting at their first GID.
+        // Every GID gets the texture rectangle of its tile in the tileset image, so the shader can resolve a tile with
+        // a single lookup. GID 0 is an empty tile and is never looked up.
+        //
+
+        u32 tile_data_count = 1;
+        for (const TiledTileset& tileset : tiled_map.tilesets) {
+            tile_data_count = std::max(tile_data_count, (u32) (tileset.firstgid + tileset.tilecount));
+        }
+        std::vector<TileData> tile_data(tile_data_count);
+
+        for (u32 i = 0; i < tiled_map.tilesets.size(); i++) {
+            const TiledTileset& tileset = tiled_map.tilesets[i];
+
+            // Image collection tilesets have one image per tile and no columns, they can't be resolved from a single
+            // tileset texture.
+            if (tileset.columns <= 0 || tileset.imagewidth <= 0 || tileset.imageheight <= 0) {
+                ST_THROW("Could not create tile layer [" << tiled_layer.name << "], tileset [" << tileset.name << "] must be a single image with at least one column, image collection tilesets are not supported");
+            }
+            // The shader draws every tile with the tile size of the map.
+            if (tileset.tilewidth != tiled_map.tilewidth || tileset.tileheight != tiled_map.tileheight) {
+                ST_THROW("Could not create tile layer [" << tiled_layer.name << "], tile size [" << tileset.tilewidth << "x" << tileset.tileheight << "] of tileset [" << tileset.name << "] must match the tile size [" << tiled_map.tilewidth << "x" << tiled_map.tileheight << "] of the map");
+            }
+            if (tileset_textures[i] == nullptr) {
+                ST_THROW("Could not create tile layer [" << tiled_layer.name << "], texture of tileset [" << tileset.name << "] must not be null");
+            }
+
+            glm::vec2 image_size = glm::vec2(tileset.imagewidth, tileset.imageheight);
+            glm::vec2 tileset_tile_size = glm::vec2(tileset.tilewidth, tileset.tileheight);
+
+            for (u32 local_tile_id = 0; local_tile_id < (u32) tileset.tilecount; local_tile_id++) {
+                u32 column = local_tile_id % tileset.columns;
+                u32 row = local_tile_id / tileset.columns;
+                glm::vec2 tile_position = glm::vec2(
+                    tileset.margin + column * (tileset.tilewidth + tileset.spacing),
+                    tileset.margin + row * (tileset.tileheight + tileset.spacing)
+                );
+
+                TileData& tile = tile_data[tileset.firstgid + local_tile_id];
+                tile.texture_rectangle = glm::vec4(tile_position / image_size, (tile_position + tileset_tile_size) / image_size);
+                tile.texture_index = i | get_texture_index_flags(*tileset_textures[i]);
+            }
+        }
+
+        //
+        // Storage buffers
+        //
+
+        std::vector<u32> tile_ids = get_tile_ids(tiled_layer);
+
+        tile_layer.tile_id_buffer = create_storage_buffer(
+            tile_ids.data(),
+            sizeof(u32) * tile_ids.size(),
+            std::format("{} tile layer [{}] tile ID buffer", config.name, tile_layer.name)
+        );
+        tile_layer.tile_data_buffer = create_storage_buffer(
+            tile_data.data(),
+            sizeof(TileData) * tile_data.size(),
+            std::format("{} tile layer [{}] tile data buffer", config.name, tile_layer.name)
+        );
+
+        //
+        // Descriptors
+        //
+
+        std::string descriptor_set_name = std::format("{} tile layer [{}] descriptor set", config.name, tile_layer.name);
+        tile_layer.descriptor_set = allocate_tile_layer_descriptor_set(descriptor_set_name);
+        write_tile_layer_descriptors_if_ready(tile_layer);
+
+        return tile_layer;
+    }
+
+    void Renderer::update_tile_layer(TileLayer& tile_layer, const TiledLayer& tiled_layer) {
+        if ((u32) tiled_layer.width != tile_layer.width || (u32) tiled_layer.height != tile_layer.height) {
+            ST_THROW("Could not update tile layer [" << tile_layer.name << "], size [" << tiled_layer.width << "x" << tiled_layer.height << "] must match [" << tile_layer.width << "x" << tile_layer.height << "]");
+        }
+        wait_until_idle();
+        std::vector<u32> tile_ids = get_tile_ids(tiled_layer);
+        set_storage_buffer_data(tile_layer.tile_id_buffer, tile_ids.data(), sizeof(u32) * tile_ids.size());
+    }
+
+    void Renderer::render_tile_layer(TileLayer& tile_layer) {
+        u32 tile_count = tile_layer.width * tile_layer.height;
+        if (tile_count == 0) {
+            return;
+        }
+
+        // Tileset textures that are loaded asynchronously may still be uploading. The layer is not drawn until all of
+        // them are ready, as its descriptor set can't be written while frames in flight may be reading it.
+        if (!write_tile_layer_descriptors_if_ready(tile_layer)) {
+            return;
+        }
+
+        ST_ASSERT_IN_BOUNDS(frame_index, frames);
+        Frame& frame = frames.at(frame_index);
+
+        const VulkanCommandBuffer& command_buffer = frame.command_buffer;
+
+        // Flush any active batch first, so the tile layer is drawn in the order it was rendered.
+        flush_current_batch(frame);
+
+        // Tiled moves parallax layers relative to the camera: a layer with a parallax factor of 1 moves with the map,
+        // a factor of 0 stays fixed on screen. The camera position is the translation of the inverse view matrix.
+        const ViewProjection& view_projection = get_current_view_projection(frame);
+        glm::vec2 camera_position = glm::vec2(glm::inverse(view_projection.view)[3]);
+
+        TileLayerPushConstants push_constants{
+            .view_projection = (glm::mat4) view_projection,
+            .offset = tile_layer.offset + camera_position * (1.0f - tile_layer.parallax),
+            .tile_size = tile_layer.tile_size,
+            .width = tile_layer.width,
+            .height = tile_layer.height,
+            .layer = tile_layer.layer,
+        };
+
+        std::string label_name = std::format("Tile layer {}", tile_layer.name);
+        config.device.begin_cmd_label(command_buffer, label_name.c_str());
+
+        command_buffer.bind_pipeline({
+            .pipeline = tile_layer_graphics_pipeline,
+            .bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        });
+
+        command_buffer.bind_descriptor_sets({
+            .pipeline_bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS,
+            .pipeline_layout = tile_layer_graphics_pipeline.get_pipeline_layout(),
+            .first_set = 0, // Set 0 (per-layer)
+            .descriptor_set_count = 1,
+            .descriptor_sets = (VkDescriptorSet*) &tile_layer.descriptor_set,
+        });
+
+        // Without descriptor indexing, the sampler array of the tileset textures may only be indexed uniformly within a
+        // draw. The layer is then drawn once per tileset texture, and every draw collapses the tiles of the others.
+        bool descriptor_indexing_enabled = config.device.is_descriptor_indexing_enabled();
+        u32 draw_count = descriptor_indexing_enabled ? 1 : (u32) tile_layer.textures.size();
+
+        for (u32 i = 0; i < draw_count; i++) {
+            push_constants.texture_index = descriptor_indexing_enabled ? tile_layer_all_textures : i;
+            command_buffer.push_constants({
+                .pipeline_layout = tile_layer_graphics_pipeline.get_pipeline_layout(),
+                .shader_stage = tile_layer_push_constant_stages,
+                .data_size = sizeof(TileLayerPushConstants),
+                .data = &push_constants,
+            });
+
+            // Draw one instance per tile. The vertex shader generates the vertices of the tile from its tile ID.
+            config.device.insert_cmd_label(command_buffer, "Draw");
+            command_buffer.draw({
+                .vertex_count = tile_layer_vertex_count,
+                .instance_count = tile_count,
+                .first_vertex = 0,
+                .first_instance = 0,
+            });
+        }
+
+        // Restore the quad pipeline and its view projection for the quads that are rendered after the layer.
+        frame.quad_graphics_pipeline = nullptr;
+        bind_quad_graphics_pipeline(frame, false);
+        push_view_projection(frame, view_projection);
+
+        config.device.end_cmd_label(command_buffer);
+
+        config.metrics.draw_calls += draw_count;
+        config.metrics.tile_count += tile_count;
+    }
+
+    void Renderer::destroy_tile_layer(TileLayer& tile_layer) {
+        wait_until_idle();
+        if (tile_layer.descriptor_set != nullptr) {
+            free_tile_layer_descriptor_sets.push_back(tile_layer.descriptor_set);
+        }
+        tile_layer.tile_id_buffer = {};
+        tile_layer.tile_data_buffer = {};
+        tile_layer = TileLayer{};
+    }
+
+    void Renderer::submit_render_context(RenderContext& render_context) {
+        submitted_render_contexts.push_back(&render_context);
+    }
+
+    void Renderer::save_frame(const std::filesystem::path& path) {
+        ST_ASSERT(config.swapchain.is_headless(), "Swapchain must be headless to save frames");
+        wait_until_idle();
+
+        const VkExtent2D& extent = config.swapchain.get_image_extent();
+        constexpr u32 bytes_per_pixel = 4;
+
+        VulkanBuffer readback_buffer({
+            .device = &config.device,
+            .name = std::format("{} readback buffer", config.name),
+            .size = (VkDeviceSize) extent.width * extent.height * bytes_per_pixel,
+            .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+            .memory_usage = VulkanMemoryUsage::TRANSIENT,
+        });
+        readback_buffer.map_memory();
+
+        init_command_pool.record_and_submit_commands([&](const VulkanCommandBuffer& command_buffer) {
+            // The render pass leaves the image in the transfer source layout when the swapchain is headless.
+            VkBufferImageCopy copy_region{};
+            copy_region.bufferOffset = 0;
+            copy_region.bufferRowLength = 0;
+            copy_region.bufferImageHeight = 0;
+            copy_region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            copy_region.imageSubresource.mipLevel = 0;
+            copy_region.imageSubresource.baseArrayLayer = 0;
+            copy_region.imageSubresource.layerCount = 1;
+            copy_region.imageOffset = { 0, 0, 0 };
+            copy_region.imageExtent = { extent.width, extent.height, 1 };
+
+            command_buffer.copy_image_to_buffer({
+                .src_image = config.swapchain.get_image(),
+                .src_image_layout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                .dst_buffer = readback_buffer,
+                .copy_region_count = 1,
+                .copy_region = &copy_region,
+            });
+
+            // Make the copied pixels visible to the host.
+            VkMemoryBarrier memory_barrier{};
+            memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            memory_barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+            memory_barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+            command_buffer.pipeline_barrier({
+                .src_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT,
+                .dst_stage_mask = VK_PIPELINE_STAGE_HOST_BIT,
+                .memory_barrier_count = 1,
+                .memory_barriers = &memory_barrier,
+            });
+        });
+
+        std::vector<u8> pixels(readback_buffer.get_size());
+        memcpy(pixels.data(), readback_buffer.get_data(), pixels.size());
+
+        // PNG pixels are RGBA, but images that are rendered for surfaces are usually BGRA.
+        VkFormat format = config.swapchain.get_color_format();
+        if (format == VK_FORMAT_B8G8R8A8_SRGB || format == VK_FORMAT_B8G8R8A8_UNORM) {
+            for (u64 i = 0; i < pixels.size(); i += bytes_per_pixel) {
+                std::swap(pixels[i], pixels[i + 2]);
+            }
+        }
+
+        write_png(path, extent.width, extent.height, pixels.data());
+        ST_LOG_I("Saved frame [{}x{}] to [{}]", extent.width, extent.height, path.string());
+    }
+
+    void Renderer::write_gpu_timestamp(GpuTimestamp timestamp) const {
+        if (!gpu_timestamps_enabled) {
+            return;
+        }
+        ST_ASSERT_IN_BOUNDS(frame_index, frames);
+        write_timestamp(frames.at(frame_index), (u32) timestamp);
+    }
+
+    void Renderer::set_gpu_draw_timestamps_enabled(bool enabled) {
+        gpu_draw_timestamps_enabled = enabled;
+    }
+
+    void Renderer::register_texture(const Shared<Texture>& texture) {
+        if (!bindless_textures_enabled) {
+            return;
+        }
+        ST_ASSERT_NOT_NULL(texture);
+        if (texture->get_descriptor_index() != VulkanImage::no_descriptor_index) {
+            return;
+        }
+
+        //
+        // Find a free index in the bindless texture array.
+        //
+        // Indices are handed out in order until the array is full. After that, the indices of textures that have been
+        // destroyed are reused. The descriptors of destroyed textures are never accessed by shaders, which is allowed
+        // because the array is partially bound.
+        //
+
+        u32 descriptor_index = VulkanImage::no_descriptor_index;
+        if (bindless_textures.size() < bindless_texture_capacity) {
+            descriptor_index = (u32) bindless_textures.size();
+            bindless_textures.push_back(texture);
+        } else {
+            for (u32 i = 0; i < bindless_textures.size(); i++) {
+                if (bindless_textures.at(i).expired()) {
+                    descriptor_index = i;
+                    bindless_textures.at(i) = texture;
+                    break;
+                }
+            }
+        }
+        if (descriptor_index == VulkanImage::no_descriptor_index) {
+            ST_THROW("Could not register texture because the bindless texture array is full [" << bindless_texture_capacity << "]");
+        }
+
+        texture->set_descriptor_index(descriptor_index);
+        write_bindless_texture_descriptor(*texture);
+    }
+
+    u32 Renderer::get_bindless_texture_index(const Shared<VulkanImage>& texture) {
+        u32 descriptor_index = texture->get_descriptor_index();
+        if (descriptor_index == VulkanImage::no_descriptor_index) {
+            // Textures that were not created by the resource loader are registered the first time they are rendered.
+            register_texture(texture);
+            descriptor_index = texture->get_descriptor_index();
+        }
+        return descriptor_index | get_texture_index_flags(*texture);
+    }
+
+    void Renderer::write_bindless_texture_descriptor(const VulkanImage& texture) const {
+        VkImageView image_view = texture.get_view();
+        ST_ASSERT_NOT_NULL(image_view);
+
+        VkDescriptorImageInfo image_descriptor_info{};
+        image_descriptor_info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        image_descriptor_info.imageView = image_view;
+        image_descriptor_info.sampler = texture_sampler;
+
+        // The bindless descriptor set is created with the "update after bind" and "update unused while pending" flags,
+        // so it can be written to at any time, even while it is bound to a command buffer that is being recorded or
+        // executed, as long as this specific descriptor is not used by that command buffer.
+        VkWriteDescriptorSet descriptor_write{};
+        descriptor_write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptor_write.dstSet = bindless_descriptor_set;
+        descriptor_write.dstBinding = 0;
+        descriptor_write.dstArrayElement = texture.get_descriptor_index();
+        descriptor_write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_write.descriptorCount = 1;
+        descriptor_write.pImageInfo = &image_descriptor_info;
+
+        bindless_descriptor_set.write(config.device, descriptor_write);
+        config.metrics.descriptor_writes++;
+    }
+
+    VulkanCommandPool Renderer::create_init_command_pool() {
+        return VulkanCommandPool({
+            .name = std::format("{} init command pool", config.name),
+            .device = config.device,
+            .queue_family_index = config.device.get_graphics_queue_family_index(),
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
         });
     }
 
@@ -371,36 +1808,328 @@ namespace Storytime {
             .memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
         });
 
-        init_command_pool.record_and_submit_commands([&](const VulkanCommandBuffer& command_buffer) {
-            vertex_buffer.set_data(command_buffer, base_quad_vertices.data());
-        });
+        init_command_pool.record_and_submit_commands([&](const VulkanCommandBuffer& command_buffer) {
+            vertex_buffer.set_data(command_buffer, base_quad_vertices.data());
+        });
+
+        return vertex_buffer;
+    }
+
+    VulkanIndexBuffer Renderer::create_base_quad_index_buffer() {
+        auto index_buffer = VulkanIndexBuffer({
+            .name = std::format("{} base quad index buffer", config.name),
+            .device = &config.device,
+            .index_type = index_type,
+            .size = sizeof(Index) * base_quad_indices.size(),
+            .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            .memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        });
+
+        init_command_pool.record_and_submit_commands([&](const VulkanCommandBuffer& command_buffer) {
+            index_buffer.set_data(command_buffer, base_quad_indices.data());
+        });
+
+        return index_buffer;
+    }
+
+    VulkanGraphicsPipeline Renderer::create_quad_graphics_pipeline(bool opaque, bool alpha_discard_enabled) {
+        ST_ASSERT(!opaque || !alpha_discard_enabled, "Opaque quad graphics pipeline must not discard transparent fragments");
+
+        auto vertex_shader_path = ST_RES_DIR / std::filesystem::path("shaders/quad.vert.spv");
+        // Sample from the bindless texture array when it's enabled, or from the per-batch texture samplers otherwise.
+        auto fragment_shader_path = ST_RES_DIR / std::filesystem::path(bindless_textures_enabled ? "shaders/quad_bindless.frag.spv" : "shaders/quad.frag.spv");
+
+        std::string vertex_shader_name = std::format("{} quad vertex shader [{}]", config.name.c_str(), vertex_shader_path.c_str());
+        std::string fragment_shader_name = std::format("{} quad fragment shader [{}]", config.name.c_str(), fragment_shader_path.c_str());
+
+        VkShaderModule vertex_shader = create_shader_module(vertex_shader_path, vertex_shader_name);
+        VkShaderModule fragment_shader = create_shader_module(fragment_shader_path, fragment_shader_name);
+
+        ST_DEFER([&] {
+            destroy_shader_module(vertex_shader);
+            destroy_shader_module(fragment_shader);
+        });
+
+        VkPipelineShaderStageCreateInfo vertex_shader_stage_create_info{};
+        vertex_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vertex_shader_stage_create_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vertex_shader_stage_create_info.module = vertex_shader;
+        vertex_shader_stage_create_info.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fragment_shader_stage_create_info{};
+        fragment_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fragment_shader_stage_create_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fragment_shader_stage_create_info.module = fragment_shader;
+        fragment_shader_stage_create_info.pName = "main";
+
+        // Specialization constant 0 of the quad fragment shader toggles discarding fully transparent fragments.
+        VkBool32 alpha_discard_constant = alpha_discard_enabled ? VK_TRUE : VK_FALSE;
+
+        VkSpecializationMapEntry specialization_map_entry{};
+        specialization_map_entry.constantID = 0;
+        specialization_map_entry.offset = 0;
+        specialization_map_entry.size = sizeof(VkBool32);
+
+        VkSpecializationInfo specialization_info{};
+        specialization_info.mapEntryCount = 1;
+        specialization_info.pMapEntries = &specialization_map_entry;
+        specialization_info.dataSize = sizeof(VkBool32);
+        specialization_info.pData = &alpha_discard_constant;
+
+        fragment_shader_stage_create_info.pSpecializationInfo = &specialization_info;
+
+        std::vector<VkPipelineShaderStageCreateInfo> shader_stage_create_infos = {
+            vertex_shader_stage_create_info,
+            fragment_shader_stage_create_info,
+        };
+
+        std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions = {
+            VkVertexInputBindingDescription{
+                .binding = 0,
+                .stride = sizeof(QuadVertex),
+                .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+            },
+            VkVertexInputBindingDescription{
+                .binding = 1,
+                .stride = sizeof(QuadInstanceData),
+                .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+            },
+        };
+
+        std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions = {
+
+            // Binding 0: Base quad vertex attributes.
+            VkVertexInputAttributeDescription{
+                .location = 0,
+                .binding = 0,
+                .format = get_vk_format("vec4"),
+                .offset = offsetof(QuadVertex, position),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 1,
+                .binding = 0,
+                .format = get_vk_format("vec2"),
+                .offset = offsetof(QuadVertex, texture_coordinate),
+            },
+
+            // Binding 1: Instance quad vertex attributes.
+            VkVertexInputAttributeDescription{
+                .location = 2,
+                .binding = 1,
+                .format = get_vk_format("vec4"),
+                .offset = offsetof(QuadInstanceData, transform),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 3,
+                .binding = 1,
+                .format = get_vk_format("vec3"), // Position (xy) and depth (z) are laid out next to each other.
+                .offset = offsetof(QuadInstanceData, position),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 4,
+                .binding = 1,
+                .format = VK_FORMAT_R8G8B8A8_UNORM, // Unpacked to vec4 in the shader.
+                .offset = offsetof(QuadInstanceData, color),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 5,
+                .binding = 1,
+                .format = VK_FORMAT_R16G16B16A16_UNORM, // Unpacked to vec4 in the shader.
+                .offset = offsetof(QuadInstanceData, texture_rectangle),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 6,
+                .binding = 1,
+                .format = get_vk_format("uint"),
+                .offset = offsetof(QuadInstanceData, texture_index),
+            },
+            VkVertexInputAttributeDescription{
+                .location = 7,
+                .binding = 1,
+                .format = get_vk_format("uint"),
+                .offset = offsetof(QuadInstanceData, layer),
+            },
+        };
+
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts = {
+            bindless_textures_enabled ? bindless_descriptor_set_layout : batch_descriptor_set_layout, // Set 0 (Bindless textures or per-batch)
+        };
+
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        push_constant_range.offset = 0;
+        push_constant_range.size = sizeof(ViewProjection);
+
+        std::vector<VkPushConstantRange> push_constant_ranges = {
+            push_constant_range,
+        };
+
+        // Opaque quads replace what's behind them and write depth, so that anything drawn behind them later is rejected
+        // by the depth test. Translucent quads are blended and only tested against the depth, so that they don't hide
+        // translucent quads that are drawn behind them afterwards. Static batches are blended, but also write depth
+        // where they are not fully transparent, so that the quads on lower layers that are drawn after them (f.ex.
+        // deferred quads) stay behind them.
+        //
+        // Opaque quads are compared with `LESS`, so a fragment is never shaded again over a fragment of the same layer
+        // and depth. The other pipelines use `LESS_OR_EQUAL`, so that they are still drawn over what's at their depth.
+        std::string pipeline_name;
+        if (opaque) {
+            pipeline_name = std::format("{} opaque quad graphics pipeline", config.name);
+        } else if (alpha_discard_enabled) {
+            pipeline_name = std::format("{} static batch graphics pipeline", config.name);
+        } else {
+            pipeline_name = std::format("{} quad graphics pipeline", config.name);
+        }
+        return VulkanGraphicsPipeline({
+            .name = pipeline_name,
+            .device = config.device,
+            .render_pass = config.swapchain.get_render_pass(),
+            .descriptor_set_layouts = descriptor_set_layouts,
+            .push_constant_ranges = push_constant_ranges,
+            .shader_stage_create_infos = shader_stage_create_infos,
+            .vertex_input_binding_descriptions = vertex_input_binding_descriptions,
+            .vertex_input_attribute_descriptions = vertex_input_attribute_descriptions,
+            .blend_enabled = !opaque,
+            .premultiplied_alpha = true,
+            .depth_write_enabled = opaque || alpha_discard_enabled,
+            .depth_compare_op = opaque ? VK_COMPARE_OP_LESS : VK_COMPARE_OP_LESS_OR_EQUAL,
+        });
+    }
+
+    VulkanGraphicsPipeline Renderer::create_tile_layer_graphics_pipeline() {
+        auto vertex_shader_path = ST_RES_DIR / std::filesystem::path("shaders/tile_layer.vert.spv");
+        // With descriptor indexing, the tileset texture is indexed per tile (non-uniformly) in a single draw. Without
+        // it, the layer is drawn once per tileset texture, which the push constants pass to the fragment shader.
+        auto fragment_shader_path = ST_RES_DIR / std::filesystem::path(config.device.is_descriptor_indexing_enabled() ? "shaders/tile_layer_nonuniform.frag.spv" : "shaders/tile_layer.frag.spv");
+
+        std::string vertex_shader_name = std::format("{} tile layer vertex shader [{}]", config.name.c_str(), vertex_shader_path.c_str());
+        std::string fragment_shader_name = std::format("{} tile layer fragment shader [{}]", config.name.c_str(), fragment_shader_path.c_str());
+
+        VkShaderModule vertex_shader = create_shader_module(vertex_shader_path, vertex_shader_name);
+        VkShaderModule fragment_shader = create_shader_module(fragment_shader_path, fragment_shader_name);
+
+        ST_DEFER([&] {
+            destroy_shader_module(vertex_shader);
+            destroy_shader_module(fragment_shader);
+        });
+
+        VkPipelineShaderStageCreateInfo vertex_shader_stage_create_info{};
+        vertex_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        vertex_shader_stage_create_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+        vertex_shader_stage_create_info.module = vertex_shader;
+        vertex_shader_stage_create_info.pName = "main";
+
+        VkPipelineShaderStageCreateInfo fragment_shader_stage_create_info{};
+        fragment_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        fragment_shader_stage_create_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        fragment_shader_stage_create_info.module = fragment_shader;
+        fragment_shader_stage_create_info.pName = "main";
+
+        std::vector<VkPipelineShaderStageCreateInfo> shader_stage_create_infos = {
+            vertex_shader_stage_create_info,
+            fragment_shader_stage_create_info,
+        };
+
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts = {
+            tile_layer_descriptor_set_layout, // Set 0 (Per-layer)
+        };
+
+        VkPushConstantRange push_constant_range{};
+        push_constant_range.stageFlags = tile_layer_push_constant_stages;
+        push_constant_range.offset = 0;
+        push_constant_range.size = sizeof(TileLayerPushConstants);
+
+        std::vector<VkPushConstantRange> push_constant_ranges = {
+            push_constant_range,
+        };
+
+        // No vertex input, the tile vertices are generated in the vertex shader. Tiles may have transparent texels, so
+        // they are blended like translucent quads. They also write depth where they are not fully transparent (the
+        // fragment shader discards the rest), so that the quads on lower layers that are drawn after them (f.ex.
+        // deferred quads) stay behind them.
+        return VulkanGraphicsPipeline({
+            .name = std::format("{} tile layer graphics pipeline", config.name),
+            .device = config.device,
+            .render_pass = config.swapchain.get_render_pass(),
+            .descriptor_set_layouts = descriptor_set_layouts,
+            .push_constant_ranges = push_constant_ranges,
+            .shader_stage_create_infos = shader_stage_create_infos,
+            .premultiplied_alpha = true,
+            .depth_write_enabled = true,
+            .depth_compare_op = VK_COMPARE_OP_LESS_OR_EQUAL,
+        });
+    }
+
+    Unique<VulkanRenderTarget> Renderer::create_render_target() const {
+        if (config.internal_width == 0) {
+            return nullptr;
+        }
+        ST_LOG_I("Rendering at internal resolution [{}x{}]", config.internal_width, config.internal_height);
+        return std::make_unique<VulkanRenderTarget>(VulkanRenderTargetConfig{
+            .name = std::format("{} render target", config.name),
+            .device = config.device,
+            .width = config.internal_width,
+            .height = config.internal_height,
+            .color_format = config.swapchain.get_color_format(),
+            .depth_format = config.swapchain.get_depth_format(),
+            .clear_color = config.swapchain.get_clear_color(),
+        });
+    }
+
+    VkDescriptorSetLayout Renderer::create_upscale_descriptor_set_layout() const {
+        if (render_target == nullptr) {
+            return nullptr;
+        }
+
+        std::string descriptor_set_layout_name = std::format("{} upscale descriptor set layout", config.name);
+
+        std::vector<VkDescriptorSetLayoutBinding> descriptor_set_layout_bindings(1);
+
+        // Binding 0: Render target
+        descriptor_set_layout_bindings[0].binding = 0;
+        descriptor_set_layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_set_layout_bindings[0].descriptorCount = 1;
+        descriptor_set_layout_bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        descriptor_set_layout_bindings[0].pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info{};
+        descriptor_set_layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptor_set_layout_create_info.bindingCount = descriptor_set_layout_bindings.size();
+        descriptor_set_layout_create_info.pBindings = descriptor_set_layout_bindings.data();
+
+        VkDescriptorSetLayout descriptor_set_layout;
 
-        return vertex_buffer;
-    }
+        ST_ASSERT_THROW_VK(
+            config.device.create_descriptor_set_layout(descriptor_set_layout_create_info, &descriptor_set_layout),
+            "Could not create upscale descriptor set layout [" << descriptor_set_layout_name << "]"
+        );
 
-    VulkanIndexBuffer Renderer::create_base_quad_index_buffer() {
-        auto index_buffer = VulkanIndexBuffer({
-            .name = std::format("{} base quad index buffer", config.name),
-            .device = &config.device,
-            .index_type = index_type,
-            .size = sizeof(Index) * base_quad_indices.size(),
-            .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            .memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-        });
+        return descriptor_set_layout;
+    }
 
-        init_command_pool.record_and_submit_commands([&](const VulkanCommandBuffer& command_buffer) {
-            index_buffer.set_data(command_buffer, base_quad_indices.data());
-        });
+    void Renderer::destroy_upscale_descriptor_set_layout() const {
+        if (upscale_descriptor_set_layout != nullptr) {
+            config.device.destroy_descriptor_set_layout(upscale_descriptor_set_layout);
+        }
+    }
 
-        return index_buffer;
+    VkDescriptorSet Renderer::allocate_upscale_descriptor_set() {
+        if (render_target == nullptr) {
+            return nullptr;
+        }
+        return allocate_descriptor_set(upscale_descriptor_set_layout, std::format("{} upscale descriptor set", config.name));
     }
 
-    VulkanGraphicsPipeline Renderer::create_quad_graphics_pipeline() {
-        auto vertex_shader_path = ST_RES_DIR / std::filesystem::path("shaders/quad.vert.spv");
-        auto fragment_shader_path = ST_RES_DIR / std::filesystem::path("shaders/quad.frag.spv");
+    Unique<VulkanGraphicsPipeline> Renderer::create_upscale_graphics_pipeline() {
+        if (render_target == nullptr) {
+            return nullptr;
+        }
 
-        std::string vertex_shader_name = std::format("{} quad vertex shader [{}]", config.name.c_str(), vertex_shader_path.c_str());
-        std::string fragment_shader_name = std::format("{} quad fragment shader [{}]", config.name.c_str(), fragment_shader_path.c_str());
+        auto vertex_shader_path = ST_RES_DIR / std::filesystem::path("shaders/upscale.vert.spv");
+        auto fragment_shader_path = ST_RES_DIR / std::filesystem::path("shaders/upscale.frag.spv");
+
+        std::string vertex_shader_name = std::format("{} upscale vertex shader [{}]", config.name.c_str(), vertex_shader_path.c_str());
+        std::string fragment_shader_name = std::format("{} upscale fragment shader [{}]", config.name.c_str(), fragment_shader_path.c_str());
 
         VkShaderModule vertex_shader = create_shader_module(vertex_shader_path, vertex_shader_name);
         VkShaderModule fragment_shader = create_shader_module(fragment_shader_path, fragment_shader_name);
@@ -427,102 +2156,21 @@ namespace Storytime {
             fragment_shader_stage_create_info,
         };
 
-        std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions = {
-            VkVertexInputBindingDescription{
-                .binding = 0,
-                .stride = sizeof(QuadVertex),
-                .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-            },
-            VkVertexInputBindingDescription{
-                .binding = 1,
-                .stride = sizeof(QuadInstanceData),
-                .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
-            },
-        };
-
-        std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions = {
-
-            // Binding 0: Base quad vertex attributes.
-            VkVertexInputAttributeDescription{
-                .location = 0,
-                .binding = 0,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadVertex, position),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 1,
-                .binding = 0,
-                .format = get_vk_format("vec2"),
-                .offset = offsetof(QuadVertex, texture_coordinate),
-            },
-
-            // Binding 1: Instance quad vertex attributes.
-            VkVertexInputAttributeDescription{
-                .location = 2,
-                .binding = 1,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadInstanceData, model) + 0 * sizeof(glm::vec4),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 3,
-                .binding = 1,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadInstanceData, model) + 1 * sizeof(glm::vec4),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 4,
-                .binding = 1,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadInstanceData, model) + 2 * sizeof(glm::vec4),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 5,
-                .binding = 1,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadInstanceData, model) + 3 * sizeof(glm::vec4),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 6,
-                .binding = 1,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadInstanceData, color) + 0 * sizeof(glm::vec4),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 7,
-                .binding = 1,
-                .format = get_vk_format("vec4"),
-                .offset = offsetof(QuadInstanceData, texture_rectangle) + 0 * sizeof(glm::vec4),
-            },
-            VkVertexInputAttributeDescription{
-                .location = 8,
-                .binding = 1,
-                .format = get_vk_format("float"),
-                .offset = offsetof(QuadInstanceData, texture_index) + 0 * sizeof(f32),
-            },
-        };
-
         std::vector<VkDescriptorSetLayout> descriptor_set_layouts = {
-            batch_descriptor_set_layout, // Set 0 (Per-batch)
-        };
-
-        VkPushConstantRange push_constant_range{};
-        push_constant_range.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-        push_constant_range.offset = 0;
-        push_constant_range.size = sizeof(ViewProjection);
-
-        std::vector<VkPushConstantRange> push_constant_ranges = {
-            push_constant_range,
+            upscale_descriptor_set_layout, // Set 0 (render target)
         };
 
-        return VulkanGraphicsPipeline({
-            .name = std::format("{} quad graphics pipeline", config.name),
+        // No vertex input, the fullscreen triangle is generated in the vertex shader. The render target replaces
+        // whatever is in the swapchain image, so there is nothing to blend with or to depth test against.
+        return std::make_unique<VulkanGraphicsPipeline>(VulkanGraphicsPipelineConfig{
+            .name = std::format("{} upscale graphics pipeline", config.name),
             .device = config.device,
             .render_pass = config.swapchain.get_render_pass(),
             .descriptor_set_layouts = descriptor_set_layouts,
-            .push_constant_ranges = push_constant_ranges,
             .shader_stage_create_infos = shader_stage_create_infos,
-            .vertex_input_binding_descriptions = vertex_input_binding_descriptions,
-            .vertex_input_attribute_descriptions = vertex_input_attribute_descriptions,
+            .blend_enabled = false,
+            .depth_test_enabled = false,
+            .depth_write_enabled = false,
         });
     }
 
@@ -547,20 +2195,56 @@ namespace Storytime {
         return shader_module;
     }
 
-    VulkanDescriptorPool Renderer::create_batch_descriptor_pool() {
-        std::vector<VkDescriptorPoolSize> batch_descriptor_pool_sizes(1);
+    Unique<VulkanDescriptorPool> Renderer::create_descriptor_pool() const {
+        std::vector<VkDescriptorPoolSize> descriptor_pool_sizes(2);
 
-        batch_descriptor_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-        batch_descriptor_pool_sizes[0].descriptorCount = config.frame_count * max_batches_per_frame * max_textures_per_batch;
+        // Batch and tile layer texture samplers.
+        descriptor_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_pool_sizes[0].descriptorCount = descriptor_sets_per_pool * max_textures_per_batch;
 
-        return VulkanDescriptorPool({
-            .name = std::format("{} batch descriptor pool", config.name),
+        // Tile layer tile IDs and tile data.
+        descriptor_pool_sizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_pool_sizes[1].descriptorCount = descriptor_sets_per_pool * 2;
+
+        return std::make_unique<VulkanDescriptorPool>(VulkanDescriptorPoolConfig{
+            .name = std::format("{} descriptor pool {}", config.name, descriptor_pools.size() + 1),
             .device = config.device,
-            .max_descriptor_sets = config.frame_count * max_batches_per_frame,
-            .descriptor_pool_sizes = batch_descriptor_pool_sizes,
+            .max_descriptor_sets = descriptor_sets_per_pool,
+            .descriptor_pool_sizes = descriptor_pool_sizes,
         });
     }
 
+    VkDescriptorSet Renderer::allocate_batch_descriptor_set(std::string_view name) {
+        // Reuse descriptor sets that have been released by destroyed static batches.
+        if (!free_batch_descriptor_sets.empty()) {
+            VkDescriptorSet descriptor_set = free_batch_descriptor_sets.back();
+            free_batch_descriptor_sets.pop_back();
+            return descriptor_set;
+        }
+        return allocate_descriptor_set(batch_descriptor_set_layout, name);
+    }
+
+    VkDescriptorSet Renderer::allocate_tile_layer_descriptor_set(std::string_view name) {
+        // Reuse descriptor sets that have been released by destroyed tile layers.
+        if (!free_tile_layer_descriptor_sets.empty()) {
+            VkDescriptorSet descriptor_set = free_tile_layer_descriptor_sets.back();
+            free_tile_layer_descriptor_sets.pop_back();
+            return descriptor_set;
+        }
+        return allocate_descriptor_set(tile_layer_descriptor_set_layout, name);
+    }
+
+    VkDescriptorSet Renderer::allocate_descriptor_set(VkDescriptorSetLayout descriptor_set_layout, std::string_view name) {
+        // Descriptor pools have a fixed size, so a new pool is created whenever the current one runs out of sets.
+        // Pools are never reset or freed until the renderer is destroyed, just like the batches that use the sets.
+        if (descriptor_pools.empty() || descriptor_pool_available_sets == 0) {
+            descriptor_pools.push_back(create_descriptor_pool());
+            descriptor_pool_available_sets = descriptor_sets_per_pool;
+        }
+        descriptor_pool_available_sets--;
+        return descriptor_pools.back()->allocate_descriptor_set(descriptor_set_layout, name);
+    }
+
     VkDescriptorSetLayout Renderer::create_batch_descriptor_set_layout() const {
         const VulkanPhysicalDevice& physical_device = config.device.get_physical_device();
         const VkPhysicalDeviceLimits& physical_device_limits = physical_device.get_properties().limits;
@@ -600,6 +2284,241 @@ namespace Storytime {
         config.device.destroy_descriptor_set_layout(batch_descriptor_set_layout);
     }
 
+    VkDescriptorSetLayout Renderer::create_tile_layer_descriptor_set_layout() const {
+        std::string descriptor_set_layout_name = std::format("{} tile layer descriptor set layout", config.name);
+
+        std::vector<VkDescriptorSetLayoutBinding> descriptor_set_layout_bindings(3);
+
+        // Binding 0: Tile IDs
+        descriptor_set_layout_bindings[0].binding = 0;
+        descriptor_set_layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_set_layout_bindings[0].descriptorCount = 1;
+        descriptor_set_layout_bindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        descriptor_set_layout_bindings[0].pImmutableSamplers = nullptr;
+
+        // Binding 1: Tile data lookup table
+        descriptor_set_layout_bindings[1].binding = 1;
+        descriptor_set_layout_bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptor_set_layout_bindings[1].descriptorCount = 1;
+        descriptor_set_layout_bindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        descriptor_set_layout_bindings[1].pImmutableSamplers = nullptr;
+
+        // Binding 2: Tileset textures
+        descriptor_set_layout_bindings[2].binding = 2;
+        descriptor_set_layout_bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_set_layout_bindings[2].descriptorCount = max_textures_per_batch;
+        descriptor_set_layout_bindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        descriptor_set_layout_bindings[2].pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info{};
+        descriptor_set_layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptor_set_layout_create_info.bindingCount = descriptor_set_layout_bindings.size();
+        descriptor_set_layout_create_info.pBindings = descriptor_set_layout_bindings.data();
+
+        VkDescriptorSetLayout descriptor_set_layout;
+
+        ST_ASSERT_THROW_VK(
+            config.device.create_descriptor_set_layout(descriptor_set_layout_create_info, &descriptor_set_layout),
+            "Could not create tile layer descriptor set layout [" << descriptor_set_layout_name << "]"
+        );
+
+        return descriptor_set_layout;
+    }
+
+    void Renderer::destroy_tile_layer_descriptor_set_layout() const {
+        config.device.destroy_descriptor_set_layout(tile_layer_descriptor_set_layout);
+    }
+
+    u32 Renderer::get_bindless_texture_capacity() const {
+        if (!bindless_textures_enabled) {
+            return 0;
+        }
+
+        // Descriptors in an "update after bind" set count towards a separate set of limits, and a combined image
+        // sampler counts towards both the sampler and the sampled image limits.
+        const VulkanPhysicalDevice& physical_device = config.device.get_physical_device();
+        const VkPhysicalDeviceVulkan12Properties physical_device_properties = physical_device.get_vulkan_12_properties();
+
+        return std::min({
+            max_bindless_textures,
+            physical_device_properties.maxPerStageDescriptorUpdateAfterBindSamplers,
+            physical_device_properties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+            physical_device_properties.maxPerStageUpdateAfterBindResources,
+            physical_device_properties.maxDescriptorSetUpdateAfterBindSamplers,
+            physical_device_properties.maxDescriptorSetUpdateAfterBindSampledImages,
+        });
+    }
+
+    bool Renderer::is_indirect_draws_supported() const {
+        if (!config.indirect_draws_enabled || !bindless_textures_enabled) {
+            return false;
+        }
+
+        // All features that are supported by the physical device are enabled on the device. Drawing several batches
+        // with one indirect draw needs a draw count above 1, and a first instance (the batch's range of the instance
+        // buffer) in the indirect commands.
+        VkPhysicalDeviceFeatures features = config.device.get_physical_device().get_features();
+        if (!features.multiDrawIndirect || !features.drawIndirectFirstInstance) {
+            ST_LOG_W("Indirect draws were requested for [{}] but multi-draw indirect is not supported by the physical device", config.name);
+            return false;
+        }
+        return true;
+    }
+
+    u32 Renderer::get_timestamp_valid_bits() const {
+        const VulkanPhysicalDevice& physical_device = config.device.get_physical_device();
+        std::vector<VkQueueFamilyProperties> queue_family_properties = physical_device.get_queue_family_properties();
+        return queue_family_properties.at(physical_device.get_graphics_queue_family_index()).timestampValidBits;
+    }
+
+    bool Renderer::is_gpu_timestamps_supported() const {
+        if (!config.gpu_timestamps_enabled) {
+            return false;
+        }
+        // Queues of families without any valid timestamp bits can't write timestamps.
+        if (timestamp_valid_bits == 0) {
+            ST_LOG_W("GPU timestamps were requested for [{}] but they are not supported by the graphics queue", config.name);
+            return false;
+        }
+        return true;
+    }
+
+    void Renderer::write_timestamp(const Frame& frame, u32 query) const {
+        ST_ASSERT(query < timestamp_query_capacity, "Timestamp query [" << query << "] must be less than the capacity [" << timestamp_query_capacity << "]");
+
+        // Ranges begin at even queries and end at odd queries. A timestamp that begins a range is written as soon as
+        // all previous commands have started, and one that ends a range once they have all finished. Ranges of
+        // consecutive commands may overlap, since the GPU doesn't wait for a command to finish to start the next.
+        VkPipelineStageFlagBits pipeline_stage = query % 2 == 0 ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        frame.command_buffer.write_timestamp(pipeline_stage, frame.timestamp_query_pool, query);
+    }
+
+    void Renderer::read_timestamps(Frame& frame) const {
+        u32 query_count = frame.timestamp_query_count;
+
+        // Every result is followed by its availability, since queries that were not written in the last submission of
+        // the frame (f.ex. ImGui when it's not rendered) have no result.
+        constexpr u32 values_per_query = 2;
+        frame.timestamp_results.resize(query_count * values_per_query);
+
+        VkResult result = config.device.get_query_pool_results(
+            frame.timestamp_query_pool,
+            0,
+            query_count,
+            frame.timestamp_results.size() * sizeof(u64),
+            frame.timestamp_results.data(),
+            values_per_query * sizeof(u64),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT
+        );
+        if (result != VK_SUCCESS && result != VK_NOT_READY) {
+            return;
+        }
+
+        // Only the valid bits of timestamps are counted, so ranges can be measured across a wrap-around.
+        u64 timestamp_mask = timestamp_valid_bits >= 64 ? std::numeric_limits<u64>::max() : (1ull << timestamp_valid_bits) - 1;
+
+        auto get_duration_ms = [&](u32 begin_query) {
+            const u64* begin = &frame.timestamp_results.at(begin_query * values_per_query);
+            const u64* end = &frame.timestamp_results.at((begin_query + 1) * values_per_query);
+            if (begin[1] == 0 || end[1] == 0) {
+                return 0.0;
+            }
+            u64 ticks = (end[0] - begin[0]) & timestamp_mask;
+            return (f64) ticks * timestamp_period_ns / 1'000'000.0;
+        };
+
+        config.metrics.gpu_frame_duration_ms = get_duration_ms((u32) GpuTimestamp::FRAME_BEGIN);
+        config.metrics.gpu_scene_render_duration_ms = get_duration_ms((u32) GpuTimestamp::SCENE_BEGIN);
+        config.metrics.gpu_imgui_render_duration_ms = get_duration_ms((u32) GpuTimestamp::IMGUI_BEGIN);
+
+        config.metrics.gpu_draw_duration_ms = 0.0;
+        config.metrics.gpu_draw_durations_ms.clear();
+        for (u32 query = (u32) GpuTimestamp::COUNT; query + 1 < query_count; query += 2) {
+            f64 draw_duration_ms = get_duration_ms(query);
+            config.metrics.gpu_draw_duration_ms += draw_duration_ms;
+            config.metrics.gpu_draw_durations_ms.push_back(draw_duration_ms);
+        }
+    }
+
+    Unique<VulkanDescriptorPool> Renderer::create_bindless_descriptor_pool() const {
+        if (!bindless_textures_enabled) {
+            return nullptr;
+        }
+
+        std::vector<VkDescriptorPoolSize> bindless_descriptor_pool_sizes(1);
+
+        bindless_descriptor_pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindless_descriptor_pool_sizes[0].descriptorCount = bindless_texture_capacity;
+
+        return std::make_unique<VulkanDescriptorPool>(VulkanDescriptorPoolConfig{
+            .name = std::format("{} bindless descriptor pool", config.name),
+            .device = config.device,
+            .max_descriptor_sets = 1,
+            .descriptor_pool_sizes = bindless_descriptor_pool_sizes,
+            .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        });
+    }
+
+    VkDescriptorSetLayout Renderer::create_bindless_descriptor_set_layout() const {
+        if (!bindless_textures_enabled) {
+            return nullptr;
+        }
+
+        std::string descriptor_set_layout_name = std::format("{} bindless descriptor set layout", config.name);
+
+        std::vector<VkDescriptorSetLayoutBinding> descriptor_set_layout_bindings(1);
+
+        descriptor_set_layout_bindings[0].binding = 0;
+        descriptor_set_layout_bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptor_set_layout_bindings[0].descriptorCount = bindless_texture_capacity;
+        descriptor_set_layout_bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+        descriptor_set_layout_bindings[0].pImmutableSamplers = nullptr;
+
+        // - Partially bound: Not every element in the array needs a valid descriptor, only the ones that are accessed.
+        // - Update after bind: Textures can be registered while the descriptor set is bound.
+        // - Update unused while pending: Textures can be registered while the GPU executes commands using the set.
+        std::vector<VkDescriptorBindingFlags> descriptor_binding_flags = {
+            VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT
+            | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+        };
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo descriptor_set_layout_binding_flags_create_info{};
+        descriptor_set_layout_binding_flags_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        descriptor_set_layout_binding_flags_create_info.bindingCount = descriptor_binding_flags.size();
+        descriptor_set_layout_binding_flags_create_info.pBindingFlags = descriptor_binding_flags.data();
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info{};
+        descriptor_set_layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptor_set_layout_create_info.pNext = &descriptor_set_layout_binding_flags_create_info;
+        descriptor_set_layout_create_info.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        descriptor_set_layout_create_info.bindingCount = descriptor_set_layout_bindings.size();
+        descriptor_set_layout_create_info.pBindings = descriptor_set_layout_bindings.data();
+
+        VkDescriptorSetLayout descriptor_set_layout;
+
+        ST_ASSERT_THROW_VK(
+            config.device.create_descriptor_set_layout(descriptor_set_layout_create_info, &descriptor_set_layout, descriptor_set_layout_name),
+            "Could not create bindless descriptor set layout [" << descriptor_set_layout_name << "]"
+        );
+
+        return descriptor_set_layout;
+    }
+
+    void Renderer::destroy_bindless_descriptor_set_layout() const {
+        if (bindless_descriptor_set_layout != nullptr) {
+            config.device.destroy_descriptor_set_layout(bindless_descriptor_set_layout);
+        }
+    }
+
+    VkDescriptorSet Renderer::allocate_bindless_descriptor_set() const {
+        if (!bindless_textures_enabled) {
+            return nullptr;
+        }
+        std::string descriptor_set_name = std::format("{} bindless descriptor set", config.name);
+        return bindless_descriptor_pool->allocate_descriptor_set(bindless_descriptor_set_layout, descriptor_set_name);
+    }
+
     void Renderer::destroy_shader_module(VkShaderModule shader_module) const {
         config.device.destroy_shader_module(shader_module);
     }
@@ -719,35 +2638,111 @@ namespace Storytime {
                 "Could not create semaphore [" << render_finished_semaphore_name << "]"
             );
 
+            //
+            // Timestamps
+            //
+
+            if (gpu_timestamps_enabled) {
+                VkQueryPoolCreateInfo query_pool_create_info{};
+                query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+                query_pool_create_info.queryType = VK_QUERY_TYPE_TIMESTAMP;
+                query_pool_create_info.queryCount = timestamp_query_capacity;
+
+                std::string query_pool_name = std::format("{} frame timestamp query pool {}/{}", config.name.c_str(), i + 1, frame_count);
+                ST_ASSERT_THROW_VK(
+                    config.device.create_query_pool(query_pool_create_info, &frame.timestamp_query_pool, query_pool_name),
+                    "Could not create query pool [" << query_pool_name << "]"
+                );
+            }
+
             //
             // Batches
             //
 
-            u32 batch_count = max_batches_per_frame;
-            frame.batches.resize(batch_count);
+            create_batch_buffers(frame, i + 1, initial_batches_per_frame);
+
+            frame.batches.reserve(initial_batches_per_frame);
+            for (u32 j = 0; j < initial_batches_per_frame; j++) {
+                frame.batches.push_back(create_batch(frame, i + 1, j));
+            }
+        }
 
-            for (u32 j = 0; j < frame.batches.size(); j++) {
-                Batch& batch = frame.batches.at(j);
-                batch.quads.resize(max_quads_per_batch);
-                batch.textures.resize(max_textures_per_batch);
+        return frames;
+    }
 
-                for (u32 k = 0; k < batch.textures.size(); k++) {
-                    batch.textures.at(k) = placeholder_texture;
-                }
+    void Renderer::create_batch_buffers(Frame& frame, u32 frame_number, u32 batch_capacity) {
+        // The batches that have already been flushed must be drawn from the buffers they were written to.
+        draw_pending_batches(frame);
+        if (frame.batch_capacity > 0) {
+            frame.retired_instance_buffers.push_back(std::move(frame.instance_buffer));
+            frame.retired_indirect_buffers.push_back(std::move(frame.indirect_buffer));
+        }
 
-                batch.vertex_buffer = VulkanVertexBuffer({
-                    .name = std::format("{} batch vertex buffer {}/{} (frame {}/{})", config.name, j + 1, batch_count, i + 1, frame_count),
-                    .device = &config.device,
-                    .size = sizeof(QuadInstanceData) * max_quads_per_batch,
-                    .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                });
+        frame.instance_buffer = VulkanVertexBuffer({
+            .name = std::format("{} instance buffer (frame {}/{})", config.name, frame_number, config.frame_count),
+            .device = &config.device,
+            .size = sizeof(QuadInstanceData) * max_quads_per_batch * batch_capacity,
+            .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        });
 
-                std::string batch_descriptor_set_name = std::format("{} batch descriptor set {}/{} (frame {}/{})", config.name.c_str(), j + 1, batch_count, i + 1, frame_count);
-                batch.descriptor_set = batch_descriptor_pool.allocate_descriptor_set(batch_descriptor_set_layout, batch_descriptor_set_name);
+        frame.indirect_buffer = VulkanBuffer({
+            .device = &config.device,
+            .name = std::format("{} indirect buffer (frame {}/{})", config.name, frame_number, config.frame_count),
+            .size = sizeof(VkDrawIndexedIndirectCommand) * batch_capacity,
+            .usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+            .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        });
+        frame.indirect_buffer.map_memory();
+        frame.indirect_commands = (VkDrawIndexedIndirectCommand*) frame.indirect_buffer.get_data();
+        frame.batch_capacity = batch_capacity;
+
+        // Batches that write straight into the instance buffer move along with it.
+        if (config.direct_instance_writes_enabled) {
+            auto* quads = (QuadInstanceData*) frame.instance_buffer.get_data();
+            for (Batch& batch : frame.batches) {
+                batch.quads = quads + batch.first_quad;
             }
         }
 
-        return frames;
+        ST_LOG_D("Allocated instance buffer for [{}] batches for frame [{}/{}]", batch_capacity, frame_number, config.frame_count);
+    }
+
+    Batch Renderer::create_batch(Frame& frame, u32 frame_number, u32 batch_index) {
+        ST_ASSERT(batch_index < frame.batch_capacity, "Batch index [" << batch_index << "] must be less than the batch capacity [" << frame.batch_capacity << "] of the frame");
+        u32 batch_number = batch_index + 1;
+
+        Batch batch{};
+        batch.first_quad = batch_index * max_quads_per_batch;
+
+        batch.textures.resize(max_textures_per_batch);
+        batch.texture_slots.reserve(max_textures_per_batch);
+
+        // No texture has ID 0, so the descriptor set is always written the first time the batch is flushed.
+        batch.descriptor_texture_ids.resize(max_textures_per_batch, 0);
+
+        for (u32 i = 0; i < batch.textures.size(); i++) {
+            batch.textures.at(i) = placeholder_texture.get();
+        }
+
+        // The instance buffer of the frame is host coherent and stays mapped for the lifetime of the frame, so quads
+        // can be written straight into the batch's range of it. The frame's in-flight fence guarantees that the GPU is
+        // done reading the previous contents before the batch is written to again.
+        if (config.direct_instance_writes_enabled) {
+            batch.quads = (QuadInstanceData*) frame.instance_buffer.get_data() + batch.first_quad;
+        } else {
+            batch.staged_quads.resize(max_quads_per_batch);
+            batch.quads = batch.staged_quads.data();
+        }
+
+        // Batches sample from the bindless texture array when it's enabled, and need no descriptor set of their own.
+        if (!bindless_textures_enabled) {
+            std::string batch_descriptor_set_name = std::format("{} batch descriptor set {} (frame {}/{})", config.name, batch_number, frame_number, config.frame_count);
+            batch.descriptor_set = allocate_batch_descriptor_set(batch_descriptor_set_name);
+        }
+
+        config.metrics.batch_count++;
+
+        return batch;
     }
 
     void Renderer::destroy_frames() {
@@ -755,6 +2750,9 @@ namespace Storytime {
             config.device.destroy_fence(frame.in_flight_fence);
             config.device.destroy_semaphore(frame.image_available_semaphore);
             config.device.destroy_semaphore(frame.render_finished_semaphore);
+            if (frame.timestamp_query_pool != nullptr) {
+                config.device.destroy_query_pool(frame.timestamp_query_pool);
+            }
         }
         frames.clear();
     }
@@ -2,6 +2,9 @@
 
 #include "graphics/st_quad.h"
 #include "graphics/st_quad_vertex.h"
+#include "graphics/st_render_context.h"
+#include "graphics/st_static_batch.h"
+#include "graphics/st_tile_layer.h"
 #include "graphics/st_view_projection.h"
 #include "graphics/st_vulkan_command_pool.h"
 #include "graphics/st_vulkan_context.h"
@@ -11,11 +14,14 @@
 #include "graphics/st_vulkan_graphics_pipeline.h"
 #include "graphics/st_vulkan_image.h"
 #include "graphics/st_vulkan_index_buffer.h"
+#include "graphics/st_vulkan_render_target.h"
+#include "graphics/st_vulkan_staging_ring.h"
 #include "graphics/st_vulkan_swapchain.h"
 #include "graphics/st_vulkan_vertex_buffer.h"
 #include "system/st_dispatcher.h"
 #include "system/st_file_reader.h"
 #include "system/st_metrics.h"
+#include "tiled/st_tiled_map.h"
 #include "window/st_window.h"
 
 namespace Storytime {
@@ -29,17 +35,62 @@ namespace Storytime {
         VulkanDevice& device;
         VulkanSwapchain& swapchain;
         u32 frame_count = 0;
+        bool direct_instance_writes_enabled = true;
+        bool deferred_rendering_enabled = false;
+        bool quad_culling_enabled = false;
+
+        /// Whether consecutive batches are drawn together with a single indirect draw. Only takes effect with bindless
+        /// textures, since batches otherwise bind their own textures, and when the device supports multi-draw indirect.
+        bool indirect_draws_enabled = true;
+
+        /// The internal resolution that the scene is rendered at. When set, the scene is rendered to an offscreen
+        /// target of this size, which is upscaled to the swapchain in `end_render`. Zero renders directly to the
+        /// swapchain at window resolution.
+        u32 internal_width = 0;
+        u32 internal_height = 0;
+
+        /// Whether the internal resolution is upscaled by the largest whole multiple that fits the window, so that
+        /// every pixel becomes a square of the same size. Otherwise it is stretched to fit the window, keeping its
+        /// aspect ratio. Either way, any remaining space is letterboxed with the clear color.
+        bool integer_scaling_enabled = true;
+
+        /// Whether the GPU durations of the frame, the scene and ImGui are measured with timestamp queries. Only takes
+        /// effect when the graphics queue supports timestamps.
+        bool gpu_timestamps_enabled = true;
+
+        /// Whether every draw of quad batches is also timed, for a per-draw breakdown of the scene.
+        bool gpu_draw_timestamps_enabled = false;
 
         const RendererConfig& assert_valid() const {
             ST_ASSERT_GREATER_THAN_ZERO(frame_count);
+            ST_ASSERT((internal_width == 0) == (internal_height == 0), "Internal width [" << internal_width << "] and height [" << internal_height << "] must either both be set or both be zero");
             return *this;
         }
     };
 
+    /// Instance memory that has been reserved with `Renderer::reserve_quads`, to be written to directly.
+    struct QuadReservation {
+        QuadInstanceData* quads = nullptr;
+
+        /// The number of quads that may be written, which can be less than the number that was asked for when the
+        /// current batch is almost full.
+        u32 capacity = 0;
+
+        /// The texture index that must be written to every quad.
+        u32 texture_index = 0;
+
+        /// The layer that must be written to every quad.
+        u32 layer = 0;
+    };
+
     class Renderer {
     public:
         typedef RendererConfig Config;
 
+        // Batching
+        static constexpr u32 max_textures_per_batch = 16;
+        static constexpr u32 max_quads_per_batch = 20'000;
+
     private:
         // Vertices
         static constexpr u32 max_vertices_per_quad = 4;
@@ -75,24 +126,72 @@ namespace Storytime {
         };
 
         // Batching
-        static constexpr u32 max_batches_per_frame = 8;
-        static constexpr u32 max_textures_per_batch = 16;
-        static constexpr u32 max_quads_per_batch = 20'000;
+        static constexpr u32 initial_batches_per_frame = 8; // More batches are allocated on demand.
         static constexpr u32 max_vertices_per_batch = max_quads_per_batch * max_vertices_per_quad;
 
+        // Descriptors
+        static constexpr u32 descriptor_sets_per_pool = 32; // Batches, static batch segments and tile layers.
+
+        // Tile layers
+        static constexpr u32 tile_layer_vertex_count = 6; // Two triangles generated in the vertex shader.
+        static constexpr VkShaderStageFlags tile_layer_push_constant_stages = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+
+        // Deferred rendering
+        static constexpr u32 max_view_projections_per_frame = 256; // The view index has 8 bits in the quad sort key.
+        static constexpr u32 quad_sort_key_view_shift = 56;
+        static constexpr u32 quad_sort_key_pass_shift = 55;
+        static constexpr u32 quad_sort_key_layer_shift = 39;
+        static constexpr u32 quad_sort_key_texture_shift = 16;
+
+        // Bindless textures
+        static constexpr u32 max_bindless_textures = 4096;
+
+        // Upscaling
+        static constexpr u32 upscale_vertex_count = 3; // A fullscreen triangle generated in the vertex shader.
+
+        // GPU timestamps
+        static constexpr u32 max_timed_draws_per_frame = 256; // Draws after this are not timed.
+        static constexpr u32 timestamp_query_capacity = (u32) GpuTimestamp::COUNT + max_timed_draws_per_frame * 2;
+
     private:
         Config config;
         VulkanCommandPool init_command_pool;
         VulkanCommandPool frame_command_pool;
-        VulkanDescriptorPool batch_descriptor_pool;
+        std::vector<Unique<VulkanDescriptorPool>> descriptor_pools{};
+        u32 descriptor_pool_available_sets = 0;
+        std::vector<VkDescriptorSet> free_batch_descriptor_sets{};
+        std::vector<VkDescriptorSet> free_tile_layer_descriptor_sets{};
         VkDescriptorSetLayout batch_descriptor_set_layout;
+        VkDescriptorSetLayout tile_layer_descriptor_set_layout;
+        bool bindless_textures_enabled = false;
+        u32 bindless_texture_capacity = 0;
+        bool indirect_draws_enabled = false;
+        u32 timestamp_valid_bits = 0;
+        f64 timestamp_period_ns = 0.0;
+        bool gpu_timestamps_enabled = false;
+        bool gpu_draw_timestamps_enabled = false;
+        Unique<VulkanDescriptorPool> bindless_descriptor_pool = nullptr;
+        VkDescriptorSetLayout bindless_descriptor_set_layout = nullptr;
+        VulkanDescriptorSet bindless_descriptor_set = nullptr;
+        std::vector<Weak<VulkanImage>> bindless_textures{};
         VulkanGraphicsPipeline quad_graphics_pipeline;
+        VulkanGraphicsPipeline opaque_quad_graphics_pipeline;
+        VulkanGraphicsPipeline static_batch_graphics_pipeline;
+        VulkanGraphicsPipeline tile_layer_graphics_pipeline;
         VulkanVertexBuffer base_quad_vertex_buffer;
         VulkanIndexBuffer base_quad_index_buffer;
         VkSampler texture_sampler;
         Shared<VulkanImage> placeholder_texture;
         std::vector<Frame> frames;
         u32 frame_index = 0;
+        std::vector<RenderContext*> submitted_render_contexts{};
+        std::vector<QuadInstanceData> reserved_quads{};
+        const VulkanImage* reserved_texture = nullptr;
+        bool reserved_opaque = false;
+        Unique<VulkanRenderTarget> render_target = nullptr;
+        VkDescriptorSetLayout upscale_descriptor_set_layout = nullptr;
+        VulkanDescriptorSet upscale_descriptor_set = nullptr;
+        Unique<VulkanGraphicsPipeline> upscale_graphics_pipeline = nullptr;
 
     public:
         Renderer(const Config& config);
@@ -105,16 +204,158 @@ namespace Storytime {
 
         void end_frame();
 
-        void begin_render() const;
+        void begin_render();
 
         void end_render();
 
         void set_view_projection(const ViewProjection& view_projection);
 
+        /// Render a quad. When deferred rendering is enabled, the quad is only recorded here, and all recorded quads
+        /// are sorted in `end_render`: opaque quads by layer front-to-back and by texture within a layer, then all
+        /// other quads by layer back-to-front, by texture within a layer, and by depth within a texture.
         void render_quad(const Quad& quad);
 
+        /// Render quads that share a texture from instance data that has already been packed, f.ex. cached glyphs of
+        /// a text mesh. The texture index of the instances is assigned here. The texture is looked up once for all of
+        /// the quads instead of once per quad.
+        void render_quads(const Shared<Texture>& texture, const QuadInstanceData* quads, u32 quad_count, u16 layer = 0, bool opaque = false);
+
+        /// Reserve instance memory for up to `quad_count` quads that share a texture, to be written directly by the
+        /// caller (f.ex. a particle system) and then committed with `commit_quads`. Without deferred rendering, the
+        /// memory is in the current batch itself, so the quads are written exactly once. Reserved quads are not culled.
+        ///
+        /// Nothing else may be rendered between reserving and committing.
+        QuadReservation reserve_quads(const Shared<Texture>& texture, u32 quad_count, u16 layer = 0, bool opaque = false);
+
+        /// Commit the first `quad_count` quads of the latest reservation.
+        void commit_quads(u32 quad_count);
+
+        /// Queue the quads of a render context to be added to the frame in `end_render`, after the quads that were
+        /// rendered directly. Contexts are merged in ascending priority, and cleared once merged.
+        ///
+        /// Must be called from the main thread, after all threads have finished rendering to the context. The context
+        /// must be kept alive until `end_render`.
+        void submit_render_context(RenderContext& render_context);
+
+        /// Build a static batch from quads. The quads are packed once and uploaded through a staging buffer to
+        /// device-local memory, so drawing the batch has no per-quad CPU cost.
+        StaticBatch create_static_batch(const std::vector<Quad>& quads, std::string_view name = "StaticBatch");
+
+        /// Replace the quads of a static batch, f.ex. when tiles change. Waits until the device is idle, because frames
+        /// in flight may still be reading the batch.
+        void rebuild_static_batch(StaticBatch& static_batch, const std::vector<Quad>& quads);
+
+        /// Draw a static batch with the current view projection, with one draw call per segment of the batch. Static
+        /// batches are always drawn with blending, regardless of whether their quads are opaque, and write the depth of
+        /// their layers where they are not fully transparent.
+        ///
+        /// A batch with quads whose textures are still being uploaded is not drawn until all of them are ready.
+        void render_static_batch(StaticBatch& static_batch);
+
+        /// Release the resources of a static batch. Waits until the device is idle, because frames in flight may still
+        /// be reading the batch.
+        void destroy_static_batch(StaticBatch& static_batch);
+
+        /// Create a tile layer from a layer of a Tiled map, to be drawn with `render_tile_layer`. The tileset textures
+        /// must be in the same order as the tilesets of the map, and at most `max_textures_per_batch` are supported.
+        /// Every tileset must be a single image with the tile size of the map, image collection tilesets are not
+        /// supported.
+        TileLayer create_tile_layer(const TiledMap& tiled_map, const TiledLayer& tiled_layer, const std::vector<Shared<Texture>>& tileset_textures);
+
+        /// Upload the tiles of the Tiled layer again, f.ex. when tiles change. The size of the layer must not change.
+        /// Waits until the device is idle, because frames in flight may still be reading the tiles.
+        void update_tile_layer(TileLayer& tile_layer, const TiledLayer& tiled_layer);
+
+        /// Draw a tile layer with the current view projection, with a single draw call (or one per tileset texture,
+        /// without descriptor indexing). The tiles write the depth of the layer where they are not fully transparent.
+        /// The layer is not drawn until its tileset textures are ready.
+        void render_tile_layer(TileLayer& tile_layer);
+
+        /// Release the resources of a tile layer. Waits until the device is idle, because frames in flight may still be
+        /// reading the tiles.
+        void destroy_tile_layer(TileLayer& tile_layer);
+
+        /// Assign the texture a persistent index in the bindless texture array, so it can be sampled by any batch.
+        /// Does nothing if bindless textures are not enabled or the texture already has an index.
+        void register_texture(const Shared<Texture>& texture);
+
+        /// Read back the last frame that was rendered and write it to a PNG file, f.ex. to compare it to a golden
+        /// image. Only supported when the swapchain is headless, since presented images can't be copied from. Waits
+        /// until the device is idle, so the frame has finished rendering.
+        void save_frame(const std::filesystem::path& path);
+
+        /// Write a GPU timestamp to the command buffer of the current frame, f.ex. around ImGui, which is rendered
+        /// outside of the renderer. Does nothing when GPU timestamps are disabled.
+        void write_gpu_timestamp(GpuTimestamp timestamp) const;
+
+        /// Time every draw of quad batches, for a breakdown in `Metrics::gpu_draw_durations_ms`. Results show up once
+        /// the frames in flight have been rendered again.
+        void set_gpu_draw_timestamps_enabled(bool enabled);
+
+        /// Pack a quad into the compact instance format that is read by the quad vertex shader.
+        static void write_quad_instance_data(QuadInstanceData& quad_instance_data, const Quad& quad, u32 texture_index);
+
+        /// The key that deferred quads are radix sorted by in `end_render`, see st_renderer.md for its layout.
+        static u64 get_quad_sort_key(u32 view_index, bool opaque, u16 layer, u32 texture_id, f32 depth);
+
     private:
-        void flush(Frame& frame, const Batch& batch) const;
+        bool is_quad_culled(const Frame& frame, const glm::mat4& model) const;
+
+        bool is_quad_culled(const Frame& frame, const QuadInstanceData& quad_instance_data) const;
+
+        u32 cull_quads(Frame& frame, const QuadInstanceData* quads, u32 quad_count) const;
+
+        void cull_deferred_quads(Frame& frame) const;
+
+        void push_view_projection(Frame& frame, const ViewProjection& view_projection) const;
+
+        const ViewProjection& get_current_view_projection(const Frame& frame) const;
+
+        static void retain_texture(Frame& frame, const Shared<VulkanImage>& texture);
+
+        /// The texture index of a quad that is written to the batch, and retains the texture for the frame when it's
+        /// new to the frame or the batch.
+        u32 get_quad_texture_index(Frame& frame, Batch& batch, const Shared<VulkanImage>& texture);
+
+        u32 get_batch_texture_index(Batch& batch, const VulkanImage& texture) const;
+
+        /// The flags that are set in the texture index of the quads that sample the texture, f.ex. whether it has
+        /// premultiplied alpha.
+        static u32 get_texture_index_flags(const VulkanImage& texture);
+
+        void commit_quad(Frame& frame, Batch& batch, u32 quad_count = 1) const;
+
+        void defer_quad(Frame& frame, const Quad& quad, const Shared<VulkanImage>& texture);
+
+        void defer_quad_command(Frame& frame, const QuadCommand& quad_command);
+
+        void add_quad_command(Frame& frame, const QuadCommand& quad_command);
+
+        void merge_render_contexts(Frame& frame);
+
+        void render_deferred_quads(Frame& frame);
+
+        Batch& get_current_batch(Frame& frame);
+
+        Batch& get_quad_batch(Frame& frame, bool opaque);
+
+        void bind_quad_graphics_pipeline(Frame& frame, bool opaque) const;
+
+        void bind_quad_graphics_pipeline(Frame& frame, VkPipeline pipeline, const char* label) const;
+
+        void flush_current_batch(Frame& frame) const;
+
+        void flush(Frame& frame, Batch& batch) const;
+
+        void draw_pending_batches(Frame& frame) const;
+
+        void bind_quad_buffers(const VulkanCommandBuffer& command_buffer, VkBuffer instance_vertex_buffer) const;
+
+        void bind_texture_descriptor_set(const VulkanCommandBuffer& command_buffer, const VulkanDescriptorSet& descriptor_set) const;
+
+        void upscale_render_target(Frame& frame) const;
+
+        VkViewport get_upscale_viewport() const;
 
         void reset(Frame& frame) const;
 
@@ -122,19 +363,86 @@ namespace Storytime {
 
         void end_frame_command_buffer(const VulkanCommandBuffer& command_buffer) const;
 
-        void write_batch_descriptors(const Batch& batch) const;
+        void write_static_batch(StaticBatch& static_batch, const std::vector<Quad>& quads);
+
+        bool write_static_batch_if_ready(StaticBatch& static_batch);
+
+        void write_batch_descriptors(Batch& batch) const;
+
+        void write_tile_layer_descriptors(const TileLayer& tile_layer) const;
+
+        bool write_tile_layer_descriptors_if_ready(TileLayer& tile_layer) const;
+
+        void write_upscale_descriptors() const;
+
+        static std::vector<u32> get_tile_ids(const TiledLayer& tiled_layer);
+
+        VulkanBuffer create_storage_buffer(const void* data, VkDeviceSize size, std::string_view name) const;
+
+        void set_storage_buffer_data(const VulkanBuffer& storage_buffer, const void* data, VkDeviceSize size) const;
+
+        void upload_buffer_data(VkBuffer buffer, const void* data, VkDeviceSize size) const;
+
+        void write_texture_descriptors(const VulkanDescriptorSet& descriptor_set, const std::vector<const VulkanImage*>& textures) const;
+
+        /// The persistent index of the texture in the bindless texture array, including its texture index flags.
+        u32 get_bindless_texture_index(const Shared<VulkanImage>& texture);
+
+        void write_bindless_texture_descriptor(const VulkanImage& texture) const;
 
         VulkanCommandPool create_init_command_pool();
 
         VulkanCommandPool create_frame_command_pool();
 
-        VulkanDescriptorPool create_batch_descriptor_pool();
+        Unique<VulkanDescriptorPool> create_descriptor_pool() const;
+
+        VkDescriptorSet allocate_batch_descriptor_set(std::string_view name);
+
+        VkDescriptorSet allocate_tile_layer_descriptor_set(std::string_view name);
+
+        VkDescriptorSet allocate_descriptor_set(VkDescriptorSetLayout descriptor_set_layout, std::string_view name);
 
         VkDescriptorSetLayout create_batch_descriptor_set_layout() const;
 
         void destroy_batch_descriptor_set_layout() const;
 
-        VulkanGraphicsPipeline create_quad_graphics_pipeline();
+        VkDescriptorSetLayout create_tile_layer_descriptor_set_layout() const;
+
+        void destroy_tile_layer_descriptor_set_layout() const;
+
+        u32 get_bindless_texture_capacity() const;
+
+        bool is_indirect_draws_supported() const;
+
+        u32 get_timestamp_valid_bits() const;
+
+        bool is_gpu_timestamps_supported() const;
+
+        void write_timestamp(const Frame& frame, u32 query) const;
+
+        void read_timestamps(Frame& frame) const;
+
+        Unique<VulkanDescriptorPool> create_bindless_descriptor_pool() const;
+
+        VkDescriptorSetLayout create_bindless_descriptor_set_layout() const;
+
+        void destroy_bindless_descriptor_set_layout() const;
+
+        VkDescriptorSet allocate_bindless_descriptor_set() const;
+
+        VulkanGraphicsPipeline create_quad_graphics_pipeline(bool opaque, bool alpha_discard_enabled);
+
+        VulkanGraphicsPipeline create_tile_layer_graphics_pipeline();
+
+        Unique<VulkanRenderTarget> create_render_target() const;
+
+        VkDescriptorSetLayout create_upscale_descriptor_set_layout() const;
+
+        void destroy_upscale_descriptor_set_layout() const;
+
+        VkDescriptorSet allocate_upscale_descriptor_set();
+
+        Unique<VulkanGraphicsPipeline> create_upscale_graphics_pipeline();
 
         VkShaderModule create_shader_module(const std::filesystem::path& path, std::string_view name = "") const;
 
@@ -154,6 +462,10 @@ namespace Storytime {
 
         std::vector<Frame> create_frames();
 
+        void create_batch_buffers(Frame& frame, u32 frame_number, u32 batch_capacity);
+
+        Batch create_batch(Frame& frame, u32 frame_number, u32 batch_index);
+
         void destroy_frames();
     };
 }
@@ -0,0 +1,106 @@
+#include "st_skyline_packer.h"
+
+namespace Storytime {
+    SkylinePacker::SkylinePacker(u32 width, u32 height) : width(width), height(height) {
+        ST_ASSERT_GREATER_THAN_ZERO(width);
+        ST_ASSERT_GREATER_THAN_ZERO(height);
+        skyline.push_back({ .x = 0, .y = 0, .width = width });
+    }
+
+    bool SkylinePacker::pack(u32 rectangle_width, u32 rectangle_height, u32* x, u32* y) {
+        ST_ASSERT_GREATER_THAN_ZERO(rectangle_width);
+        ST_ASSERT_GREATER_THAN_ZERO(rectangle_height);
+
+        // Pick the segment where the top of the rectangle is the lowest, and the narrowest segment if there is a tie,
+        // so that wide segments are left for wide rectangles.
+        u32 best_index = std::numeric_limits<u32>::max();
+        u32 best_top = std::numeric_limits<u32>::max();
+        u32 best_width = std::numeric_limits<u32>::max();
+        u32 best_y = 0;
+
+        for (u32 i = 0; i < skyline.size(); i++) {
+            u32 segment_y = 0;
+            if (!fit(i, rectangle_width, rectangle_height, &segment_y)) {
+                continue;
+            }
+            u32 top = segment_y + rectangle_height;
+            if (top < best_top || (top == best_top && skyline[i].width < best_width)) {
+                best_index = i;
+                best_top = top;
+                best_width = skyline[i].width;
+                best_y = segment_y;
+            }
+        }
+
+        if (best_index == std::numeric_limits<u32>::max()) {
+            return false;
+        }
+
+        *x = skyline[best_index].x;
+        *y = best_y;
+        add_segment(best_index, *x, *y, rectangle_width, rectangle_height);
+        used_height = std::max(used_height, best_top);
+        return true;
+    }
+
+    u32 SkylinePacker::get_used_height() const {
+        return used_height;
+    }
+
+    bool SkylinePacker::fit(u32 segment_index, u32 rectangle_width, u32 rectangle_height, u32* y) const {
+        u32 x = skyline[segment_index].x;
+        if (x + rectangle_width > width) {
+            return false;
+        }
+
+        // The rectangle rests on the highest segment it spans.
+        u32 top = 0;
+        u32 remaining_width = rectangle_width;
+        for (u32 i = segment_index; remaining_width > 0; i++) {
+            ST_ASSERT(i < skyline.size(), "Skyline must span the whole width");
+            top = std::max(top, skyline[i].y);
+            if (top + rectangle_height > height) {
+                return false;
+            }
+            remaining_width -= std::min(remaining_width, skyline[i].width);
+        }
+
+        *y = top;
+        return true;
+    }
+
+    void SkylinePacker::add_segment(u32 segment_index, u32 x, u32 y, u32 rectangle_width, u32 rectangle_height) {
+        skyline.insert(skyline.begin() + segment_index, {
+            .x = x,
+            .y = y + rectangle_height,
+            .width = rectangle_width,
+        });
+
+        // Shrink or remove the segments that are now covered by the new segment.
+        u32 right = x + rectangle_width;
+        for (u32 i = segment_index + 1; i < skyline.size();) {
+            Segment& segment = skyline[i];
+            if (segment.x >= right) {
+                break;
+            }
+            u32 segment_right = segment.x + segment.width;
+            if (segment_right <= right) {
+                skyline.erase(skyline.begin() + i);
+                continue;
+            }
+            segment.width = segment_right - right;
+            segment.x = right;
+            break;
+        }
+
+        // Merge neighboring segments at the same height.
+        for (u32 i = 0; i + 1 < skyline.size();) {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + i + 1);
+                continue;
+            }
+            i++;
+        }
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+namespace Storytime {
+    ///
+    /// Packs rectangles into a fixed area with the skyline bottom-left heuristic.
+    ///
+    /// The packer only keeps track of the top edge (the skyline) of the rectangles that have been packed, as a list of
+    /// horizontal segments. A rectangle is placed on the segment where its top edge ends up the lowest, which keeps the
+    /// skyline flat and the area under it densely packed. Rectangles should be packed tallest first for best results.
+    ///
+    class SkylinePacker {
+    private:
+        struct Segment {
+            u32 x = 0;
+            u32 y = 0;
+            u32 width = 0;
+        };
+
+    private:
+        u32 width = 0;
+        u32 height = 0;
+        u32 used_height = 0;
+        std::vector<Segment> skyline;
+
+    public:
+        SkylinePacker(u32 width, u32 height);
+
+        /// Find a position for a rectangle. Returns false if it doesn't fit in the remaining area.
+        bool pack(u32 rectangle_width, u32 rectangle_height, u32* x, u32* y);
+
+        /// The height of the highest point of the skyline.
+        u32 get_used_height() const;
+
+    private:
+        bool fit(u32 segment_index, u32 rectangle_width, u32 rectangle_height, u32* y) const;
+
+        void add_segment(u32 segment_index, u32 x, u32 y, u32 rectangle_width, u32 rectangle_height);
+    };
+}
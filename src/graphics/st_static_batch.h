@@ -0,0 +1,37 @@
+#pragma once
+
+#include "graphics/st_quad.h"
+#include "graphics/st_texture.h"
+#include "graphics/st_vulkan_descriptor_set.h"
+#include "graphics/st_vulkan_vertex_buffer.h"
+
+namespace Storytime {
+    /// A range of instances in a static batch that is drawn with a single draw call.
+    struct StaticBatchSegment {
+        u32 first_instance = 0;
+        u32 instance_count = 0;
+        /// The texture samplers of the segment. Not used when bindless textures are enabled.
+        VulkanDescriptorSet descriptor_set = nullptr;
+    };
+
+    /// Quads that are built once by the @Renderer and kept in device-local memory, so they can be drawn every frame
+    /// without being packed or uploaded again. Useful for content that rarely changes, f.ex. tilemap layers.
+    ///
+    /// Created, rebuilt and destroyed through the renderer, see `Renderer::create_static_batch`.
+    struct StaticBatch {
+        std::string name = "StaticBatch";
+        VulkanVertexBuffer vertex_buffer{};
+        u32 quad_capacity = 0;
+        u32 quad_count = 0;
+        /// A batch is split into segments of at most `Renderer::max_textures_per_batch` textures when bindless textures
+        /// are disabled, otherwise it's a single segment.
+        std::vector<StaticBatchSegment> segments{};
+        /// Descriptor sets allocated for segments, kept when the batch is rebuilt so they can be reused.
+        std::vector<VulkanDescriptorSet> descriptor_sets{};
+        /// Keeps the textures of the quads alive for as long as the batch uses them.
+        std::vector<Shared<Texture>> textures{};
+        /// Quads that have not been written to the batch yet, because some of their textures are still being uploaded.
+        /// They are written once all of their textures are ready, and the batch is not drawn until then.
+        std::vector<Quad> pending_quads{};
+    };
+}
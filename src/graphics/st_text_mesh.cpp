@@ -0,0 +1,55 @@
+#include "st_text_mesh.h"
+
+namespace Storytime {
+    TextMesh::TextMesh(const BitmapFont& font, std::string_view text, const BitmapTextConfig& text_config)
+        : font(font),
+          text(text),
+          text_config(text_config)
+    {
+    }
+
+    const std::string& TextMesh::get_text() const {
+        return text;
+    }
+
+    void TextMesh::set_text(std::string_view text) {
+        if (this->text == text) {
+            return;
+        }
+        this->text = text;
+        dirty = true;
+    }
+
+    const BitmapTextConfig& TextMesh::get_text_config() const {
+        return text_config;
+    }
+
+    void TextMesh::set_text_config(const BitmapTextConfig& text_config) {
+        if (this->text_config.position == text_config.position && this->text_config.font_size == text_config.font_size && this->text_config.debug == text_config.debug) {
+            return;
+        }
+        this->text_config = text_config;
+        dirty = true;
+    }
+
+    void TextMesh::set_position(const glm::vec3& position) {
+        if (text_config.position == position) {
+            return;
+        }
+        text_config.position = position;
+        dirty = true;
+    }
+
+    void TextMesh::render() {
+        if (dirty) {
+            layout();
+        }
+        font.render_glyphs(quads);
+    }
+
+    void TextMesh::layout() {
+        quads.clear();
+        font.layout_text(text, text_config, quads);
+        dirty = false;
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "graphics/st_bitmap_font.h"
+
+namespace Storytime {
+    ///
+    /// Text that is laid out once and rendered from cached quad instances until it changes.
+    ///
+    /// Static text, like labels in a HUD, costs a single copy of its instances per frame instead of a layout pass and
+    /// a quad per character.
+    ///
+    class TextMesh {
+    private:
+        const BitmapFont& font;
+        std::string text;
+        BitmapTextConfig text_config;
+        std::vector<QuadInstanceData> quads;
+        bool dirty = true;
+
+    public:
+        TextMesh(const BitmapFont& font, std::string_view text = "", const BitmapTextConfig& text_config = {});
+
+        const std::string& get_text() const;
+
+        void set_text(std::string_view text);
+
+        const BitmapTextConfig& get_text_config() const;
+
+        void set_text_config(const BitmapTextConfig& text_config);
+
+        void set_position(const glm::vec3& position);
+
+        void render();
+
+    private:
+        void layout();
+    };
+}
@@ -0,0 +1,166 @@
+#include "st_texture_atlas.h"
+#include "graphics/st_skyline_packer.h"
+
+#include <numeric>
+
+namespace Storytime {
+    static u32 align_up(u32 value, u32 alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    TextureAtlasBuilder::TextureAtlasBuilder(const Config& config) : config(config.assert_valid()) {
+    }
+
+    void TextureAtlasBuilder::add_image(std::string_view name, u32 width, u32 height, const void* pixels) {
+        ST_ASSERT_GREATER_THAN_ZERO(width);
+        ST_ASSERT_GREATER_THAN_ZERO(height);
+        ST_ASSERT_NOT_NULL(pixels);
+        u64 byte_size = (u64) width * height * 4;
+        images.push_back({
+            .name = std::string(name),
+            .width = width,
+            .height = height,
+            .pixels = std::vector<u8>((const u8*) pixels, (const u8*) pixels + byte_size),
+        });
+    }
+
+    TextureAtlasBuilder::Result TextureAtlasBuilder::build() const {
+        u32 extrusion = get_extrusion();
+
+        // Pack the tallest images first, which leaves the flattest skyline.
+        std::vector<u32> image_order(images.size());
+        std::iota(image_order.begin(), image_order.end(), 0);
+        std::ranges::stable_sort(image_order, [this](u32 a, u32 b) {
+            return images[a].height != images[b].height ? images[a].height > images[b].height : images[a].width > images[b].width;
+        });
+
+        //
+        // Pack the images into as many pages as needed.
+        //
+        // Every image occupies a cell that is its size plus the extrusion on every side, rounded up to the alignment
+        // grid. Since every cell is a multiple of the grid, every cell (and the image in it) starts on the grid.
+        //
+
+        std::vector<TextureAtlasRegion> regions(images.size());
+        std::vector<SkylinePacker> packers;
+
+        for (u32 image_index : image_order) {
+            const Image& image = images[image_index];
+            u32 cell_width = align_up(image.width + extrusion * 2, extrusion);
+            u32 cell_height = align_up(image.height + extrusion * 2, extrusion);
+            if (cell_width > config.page_size || cell_height > config.page_size) {
+                ST_THROW("Could not pack image [" << image.name << "] of size [" << image.width << "x" << image.height << "] into atlas [" << config.name << "] with page size [" << config.page_size << "]");
+            }
+
+            u32 x = 0;
+            u32 y = 0;
+            u32 page_index = 0;
+            while (page_index < packers.size() && !packers[page_index].pack(cell_width, cell_height, &x, &y)) {
+                page_index++;
+            }
+            if (page_index == packers.size()) {
+                packers.emplace_back(config.page_size, config.page_size);
+                bool packed = packers.back().pack(cell_width, cell_height, &x, &y);
+                ST_ASSERT(packed, "Image [" << image.name << "] must fit in an empty atlas page");
+            }
+
+            regions[image_index] = {
+                .page_index = page_index,
+                .x = x + extrusion,
+                .y = y + extrusion,
+                .width = image.width,
+                .height = image.height,
+            };
+        }
+
+        //
+        // Copy the images to their pages.
+        //
+
+        Result result{};
+        result.pages.resize(packers.size());
+        for (u32 i = 0; i < packers.size(); i++) {
+            TextureAtlasPage& page = result.pages[i];
+            page.width = config.page_size;
+            // Pages only need to be as tall as their skyline, rounded up to a power of two.
+            page.height = std::min(std::bit_ceil(packers[i].get_used_height()), config.page_size);
+            page.pixels.resize((u64) page.width * page.height * 4);
+        }
+
+        result.regions.reserve(images.size());
+        for (u32 i = 0; i < images.size(); i++) {
+            const TextureAtlasRegion& region = regions[i];
+            copy_image(images[i], result.pages[region.page_index], region.x, region.y);
+            result.regions.emplace_back(images[i].name, region);
+        }
+
+        ST_LOG_D("Packed [{}] images into [{}] pages of atlas [{}]", images.size(), result.pages.size(), config.name);
+        return result;
+    }
+
+    u32 TextureAtlasBuilder::get_extrusion() const {
+        return 1u << (config.mip_levels - 1);
+    }
+
+    void TextureAtlasBuilder::copy_image(const Image& image, TextureAtlasPage& page, u32 x, u32 y) const {
+        i32 extrusion = (i32) get_extrusion();
+
+        // Copy the image, and extrude its edge pixels into the surrounding cell so that filtering at the edges of the
+        // image, at any mip level, samples the image's own colors.
+        for (i32 row = -extrusion; row < (i32) image.height + extrusion; row++) {
+            i32 src_row = std::clamp(row, 0, (i32) image.height - 1);
+            for (i32 column = -extrusion; column < (i32) image.width + extrusion; column++) {
+                i32 src_column = std::clamp(column, 0, (i32) image.width - 1);
+                const u8* src = &image.pixels[((u64) src_row * image.width + src_column) * 4];
+                u8* dst = &page.pixels[((u64) (y + row) * page.width + (x + column)) * 4];
+                memcpy(dst, src, 4);
+            }
+        }
+    }
+
+    TextureAtlas::TextureAtlas(const std::vector<Shared<Texture>>& pages, const std::vector<std::pair<std::string, TextureAtlasRegion>>& regions)
+        : pages(pages)
+    {
+        sprites.reserve(regions.size());
+        for (const auto& [name, region] : regions) {
+            ST_ASSERT_IN_BOUNDS(region.page_index, pages);
+            const Shared<Texture>& page = pages[region.page_index];
+            f32 page_width = (f32) page->get_width();
+            f32 page_height = (f32) page->get_height();
+
+            glm::vec4 texture_rectangle{
+                (f32) region.x / page_width,
+                (f32) region.y / page_height,
+                (f32) (region.x + region.width) / page_width,
+                (f32) (region.y + region.height) / page_height,
+            };
+
+            sprites.emplace(name, Sprite({
+                .spritesheet_texture = page,
+                .spritesheet_texture_rectangle = texture_rectangle,
+                .width = region.width,
+                .height = region.height,
+            }));
+        }
+    }
+
+    const std::vector<Shared<Texture>>& TextureAtlas::get_pages() const {
+        return pages;
+    }
+
+    u32 TextureAtlas::get_sprite_count() const {
+        return (u32) sprites.size();
+    }
+
+    bool TextureAtlas::has_sprite(const std::string& name) const {
+        return sprites.contains(name);
+    }
+
+    Sprite TextureAtlas::get_sprite(const std::string& name) const {
+        auto it = sprites.find(name);
+        if (it == sprites.end()) {
+            ST_THROW("Could not find sprite [" << name << "] in texture atlas");
+        }
+        return it->second;
+    }
+}
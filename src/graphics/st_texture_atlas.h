@@ -0,0 +1,98 @@
+#pragma once
+
+#include "graphics/st_sprite.h"
+#include "graphics/st_texture.h"
+
+namespace Storytime {
+    struct TextureAtlasConfig {
+        std::string name = "TextureAtlas";
+
+        /// The largest width and height of an atlas page. Pages are as tall as their packed images need.
+        u32 page_size = 2048;
+
+        /// The number of mip levels of the atlas pages. Images are extruded by their edge pixels and aligned to a grid,
+        /// both of size 2^(mip_levels - 1), so that sampling any mip level never blends with a neighboring image.
+        u32 mip_levels = 3;
+
+        const TextureAtlasConfig& assert_valid() const {
+            ST_ASSERT_GREATER_THAN_ZERO(page_size);
+            ST_ASSERT_GREATER_THAN_ZERO(mip_levels);
+            return *this;
+        }
+    };
+
+    /// The pixel rectangle of an image in an atlas page.
+    struct TextureAtlasRegion {
+        u32 page_index = 0;
+        u32 x = 0;
+        u32 y = 0;
+        u32 width = 0;
+        u32 height = 0;
+    };
+
+    struct TextureAtlasPage {
+        u32 width = 0;
+        u32 height = 0;
+        std::vector<u8> pixels; /// RGBA8
+    };
+
+    ///
+    /// Packs RGBA8 images into atlas pages on the CPU.
+    ///
+    class TextureAtlasBuilder {
+    public:
+        typedef TextureAtlasConfig Config;
+
+        struct Result {
+            std::vector<TextureAtlasPage> pages;
+            std::vector<std::pair<std::string, TextureAtlasRegion>> regions; /// In the order the images were added.
+        };
+
+    private:
+        struct Image {
+            std::string name;
+            u32 width = 0;
+            u32 height = 0;
+            std::vector<u8> pixels;
+        };
+
+    private:
+        Config config;
+        std::vector<Image> images;
+
+    public:
+        TextureAtlasBuilder(const Config& config);
+
+        void add_image(std::string_view name, u32 width, u32 height, const void* pixels);
+
+        Result build() const;
+
+        /// The number of pixels that images are extruded by on each side, and the grid they are aligned to.
+        u32 get_extrusion() const;
+
+    private:
+        void copy_image(const Image& image, TextureAtlasPage& page, u32 x, u32 y) const;
+    };
+
+    ///
+    /// A set of images packed into one or more large textures, so that they can be drawn together in the same batches.
+    ///
+    /// The images are looked up by name as sprites whose texture rectangle is their region in the atlas page.
+    ///
+    class TextureAtlas {
+    private:
+        std::vector<Shared<Texture>> pages;
+        std::unordered_map<std::string, Sprite> sprites;
+
+    public:
+        TextureAtlas(const std::vector<Shared<Texture>>& pages, const std::vector<std::pair<std::string, TextureAtlasRegion>>& regions);
+
+        const std::vector<Shared<Texture>>& get_pages() const;
+
+        u32 get_sprite_count() const;
+
+        bool has_sprite(const std::string& name) const;
+
+        Sprite get_sprite(const std::string& name) const;
+    };
+}
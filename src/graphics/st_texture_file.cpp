@@ -0,0 +1,131 @@
+#include "st_texture_file.h"
+
+#include <fstream>
+
+namespace Storytime {
+    static u64 align_up(u64 value, u64 alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    TextureFile::TextureFile(const std::filesystem::path& path) : file(path) {
+        if (file.get_size() < sizeof(TextureFileHeader)) {
+            ST_THROW("Could not read texture file [" << path << "] because it is too small to have a header");
+        }
+        header = (const TextureFileHeader*) file.get_data();
+        mip_levels = (const TextureFileMipLevel*) ((const u8*) file.get_data() + sizeof(TextureFileHeader));
+        validate();
+    }
+
+    bool TextureFile::is_texture_file(const std::filesystem::path& path) {
+        return path.extension() == extension;
+    }
+
+    u32 TextureFile::get_width() const {
+        return header->width;
+    }
+
+    u32 TextureFile::get_height() const {
+        return header->height;
+    }
+
+    VkFormat TextureFile::get_format() const {
+        return (VkFormat) header->format;
+    }
+
+    u32 TextureFile::get_mip_level_count() const {
+        return header->mip_level_count;
+    }
+
+    bool TextureFile::has_flag(TextureFileFlag flag) const {
+        return (header->flags & (u32) flag) != 0;
+    }
+
+    std::vector<VulkanImageMipLevelPixels> TextureFile::get_mip_level_pixels() const {
+        std::vector<VulkanImageMipLevelPixels> mip_level_pixels(header->mip_level_count);
+        for (u32 i = 0; i < header->mip_level_count; i++) {
+            mip_level_pixels[i].data = (const u8*) file.get_data() + mip_levels[i].offset;
+            mip_level_pixels[i].size = mip_levels[i].size;
+        }
+        return mip_level_pixels;
+    }
+
+    void TextureFile::write(const std::filesystem::path& path, TextureFileHeader header, const std::vector<std::vector<u8>>& mip_levels) {
+        ST_ASSERT(!mip_levels.empty(), "Texture file [" << path << "] must have at least one mip level");
+
+        header.magic = magic;
+        header.version = version;
+        header.mip_level_count = (u32) mip_levels.size();
+
+        std::vector<TextureFileMipLevel> mip_level_table(mip_levels.size());
+        u64 offset = align_up(sizeof(TextureFileHeader) + mip_level_table.size() * sizeof(TextureFileMipLevel), data_alignment);
+        for (u32 i = 0; i < mip_levels.size(); i++) {
+            mip_level_table[i].offset = offset;
+            mip_level_table[i].size = mip_levels[i].size();
+            offset = align_up(offset + mip_levels[i].size(), data_alignment);
+        }
+
+        std::ofstream output_stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!output_stream) {
+            ST_THROW("Could not open texture file [" << path << "] for writing");
+        }
+
+        auto write_padding = [&output_stream](u64 target_offset) {
+            static constexpr std::array<char, data_alignment> zeros{};
+            u64 position = (u64) output_stream.tellp();
+            output_stream.write(zeros.data(), (std::streamsize) (target_offset - position));
+        };
+
+        output_stream.write((const char*) &header, sizeof(TextureFileHeader));
+        output_stream.write((const char*) mip_level_table.data(), (std::streamsize) (mip_level_table.size() * sizeof(TextureFileMipLevel)));
+        for (u32 i = 0; i < mip_levels.size(); i++) {
+            write_padding(mip_level_table[i].offset);
+            output_stream.write((const char*) mip_levels[i].data(), (std::streamsize) mip_levels[i].size());
+        }
+
+        if (!output_stream) {
+            ST_THROW("Could not write texture file [" << path << "]");
+        }
+    }
+
+    void TextureFile::validate() const {
+        const std::filesystem::path& path = file.get_path();
+        if (header->magic != magic) {
+            ST_THROW("Could not read texture file [" << path << "] because it is not a texture file");
+        }
+        if (header->version != version) {
+            ST_THROW("Could not read texture file [" << path << "] because its version [" << header->version << "] is not the supported version [" << version << "], it must be cooked again");
+        }
+        if (header->width == 0 || header->height == 0) {
+            ST_THROW("Could not read texture file [" << path << "] because its dimensions [" << header->width << "x" << header->height << "] are empty");
+        }
+        if (header->format != format) {
+            ST_THROW("Could not read texture file [" << path << "] because its format [" << header->format << "] is not the supported format [" << format << "]");
+        }
+        if ((header->flags & ~supported_flags) != 0) {
+            ST_THROW("Could not read texture file [" << path << "] because it has unsupported flags [" << header->flags << "]");
+        }
+        if (header->mip_level_count == 0) {
+            ST_THROW("Could not read texture file [" << path << "] because it has no mip levels");
+        }
+        u32 max_mip_level_count = (u32) std::floor(std::log2(std::max(header->width, header->height))) + 1;
+        if (header->mip_level_count > max_mip_level_count) {
+            ST_THROW("Could not read texture file [" << path << "] because its mip level count [" << header->mip_level_count << "] exceeds the full mip chain [" << max_mip_level_count << "]");
+        }
+        u64 mip_level_table_end = sizeof(TextureFileHeader) + (u64) header->mip_level_count * sizeof(TextureFileMipLevel);
+        if (mip_level_table_end > file.get_size()) {
+            ST_THROW("Could not read texture file [" << path << "] because its mip level table is truncated");
+        }
+        for (u32 i = 0; i < header->mip_level_count; i++) {
+            const TextureFileMipLevel& mip_level = mip_levels[i];
+            if (mip_level.offset < mip_level_table_end || mip_level.offset + mip_level.size > file.get_size()) {
+                ST_THROW("Could not read texture file [" << path << "] because mip level [" << i << "] is out of bounds");
+            }
+            u64 mip_level_width = std::max(header->width >> i, 1u);
+            u64 mip_level_height = std::max(header->height >> i, 1u);
+            u64 expected_size = mip_level_width * mip_level_height * bytes_per_pixel;
+            if (mip_level.size != expected_size) {
+                ST_THROW("Could not read texture file [" << path << "] because the size [" << mip_level.size << "] of mip level [" << i << "] is not the size [" << expected_size << "] of " << mip_level_width << "x" << mip_level_height << " pixels");
+            }
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "graphics/st_vulkan_image.h"
+#include "system/st_mapped_file.h"
+
+namespace Storytime {
+    enum class TextureFileFlag : u32 {
+        /// The color channels of the pixels have been multiplied by their alpha channel.
+        PREMULTIPLIED_ALPHA = 1 << 0,
+    };
+
+    struct TextureFileHeader {
+        std::array<char, 4> magic{};
+        u32 version = 0;
+        u32 format = VK_FORMAT_UNDEFINED; /// The VkFormat of the pixels, see `TextureFile::format`.
+        u32 width = 0;
+        u32 height = 0;
+        u32 mip_level_count = 0;
+        u32 flags = 0; /// TextureFileFlag bits.
+        u32 reserved = 0;
+    };
+
+    static_assert(sizeof(TextureFileHeader) == 32, "Texture file header must match the file layout");
+
+    struct TextureFileMipLevel {
+        u64 offset = 0; /// From the start of the file.
+        u64 size = 0;
+    };
+
+    static_assert(sizeof(TextureFileMipLevel) == 16, "Texture file mip level must match the file layout");
+
+    ///
+    /// A texture that has been cooked offline, with its whole mip chain, into a `.sttex` file.
+    ///
+    /// Layout:
+    /// - `TextureFileHeader`
+    /// - `TextureFileMipLevel` for each mip level, starting with the base image
+    /// - The pixels of each mip level, tightly packed row by row, starting at an offset aligned to `data_alignment`
+    ///
+    /// The file is memory mapped, so the pixels are staged for upload straight from the mapping and are never decoded
+    /// or copied on the CPU.
+    ///
+    class TextureFile {
+    public:
+        static constexpr std::array<char, 4> magic = { 'S', 'T', 'T', 'X' };
+        static constexpr u32 version = 1;
+        static constexpr std::string_view extension = ".sttex";
+        static constexpr u64 data_alignment = 16;
+        /// The only supported pixel format. Every mip level is tightly packed with 4 bytes per pixel.
+        static constexpr VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+        static constexpr u32 bytes_per_pixel = 4;
+        /// All `TextureFileFlag` bits, any other bits are rejected.
+        static constexpr u32 supported_flags = (u32) TextureFileFlag::PREMULTIPLIED_ALPHA;
+
+    private:
+        MappedFile file;
+        const TextureFileHeader* header = nullptr;
+        const TextureFileMipLevel* mip_levels = nullptr;
+
+    public:
+        TextureFile(const std::filesystem::path& path);
+
+        static bool is_texture_file(const std::filesystem::path& path);
+
+        u32 get_width() const;
+
+        u32 get_height() const;
+
+        VkFormat get_format() const;
+
+        u32 get_mip_level_count() const;
+
+        bool has_flag(TextureFileFlag flag) const;
+
+        std::vector<VulkanImageMipLevelPixels> get_mip_level_pixels() const;
+
+        /// Write a texture file. The mip levels must be given in order, starting with the base image.
+        static void write(const std::filesystem::path& path, TextureFileHeader header, const std::vector<std::vector<u8>>& mip_levels);
+
+    private:
+        void validate() const;
+    };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "graphics/st_texture.h"
+#include "graphics/st_vulkan_buffer.h"
+#include "graphics/st_vulkan_descriptor_set.h"
+
+namespace Storytime {
+    /// The texture rectangle and tileset texture of a single tile, indexed by global tile ID (GID) in the tile data
+    /// storage buffer. Matches the std430 layout of `TileData` in the tile layer vertex shader.
+    struct TileData {
+        glm::vec4 texture_rectangle{};
+        u32 texture_index = 0;
+        u32 padding[3]{};
+    };
+
+    static_assert(sizeof(TileData) == 32, "TileData must match the std430 layout of the tile layer vertex shader");
+
+    /// The texture index of `TileLayerPushConstants` that draws the tiles of all tileset textures in a single draw.
+    static constexpr u32 tile_layer_all_textures = 0xFFFFFFFF;
+
+    /// Push constants of the tile layer shaders.
+    struct TileLayerPushConstants {
+        glm::mat4 view_projection = glm::mat4(1.0f);
+        /// The world-space offset of the layer, including its parallax offset.
+        glm::vec2 offset{};
+        glm::vec2 tile_size{};
+        u32 width = 0;
+        u32 height = 0;
+        u32 layer = 0;
+        /// The tileset texture to draw the tiles of. Without descriptor indexing, the fragment shader must sample the
+        /// same texture for the whole draw, so the layer is drawn once per tileset texture.
+        u32 texture_index = tile_layer_all_textures;
+    };
+
+    static_assert(offsetof(TileLayerPushConstants, texture_index) == 92, "The texture index must match the offset in the tile layer fragment shader");
+
+    /// A tilemap layer that is resolved on the GPU. The global tile IDs of the layer, including the Tiled flip bits,
+    /// are uploaded to a storage buffer once, together with a lookup table from tile ID to texture rectangle built from
+    /// the tilesets of the map. Drawing the layer is a single draw call with one instance per tile, regardless of map
+    /// size (or one draw call per tileset texture, when the device doesn't support descriptor indexing).
+    ///
+    /// Created, updated and destroyed through the renderer, see `Renderer::create_tile_layer`.
+    struct TileLayer {
+        std::string name = "TileLayer";
+        u32 width = 0;
+        u32 height = 0;
+        glm::vec2 tile_size{};
+        glm::vec2 offset{};
+        glm::vec2 parallax{ 1.0f, 1.0f };
+        /// The layer of the tile layer, which orders it among quads by depth testing like `Quad::layer`.
+        u16 layer = 0;
+        VulkanBuffer tile_id_buffer{};
+        VulkanBuffer tile_data_buffer{};
+        VulkanDescriptorSet descriptor_set = nullptr;
+        /// Whether the descriptor set has been written, which is deferred until all tileset textures are ready.
+        bool descriptors_written = false;
+        /// Keeps the tileset textures alive for as long as the layer uses them.
+        std::vector<Shared<Texture>> textures{};
+    };
+}
@@ -1,6 +1,7 @@
 #include "st_vulkan_buffer.h"
 
 #include "graphics/st_vulkan_command_buffer.h"
+#include "graphics/st_vulkan_staging_ring.h"
 
 namespace Storytime {
     VulkanBuffer::VulkanBuffer(const Config& config) : config(config.assert_valid()) {
@@ -16,21 +17,27 @@ namespace Storytime {
     VulkanBuffer::VulkanBuffer(VulkanBuffer&& other) noexcept
         : config(std::move(other.config)),
           buffer(other.buffer),
-          memory(other.memory),
+          allocation(other.allocation),
           data(other.data)
     {
         other.buffer = nullptr;
-        other.memory = nullptr;
+        other.allocation = {};
+        other.data = nullptr;
     }
 
     VulkanBuffer& VulkanBuffer::operator=(VulkanBuffer&& other) noexcept {
         if (this != &other) {
+            // Release the buffer that is being replaced, so that assigning a new buffer (f.ex. when growing) doesn't
+            // leak it. It must no longer be in use by the device.
+            free_memory();
+            destroy_buffer();
             config = std::move(other.config);
             buffer = other.buffer;
-            memory = other.memory;
+            allocation = other.allocation;
             data = other.data;
             other.buffer = nullptr;
-            other.memory = nullptr;
+            other.allocation = {};
+            other.data = nullptr;
         }
         return *this;
     }
@@ -40,32 +47,73 @@ namespace Storytime {
     }
 
     void VulkanBuffer::map_memory() {
-        ST_ASSERT_NOT_NULL(memory);
-        constexpr VkDeviceSize offset = 0;
-        constexpr VkMemoryMapFlags flags = 0;
-        ST_ASSERT_THROW_VK(
-            config.device->map_memory(memory, offset, config.size, flags, &data),
-            "Could not map memory for buffer [" << config.name << "]"
-        );
+        ST_ASSERT(allocation, "Buffer [" << config.name << "] must have memory to map");
+        ST_ASSERT(allocation.data != nullptr, "Buffer [" << config.name << "] must have host visible memory to map");
+        data = allocation.data;
     }
 
     void VulkanBuffer::unmap_memory() const {
-        if (memory != nullptr) {
-            config.device->unmap_memory(memory);
-        }
+        // The memory block that the buffer is sub-allocated from stays mapped for as long as it exists, since other
+        // resources in the same block may be mapped as well.
+    }
+
+    VkDeviceSize VulkanBuffer::get_size() const {
+        return config.size;
+    }
+
+    void* VulkanBuffer::get_data() const {
+        return data;
     }
 
     void VulkanBuffer::set_data(const void* src) const {
-        memcpy(data, src, config.size);
+        set_data(src, config.size);
+    }
+
+    void VulkanBuffer::set_data(const void* src, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT_NOT_NULL(data);
+        ST_ASSERT(offset + size <= config.size, "Data range [" << offset << ", " << offset + size << "] must be within buffer [" << config.name << "] of size [" << config.size << "]");
+        if (size == 0) {
+            return;
+        }
+        memcpy((u8*) data + offset, src, size);
+    }
+
+    void VulkanBuffer::stage_data(const VulkanCommandBuffer& command_buffer, const void* src, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT(offset + size <= config.size, "Data range [" << offset << ", " << offset + size << "] must be within buffer [" << config.name << "] of size [" << config.size << "]");
+        if (size == 0) {
+            return;
+        }
+
+        VulkanStagingRegion staging_region = config.device->get_staging_ring().stage(src, size);
+
+        constexpr u32 copy_region_count = 1;
+
+        VkBufferCopy copy_region{};
+        copy_region.size = size;
+        copy_region.srcOffset = staging_region.offset;
+        copy_region.dstOffset = offset;
+
+        command_buffer.copy_buffer(staging_region.buffer, buffer, copy_region_count, &copy_region);
     }
 
     void VulkanBuffer::copy_data(const VulkanCommandBuffer& command_buffer, VkBuffer destination_buffer) const {
+        copy_data(command_buffer, destination_buffer, config.size);
+    }
+
+    void VulkanBuffer::copy_data(const VulkanCommandBuffer& command_buffer, VkBuffer destination_buffer, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT(offset + size <= config.size, "Copy range [" << offset << ", " << offset + size << "] must be within buffer [" << config.name << "] of size [" << config.size << "]");
+        if (size == 0) {
+            return;
+        }
+
         constexpr u32 copy_region_count = 1;
 
+        // The range is copied to the same offset in the destination buffer, so that a staging buffer and the buffer it
+        // is uploading to can be treated as mirrors of each other.
         VkBufferCopy copy_region{};
-        copy_region.size = config.size;
-        copy_region.srcOffset = 0;
-        copy_region.dstOffset = 0;
+        copy_region.size = size;
+        copy_region.srcOffset = offset;
+        copy_region.dstOffset = offset;
 
         command_buffer.copy_buffer(buffer, destination_buffer, copy_region_count, &copy_region);
     }
@@ -93,32 +141,24 @@ namespace Storytime {
 
     void VulkanBuffer::allocate_memory() {
         const VulkanDevice& device = *config.device;
-        const VulkanPhysicalDevice& physical_device = device.get_physical_device();
 
         VkMemoryRequirements memory_requirements = device.get_buffer_memory_requirements(buffer);
-        i32 memory_type_index = physical_device.find_supported_memory_type(memory_requirements, config.memory_properties);
-
-        VkMemoryAllocateInfo memory_allocate_info{};
-        memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memory_allocate_info.allocationSize = memory_requirements.size;
-        memory_allocate_info.memoryTypeIndex = memory_type_index;
-
-        std::string memory_name = std::format("{} memory", config.name);
-
-        ST_ASSERT_THROW_VK(
-            device.allocate_memory(memory_allocate_info, &memory, memory_name),
-            "Could not allocate buffer memory [" << memory_name << "]"
+        allocation = device.get_memory_allocator().allocate(
+            memory_requirements,
+            config.memory_properties,
+            VulkanMemoryResourceType::BUFFER,
+            config.memory_usage
         );
 
         ST_ASSERT_THROW_VK(
-            device.bind_buffer_memory(buffer, memory),
-            "Could not bind buffer memory [" << memory_name << "]"
+            device.bind_buffer_memory(buffer, allocation.memory, allocation.offset),
+            "Could not bind buffer memory [" << config.name << "]"
         );
     }
 
     void VulkanBuffer::free_memory() const {
-        if (memory != nullptr) {
-            config.device->free_memory(memory);
+        if (allocation) {
+            config.device->get_memory_allocator().free(allocation);
         }
     }
 }
@@ -10,6 +10,7 @@ namespace Storytime {
         VkDeviceSize size = 0;
         VkBufferUsageFlags usage = 0;
         VkMemoryPropertyFlags memory_properties = 0;
+        VulkanMemoryUsage memory_usage = VulkanMemoryUsage::PERSISTENT;
 
         const VulkanBufferConfig& assert_valid() const {
             ST_ASSERT_NOT_NULL(device);
@@ -25,7 +26,7 @@ namespace Storytime {
     private:
         Config config{};
         VkBuffer buffer = nullptr;
-        VkDeviceMemory memory = nullptr;
+        VulkanAllocation allocation{};
         void* data = nullptr;
 
     public:
@@ -49,10 +50,22 @@ namespace Storytime {
 
         void unmap_memory() const;
 
+        VkDeviceSize get_size() const;
+
+        void* get_data() const;
+
         void set_data(const void* src) const;
 
+        void set_data(const void* src, VkDeviceSize size, VkDeviceSize offset = 0) const;
+
+        /// Copy the data into the device's staging ring and record a copy from there into the buffer, for buffers that
+        /// are not host visible.
+        void stage_data(const VulkanCommandBuffer& command_buffer, const void* src, VkDeviceSize size, VkDeviceSize offset = 0) const;
+
         void copy_data(const VulkanCommandBuffer& command_buffer, VkBuffer destination_buffer) const;
 
+        void copy_data(const VulkanCommandBuffer& command_buffer, VkBuffer destination_buffer, VkDeviceSize size, VkDeviceSize offset = 0) const;
+
     private:
         void create_buffer();
 
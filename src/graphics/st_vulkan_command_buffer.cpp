@@ -263,6 +263,24 @@ namespace Storytime {
         );
     }
 
+    void VulkanCommandBuffer::draw_indexed_indirect(const DrawIndexedIndirectCommand& command) const {
+        vkCmdDrawIndexedIndirect(
+            command_buffer,
+            command.buffer,
+            command.offset,
+            command.draw_count,
+            command.stride
+        );
+    }
+
+    void VulkanCommandBuffer::reset_query_pool(VkQueryPool query_pool, u32 first_query, u32 query_count) const {
+        vkCmdResetQueryPool(command_buffer, query_pool, first_query, query_count);
+    }
+
+    void VulkanCommandBuffer::write_timestamp(VkPipelineStageFlagBits pipeline_stage, VkQueryPool query_pool, u32 query) const {
+        vkCmdWriteTimestamp(command_buffer, pipeline_stage, query_pool, query);
+    }
+
     void VulkanCommandBuffer::bind_vertex_buffers(const BindVertexBuffersCommand& command) const {
         vkCmdBindVertexBuffers(
             command_buffer,
@@ -474,6 +492,34 @@ namespace Storytime {
         );
     }
 
+    void VulkanCommandBuffer::copy_image_to_buffer(const CopyImageToBufferCommand& command) const {
+        vkCmdCopyImageToBuffer(
+            command_buffer,
+            command.src_image,
+            command.src_image_layout,
+            command.dst_buffer,
+            command.copy_region_count,
+            command.copy_region
+        );
+    }
+
+    void VulkanCommandBuffer::copy_image_to_buffer(
+        VkImage src_image,
+        VkImageLayout src_image_layout,
+        VkBuffer dst_buffer,
+        u32 copy_region_count,
+        const VkBufferImageCopy* copy_region
+    ) const {
+        vkCmdCopyImageToBuffer(
+            command_buffer,
+            src_image,
+            src_image_layout,
+            dst_buffer,
+            copy_region_count,
+            copy_region
+        );
+    }
+
     void VulkanCommandBuffer::blit_image(const BlitImageCommand& command) const {
         vkCmdBlitImage(
             command_buffer,
@@ -151,6 +151,19 @@ namespace Storytime {
             u32 first_instance
         ) const;
 
+        struct DrawIndexedIndirectCommand {
+            VkBuffer buffer = nullptr;
+            VkDeviceSize offset = 0;
+            u32 draw_count = 0;
+            u32 stride = sizeof(VkDrawIndexedIndirectCommand);
+        };
+
+        void draw_indexed_indirect(const DrawIndexedIndirectCommand& command) const;
+
+        void reset_query_pool(VkQueryPool query_pool, u32 first_query, u32 query_count) const;
+
+        void write_timestamp(VkPipelineStageFlagBits pipeline_stage, VkQueryPool query_pool, u32 query) const;
+
         struct BindVertexBuffersCommand {
             u32 first_binding = 0;
             u32 binding_count = 0;
@@ -278,6 +291,24 @@ namespace Storytime {
             const VkBufferImageCopy* copy_region
         ) const;
 
+        struct CopyImageToBufferCommand {
+            VkImage src_image = nullptr;
+            VkImageLayout src_image_layout = VK_IMAGE_LAYOUT_MAX_ENUM;
+            VkBuffer dst_buffer = nullptr;
+            u32 copy_region_count = 0;
+            const VkBufferImageCopy* copy_region = nullptr;
+        };
+
+        void copy_image_to_buffer(const CopyImageToBufferCommand& command) const;
+
+        void copy_image_to_buffer(
+            VkImage src_image,
+            VkImageLayout src_image_layout,
+            VkBuffer dst_buffer,
+            u32 copy_region_count,
+            const VkBufferImageCopy* copy_region
+        ) const;
+
         struct BlitImageCommand {
             VkImage src_image;
             VkImageLayout src_image_layout;
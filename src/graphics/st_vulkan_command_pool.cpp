@@ -1,6 +1,7 @@
 #include "st_vulkan_command_pool.h"
 #include "graphics/st_vulkan_command_buffer.h"
 #include "graphics/st_vulkan_queue.h"
+#include "graphics/st_vulkan_staging_ring.h"
 
 namespace Storytime {
     VulkanCommandPool::VulkanCommandPool(const Config& config) : config(config) {
@@ -65,6 +66,8 @@ namespace Storytime {
         VkQueue queue = config.device.get_queue(config.queue_family_index);
         VulkanCommandBuffer(command_buffer).end_one_time_submit(queue, config.device);
         free_command_buffer(command_buffer);
+        // The queue is idle after a one time submit, so the staging memory the commands copied from can be reused.
+        config.device.get_staging_ring().end_uploads();
     }
 
     void VulkanCommandPool::record_and_submit_commands(const RecordCommandsFn& record_commands) const {
@@ -63,11 +63,15 @@ namespace Storytime {
             create_debug_messenger(debug_messenger_create_info);
         }
 
-        create_surface();
+        if (!config.headless) {
+            create_surface();
+        }
     }
 
     VulkanContext::~VulkanContext() {
-        destroy_surface();
+        if (surface != nullptr) {
+            destroy_surface();
+        }
         if (config.validation_layers_enabled) {
             destroy_debug_messenger();
         }
@@ -136,9 +140,12 @@ namespace Storytime {
     }
 
     std::vector<const char*> VulkanContext::get_enabled_instance_extensions() const {
-        u32 extension_count = 0;
-        const char** extension_names = glfwGetRequiredInstanceExtensions(&extension_count);
-        std::vector<const char*> extensions(extension_names, extension_names + extension_count);
+        std::vector<const char*> extensions;
+        if (!config.headless) {
+            u32 extension_count = 0;
+            const char** extension_names = glfwGetRequiredInstanceExtensions(&extension_count);
+            extensions.assign(extension_names, extension_names + extension_count);
+        }
 
 #ifdef ST_PLATFORM_MACOS
         extensions.push_back(VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME);
@@ -14,6 +14,10 @@ namespace Storytime {
         u32 engine_version = VK_MAKE_API_VERSION(0, 1, 0, 0);
         bool validation_layers_enabled = false;
 
+        /// Create the instance without the window system extensions and without a surface, for rendering to
+        /// offscreen images only.
+        bool headless = false;
+
         const VulkanContextConfig& assert_valid() const {
             ST_ASSERT_NOT_NULL(window);
             return *this;
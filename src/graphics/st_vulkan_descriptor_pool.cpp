@@ -54,6 +54,7 @@ namespace Storytime {
         descriptor_pool_create_info.poolSizeCount = config.descriptor_pool_sizes.size();
         descriptor_pool_create_info.pPoolSizes = config.descriptor_pool_sizes.data();
         descriptor_pool_create_info.maxSets = config.max_descriptor_sets;
+        descriptor_pool_create_info.flags = config.flags;
 
         ST_ASSERT_THROW_VK(
             config.device.create_descriptor_pool(descriptor_pool_create_info, &descriptor_pool, config.name),
@@ -8,6 +8,7 @@ namespace Storytime {
         const VulkanDevice& device;
         u32 max_descriptor_sets = 0;
         std::vector<VkDescriptorPoolSize> descriptor_pool_sizes{};
+        VkDescriptorPoolCreateFlags flags = 0;
 
         const VulkanDescriptorPoolConfig& assert_valid() const {
             ST_ASSERT_GREATER_THAN_ZERO(max_descriptor_sets);
@@ -1,11 +1,22 @@
 #include "st_vulkan_device.h"
 
+#include "graphics/st_vulkan_staging_ring.h"
+
+#include <fstream>
+
 namespace Storytime {
     VulkanDevice::VulkanDevice(const Config& config) : config(config) {
         create_device();
+        create_pipeline_cache();
+        create_memory_allocator();
+        create_staging_ring();
     }
 
     VulkanDevice::~VulkanDevice() {
+        staging_ring = nullptr;
+        memory_allocator = nullptr;
+        save_pipeline_cache();
+        destroy_pipeline_cache();
         destroy_device();
     }
 
@@ -17,6 +28,22 @@ namespace Storytime {
         return config.physical_device;
     }
 
+    bool VulkanDevice::is_descriptor_indexing_enabled() const {
+        return descriptor_indexing_enabled;
+    }
+
+    VkPipelineCache VulkanDevice::get_pipeline_cache() const {
+        return pipeline_cache;
+    }
+
+    VulkanMemoryAllocator& VulkanDevice::get_memory_allocator() const {
+        return *memory_allocator;
+    }
+
+    VulkanStagingRing& VulkanDevice::get_staging_ring() const {
+        return *staging_ring;
+    }
+
     u32 VulkanDevice::get_graphics_queue_family_index() const {
         return get_physical_device().get_graphics_queue_family_index();
     }
@@ -25,6 +52,10 @@ namespace Storytime {
         return get_physical_device().get_present_queue_family_index();
     }
 
+    u32 VulkanDevice::get_transfer_queue_family_index() const {
+        return get_physical_device().get_transfer_queue_family_index();
+    }
+
     VkQueue VulkanDevice::get_graphics_queue() const {
         return get_queue(get_graphics_queue_family_index());
     }
@@ -33,6 +64,10 @@ namespace Storytime {
         return get_queue(get_present_queue_family_index());
     }
 
+    VkQueue VulkanDevice::get_transfer_queue() const {
+        return get_queue(get_transfer_queue_family_index());
+    }
+
     VkQueue VulkanDevice::get_queue(u32 queue_family_index, u32 queue_index) const {
         VkQueue queue;
         get_queue(queue_family_index, queue_index, &queue);
@@ -253,6 +288,15 @@ namespace Storytime {
         return wait_for_fences(fence_count, &fence, wait_for_all, wait_timeout);
     }
 
+    VkResult VulkanDevice::get_fence_status(VkFence fence) const {
+        ST_ASSERT_NOT_NULL(fence);
+        VkResult result = vkGetFenceStatus(device, fence);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) {
+            ST_LOG_E("Could not get fence status: {}", format_vk_result(result));
+        }
+        return result;
+    }
+
     VkResult VulkanDevice::reset_fences(const ResetFencesConfig& config) const {
         return reset_fences(config.fence_count, config.fences);
     }
@@ -294,7 +338,6 @@ namespace Storytime {
     VkResult VulkanDevice::create_graphics_pipelines(u32 pipeline_count, const VkGraphicsPipelineCreateInfo* graphics_pipeline_create_infos, VkPipeline* graphics_pipelines) const {
         ST_ASSERT_GREATER_THAN_ZERO(pipeline_count);
         ST_ASSERT_NOT_NULL(graphics_pipeline_create_infos);
-        constexpr VkPipelineCache pipeline_cache = nullptr;
         VkResult result = vkCreateGraphicsPipelines(device, pipeline_cache, pipeline_count, graphics_pipeline_create_infos, ST_VK_ALLOCATOR, graphics_pipelines);
         if (result != VK_SUCCESS) {
             ST_LOG_E("Could not create [{}] graphics pipelines: {}", pipeline_count, format_vk_result(result));
@@ -573,6 +616,33 @@ namespace Storytime {
         vkDestroySampler(device, sampler, ST_VK_ALLOCATOR);
     }
 
+    VkResult VulkanDevice::create_query_pool(const VkQueryPoolCreateInfo& query_pool_create_info, VkQueryPool* query_pool, std::string_view name) const {
+        VkResult result = vkCreateQueryPool(device, &query_pool_create_info, ST_VK_ALLOCATOR, query_pool);
+        if (result != VK_SUCCESS) {
+            ST_LOG_E("Could not create query pool [{}]: {}", name, format_vk_result(result));
+            return result;
+        }
+        if (!name.empty()) {
+            VkResult name_result = set_object_name(*query_pool, VK_OBJECT_TYPE_QUERY_POOL, name.data());
+            if (name_result != VK_SUCCESS) {
+                ST_LOG_E("Could not set query pool name [{}]: {}", name, format_vk_result(name_result));
+            }
+        }
+        return result;
+    }
+
+    void VulkanDevice::destroy_query_pool(VkQueryPool query_pool) const {
+        vkDestroyQueryPool(device, query_pool, ST_VK_ALLOCATOR);
+    }
+
+    VkResult VulkanDevice::get_query_pool_results(VkQueryPool query_pool, u32 first_query, u32 query_count, u64 data_size, void* data, VkDeviceSize stride, VkQueryResultFlags flags) const {
+        VkResult result = vkGetQueryPoolResults(device, query_pool, first_query, query_count, data_size, data, stride, flags);
+        if (result != VK_SUCCESS && result != VK_NOT_READY) {
+            ST_LOG_E("Could not get results of [{}] queries from query pool: {}", query_count, format_vk_result(result));
+        }
+        return result;
+    }
+
     VkResult VulkanDevice::wait_until_idle() const {
         VkResult result = vkDeviceWaitIdle(device);
         if (result != VK_SUCCESS) {
@@ -713,8 +783,29 @@ namespace Storytime {
         const std::vector<const char*>& enabled_extensions = config.physical_device.enabled_extensions;
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos = get_queue_create_infos();
 
+        // Enable the descriptor indexing features (core in Vulkan 1.2) if they have been requested. If they are not
+        // supported by the physical device, the device is created without them and users must fall back to not
+        // using descriptor indexing.
+        VkPhysicalDeviceVulkan12Features enabled_vulkan_12_features{};
+        enabled_vulkan_12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+        descriptor_indexing_enabled = false;
+        if (config.descriptor_indexing_enabled) {
+            if (config.physical_device.supports_descriptor_indexing()) {
+                enabled_vulkan_12_features.runtimeDescriptorArray = VK_TRUE;
+                enabled_vulkan_12_features.descriptorBindingPartiallyBound = VK_TRUE;
+                enabled_vulkan_12_features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+                enabled_vulkan_12_features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+                enabled_vulkan_12_features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+                descriptor_indexing_enabled = true;
+            } else {
+                ST_LOG_W("Descriptor indexing was requested for device [{}] but is not supported by the physical device", config.name);
+            }
+        }
+
         VkDeviceCreateInfo device_create_info{};
         device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        device_create_info.pNext = descriptor_indexing_enabled ? &enabled_vulkan_12_features : nullptr;
         device_create_info.pEnabledFeatures = &enabled_features;
         device_create_info.enabledExtensionCount = (u32) enabled_extensions.size();
         device_create_info.ppEnabledExtensionNames = enabled_extensions.data();
@@ -742,16 +833,142 @@ namespace Storytime {
         if (present_queue_name_result != VK_SUCCESS) {
             ST_LOG_E("Could not set present queue name [{}]: {}", present_queue_name, format_vk_result(present_queue_name_result));
         }
+
+        if (config.physical_device.has_transfer_queue_family()) {
+            std::string transfer_queue_name = std::format("{} transfer queue", config.name);
+            VkResult transfer_queue_name_result = set_object_name(get_transfer_queue(), VK_OBJECT_TYPE_QUEUE, transfer_queue_name.c_str());
+            if (transfer_queue_name_result != VK_SUCCESS) {
+                ST_LOG_E("Could not set transfer queue name [{}]: {}", transfer_queue_name, format_vk_result(transfer_queue_name_result));
+            }
+        }
     }
 
     void VulkanDevice::destroy_device() const {
         vkDestroyDevice(device, ST_VK_ALLOCATOR);
     }
 
+    void VulkanDevice::create_memory_allocator() {
+        memory_allocator = std::make_unique<VulkanMemoryAllocator>(VulkanMemoryAllocator::Config{
+            .device = *this,
+            .name = std::format("{} memory allocator", config.name),
+        });
+    }
+
+    void VulkanDevice::create_staging_ring() {
+        staging_ring = std::make_unique<VulkanStagingRing>(VulkanStagingRing::Config{
+            .device = this,
+            .name = std::format("{} staging ring", config.name),
+            .size = config.staging_ring_size,
+        });
+    }
+
+    void VulkanDevice::create_pipeline_cache() {
+        std::vector<char> pipeline_cache_data = read_pipeline_cache_data();
+
+        VkPipelineCacheCreateInfo pipeline_cache_create_info{};
+        pipeline_cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        pipeline_cache_create_info.initialDataSize = pipeline_cache_data.size();
+        pipeline_cache_create_info.pInitialData = pipeline_cache_data.empty() ? nullptr : pipeline_cache_data.data();
+
+        VkResult result = vkCreatePipelineCache(device, &pipeline_cache_create_info, ST_VK_ALLOCATOR, &pipeline_cache);
+        if (result != VK_SUCCESS) {
+            ST_THROW("Could not create pipeline cache for device [" << config.name << "]: " << format_vk_result(result));
+        }
+
+        std::string pipeline_cache_name = std::format("{} pipeline cache", config.name);
+        VkResult name_result = set_object_name(pipeline_cache, VK_OBJECT_TYPE_PIPELINE_CACHE, pipeline_cache_name.c_str());
+        if (name_result != VK_SUCCESS) {
+            ST_LOG_E("Could not set pipeline cache name [{}]: {}", pipeline_cache_name, format_vk_result(name_result));
+        }
+    }
+
+    void VulkanDevice::destroy_pipeline_cache() const {
+        vkDestroyPipelineCache(device, pipeline_cache, ST_VK_ALLOCATOR);
+    }
+
+    void VulkanDevice::save_pipeline_cache() const {
+        const std::filesystem::path& path = config.pipeline_cache_file_path;
+        if (path.empty()) {
+            return;
+        }
+
+        size_t data_size = 0;
+        VkResult result = vkGetPipelineCacheData(device, pipeline_cache, &data_size, nullptr);
+        if (result != VK_SUCCESS) {
+            ST_LOG_E("Could not get pipeline cache data size: {}", format_vk_result(result));
+            return;
+        }
+        if (data_size == 0) {
+            return;
+        }
+        std::vector<char> data(data_size);
+        result = vkGetPipelineCacheData(device, pipeline_cache, &data_size, data.data());
+        if (result != VK_SUCCESS) {
+            ST_LOG_E("Could not get pipeline cache data: {}", format_vk_result(result));
+            return;
+        }
+
+        std::error_code error;
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), error);
+            if (error) {
+                ST_LOG_E("Could not create pipeline cache directory [{}]: {}", path.parent_path().string(), error.message());
+                return;
+            }
+        }
+
+        std::ofstream file{path, std::ios::out | std::ios::binary | std::ios::trunc};
+        if (!file.is_open()) {
+            ST_LOG_E("Could not open pipeline cache file [{}]", path.string());
+            return;
+        }
+        file.write(data.data(), (std::streamsize) data_size);
+        ST_LOG_D("Wrote [{}] bytes of pipeline cache data to [{}]", data_size, path.string());
+    }
+
+    std::vector<char> VulkanDevice::read_pipeline_cache_data() const {
+        const std::filesystem::path& path = config.pipeline_cache_file_path;
+        if (path.empty() || !std::filesystem::exists(path)) {
+            return {};
+        }
+        std::ifstream file{path, std::ios::ate | std::ios::binary};
+        if (!file.is_open()) {
+            ST_LOG_W("Could not open pipeline cache file [{}]", path.string());
+            return {};
+        }
+        auto file_size = (size_t) file.tellg();
+        std::vector<char> data(file_size);
+        file.seekg(0);
+        file.read(data.data(), (std::streamsize) file_size);
+        if (!is_pipeline_cache_data_valid(data)) {
+            ST_LOG_W("Discarding pipeline cache file [{}] written by a different device or driver", path.string());
+            return {};
+        }
+        ST_LOG_D("Read [{}] bytes of pipeline cache data from [{}]", file_size, path.string());
+        return data;
+    }
+
+    bool VulkanDevice::is_pipeline_cache_data_valid(const std::vector<char>& pipeline_cache_data) const {
+        if (pipeline_cache_data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+            return false;
+        }
+        // The data may not be suitably aligned for the header struct, so copy it out.
+        VkPipelineCacheHeaderVersionOne header{};
+        memcpy(&header, pipeline_cache_data.data(), sizeof(VkPipelineCacheHeaderVersionOne));
+
+        VkPhysicalDeviceProperties properties = config.physical_device.get_properties();
+        return header.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)
+            && header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            && header.vendorID == properties.vendorID
+            && header.deviceID == properties.deviceID
+            && memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
     std::vector<VkDeviceQueueCreateInfo> VulkanDevice::get_queue_create_infos() const {
         std::set<u32> queue_families = {
             config.physical_device.get_graphics_queue_family_index(),
             config.physical_device.get_present_queue_family_index(),
+            config.physical_device.get_transfer_queue_family_index(),
         };
 
         std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
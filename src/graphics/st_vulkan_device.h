@@ -1,13 +1,22 @@
 #pragma once
 
+#include "graphics/st_vulkan_memory_allocator.h"
 #include "graphics/st_vulkan_physical_device.h"
 
 namespace Storytime {
     struct VulkanDeviceConfig {
         std::string name = "VulkanDevice";
         const VulkanPhysicalDevice& physical_device;
+        bool descriptor_indexing_enabled = false;
+        /// File to seed the pipeline cache from at startup and to write it back to on shutdown. The cache is kept in
+        /// memory only when empty.
+        std::filesystem::path pipeline_cache_file_path = "";
+        /// Size of the staging ring that uploads to device local memory go through.
+        VkDeviceSize staging_ring_size = 32 * 1024 * 1024;
     };
 
+    class VulkanStagingRing;
+
     class VulkanDevice {
     public:
         typedef VulkanDeviceConfig Config;
@@ -17,6 +26,10 @@ namespace Storytime {
         VkDevice device = nullptr;
         VkQueue graphics_queue = nullptr;
         VkQueue present_queue = nullptr;
+        VkPipelineCache pipeline_cache = nullptr;
+        Unique<VulkanMemoryAllocator> memory_allocator = nullptr;
+        Unique<VulkanStagingRing> staging_ring = nullptr;
+        bool descriptor_indexing_enabled = false;
 
     public:
         VulkanDevice(const Config& config);
@@ -27,14 +40,33 @@ namespace Storytime {
 
         const VulkanPhysicalDevice& get_physical_device() const;
 
+        /// Whether the descriptor indexing features were requested and are supported by the physical device, and have
+        /// been enabled on the device.
+        bool is_descriptor_indexing_enabled() const;
+
+        /// The pipeline cache used when creating graphics pipelines. It is seeded from the pipeline cache file when
+        /// the file was written by the same device and driver.
+        VkPipelineCache get_pipeline_cache() const;
+
+        /// The allocator that buffers and images sub-allocate their memory from.
+        VulkanMemoryAllocator& get_memory_allocator() const;
+
+        /// The shared staging memory for uploads to device local buffers and images.
+        VulkanStagingRing& get_staging_ring() const;
+
         u32 get_graphics_queue_family_index() const;
 
         u32 get_present_queue_family_index() const;
 
+        u32 get_transfer_queue_family_index() const;
+
         VkQueue get_graphics_queue() const;
 
         VkQueue get_present_queue() const;
 
+        /// The queue of the dedicated transfer queue family, or the graphics queue if the device has none.
+        VkQueue get_transfer_queue() const;
+
         VkQueue get_queue(u32 queue_family_index, u32 queue_index = 0) const;
 
         void get_queue(u32 queue_family_index, u32 queue_index, VkQueue* queue) const;
@@ -107,6 +139,9 @@ namespace Storytime {
 
         VkResult wait_for_fence(VkFence fence, u64 wait_timeout) const;
 
+        /// VK_SUCCESS when the fence is signaled, VK_NOT_READY when it is not.
+        VkResult get_fence_status(VkFence fence) const;
+
         struct ResetFencesConfig {
             u32 fence_count = 0;
             VkFence* fences = nullptr;
@@ -237,6 +272,14 @@ namespace Storytime {
 
         void destroy_sampler(VkSampler sampler) const;
 
+        VkResult create_query_pool(const VkQueryPoolCreateInfo& query_pool_create_info, VkQueryPool* query_pool, std::string_view name = "") const;
+
+        void destroy_query_pool(VkQueryPool query_pool) const;
+
+        /// VK_NOT_READY when the results of some of the queries are not available, unless they are requested with
+        /// VK_QUERY_RESULT_WAIT_BIT, VK_QUERY_RESULT_WITH_AVAILABILITY_BIT or VK_QUERY_RESULT_PARTIAL_BIT.
+        VkResult get_query_pool_results(VkQueryPool query_pool, u32 first_query, u32 query_count, u64 data_size, void* data, VkDeviceSize stride, VkQueryResultFlags flags) const;
+
         VkResult wait_until_idle() const;
 
         VkResult wait_until_queue_idle(VkQueue queue) const;
@@ -274,6 +317,20 @@ namespace Storytime {
 
         void destroy_device() const;
 
+        void create_memory_allocator();
+
+        void create_staging_ring();
+
+        void create_pipeline_cache();
+
+        void destroy_pipeline_cache() const;
+
+        void save_pipeline_cache() const;
+
+        std::vector<char> read_pipeline_cache_data() const;
+
+        bool is_pipeline_cache_data_valid(const std::vector<char>& pipeline_cache_data) const;
+
         std::vector<VkDeviceQueueCreateInfo> get_queue_create_infos() const;
     };
 }
@@ -94,9 +94,9 @@ namespace Storytime {
 
         VkPipelineDepthStencilStateCreateInfo depth_stencil_state_create_info{};
         depth_stencil_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        depth_stencil_state_create_info.depthTestEnable = VK_TRUE; // Specifies if the depth of new fragments should be compared to the depth buffer to see if they should be discarded
-        depth_stencil_state_create_info.depthWriteEnable = VK_TRUE; // Specifies if the new depth of fragments that pass the depth test should actually be written to the depth buffer.
-        depth_stencil_state_create_info.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL; // Specifies the comparison that is performed to keep or discard fragments. We are using lower depth = closer, so the depth of new fragments should be less.
+        depth_stencil_state_create_info.depthTestEnable = config.depth_test_enabled ? VK_TRUE : VK_FALSE; // Specifies if the depth of new fragments should be compared to the depth buffer to see if they should be discarded
+        depth_stencil_state_create_info.depthWriteEnable = config.depth_write_enabled ? VK_TRUE : VK_FALSE; // Specifies if the new depth of fragments that pass the depth test should actually be written to the depth buffer.
+        depth_stencil_state_create_info.depthCompareOp = config.depth_compare_op; // Specifies the comparison that is performed to keep or discard fragments. We are using lower depth = closer, so the depth of new fragments should be less.
         depth_stencil_state_create_info.depthBoundsTestEnable = VK_FALSE; // Allows us to only keep fragments that fall within the specified depth range.
         depth_stencil_state_create_info.minDepthBounds = 0.0f; // Used for the optional depth bound test.
         depth_stencil_state_create_info.maxDepthBounds = 1.0f; // Used for the optional depth bound test.
@@ -106,8 +106,8 @@ namespace Storytime {
 
         VkPipelineColorBlendAttachmentState color_blend_attachment_state{};
         color_blend_attachment_state.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-        color_blend_attachment_state.blendEnable = VK_TRUE;
-        color_blend_attachment_state.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        color_blend_attachment_state.blendEnable = config.blend_enabled ? VK_TRUE : VK_FALSE;
+        color_blend_attachment_state.srcColorBlendFactor = config.premultiplied_alpha ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_SRC_ALPHA;
         color_blend_attachment_state.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
         color_blend_attachment_state.colorBlendOp = VK_BLEND_OP_ADD;
         color_blend_attachment_state.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
@@ -14,6 +14,26 @@ namespace Storytime {
         std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions{};
         std::vector<VkVertexInputAttributeDescription> vertex_input_attribute_descriptions{};
 
+        /// Whether fragments are alpha blended with the color attachment. Pipelines for opaque geometry disable
+        /// blending, so the fragments simply replace what's behind them.
+        bool blend_enabled = true;
+
+        /// Whether the color of the fragments has already been multiplied by their alpha, so they are blended with
+        /// (ONE, ONE_MINUS_SRC_ALPHA) instead of (SRC_ALPHA, ONE_MINUS_SRC_ALPHA).
+        bool premultiplied_alpha = false;
+
+        /// Whether fragments are compared to the depth attachment at all. Fullscreen passes that copy one image to
+        /// another don't need depth testing.
+        bool depth_test_enabled = true;
+
+        /// Whether fragments that pass the depth test write their depth. Translucent geometry should be depth tested
+        /// without writing depth, so that geometry which is drawn after it (and behind it) is still blended with it.
+        bool depth_write_enabled = true;
+
+        /// How fragments are compared to the depth attachment. With a non-strict comparison, the last fragment that is
+        /// drawn at a depth is kept.
+        VkCompareOp depth_compare_op = VK_COMPARE_OP_LESS_OR_EQUAL;
+
         const VulkanGraphicsPipelineConfig& assert_valid() const {
             ST_ASSERT_NOT_NULL(render_pass);
             return *this;
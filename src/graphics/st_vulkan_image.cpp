@@ -1,11 +1,17 @@
 #include "st_vulkan_image.h"
 
 #include "graphics/st_vulkan_buffer.h"
+#include "graphics/st_vulkan_staging_ring.h"
 
 #include <stb_image.h>
 
 namespace Storytime {
-    VulkanImage::VulkanImage(const Config& config) : config(config.assert_valid()) {
+    std::atomic<u32> VulkanImage::next_id = 1;
+
+    VulkanImage::VulkanImage(const Config& config)
+        : config(config.assert_valid()),
+          id(next_id.fetch_add(1, std::memory_order_relaxed))
+    {
         create_image();
         allocate_memory();
         create_image_view();
@@ -19,24 +25,37 @@ namespace Storytime {
 
     VulkanImage::VulkanImage(VulkanImage&& other) noexcept
         : config(std::move(other.config)),
+          id(other.id),
+          descriptor_index(other.descriptor_index),
           image(other.image),
           image_view(other.image_view),
-          memory(other.memory)
+          allocation(other.allocation),
+          ready(other.ready)
     {
+        other.id = 0;
         other.image = nullptr;
         other.image_view = nullptr;
-        other.memory = nullptr;
+        other.allocation = {};
     }
 
     VulkanImage& VulkanImage::operator=(VulkanImage&& other) noexcept {
         if (this != &other) {
+            // Release the image that is being replaced, so that assigning a new image doesn't leak it. It must no
+            // longer be in use by the device.
+            destroy_image_view();
+            free_memory();
+            destroy_image();
             config = std::move(other.config);
+            id = other.id;
+            descriptor_index = other.descriptor_index;
             image = other.image;
             image_view = other.image_view;
-            memory = other.memory;
+            allocation = other.allocation;
+            ready = other.ready;
+            other.id = 0;
             other.image = nullptr;
             other.image_view = nullptr;
-            other.memory = nullptr;
+            other.allocation = {};
         }
         return *this;
     }
@@ -45,6 +64,22 @@ namespace Storytime {
         return image;
     }
 
+    u32 VulkanImage::get_id() const {
+        return id;
+    }
+
+    const std::string& VulkanImage::get_name() const {
+        return config.name;
+    }
+
+    u32 VulkanImage::get_descriptor_index() const {
+        return descriptor_index;
+    }
+
+    void VulkanImage::set_descriptor_index(u32 descriptor_index) {
+        this->descriptor_index = descriptor_index;
+    }
+
     u32 VulkanImage::get_width() const {
         return config.width;
     }
@@ -61,40 +96,22 @@ namespace Storytime {
         return config.format;
     }
 
-    void VulkanImage::set_pixels(const OnRecordCommandsFn& on_record_commands, u64 pixel_data_size, const void* pixel_data) {
-        VulkanBuffer staging_buffer({
-            .device = config.device,
-            .name = std::format("{} staging buffer", config.name),
-            .size = pixel_data_size,
-            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        });
-
-        staging_buffer.map_memory();
-        staging_buffer.set_data(pixel_data);
-        staging_buffer.unmap_memory();
-
-        on_record_commands([&](const VulkanCommandBuffer& command_buffer) {
+    bool VulkanImage::is_premultiplied_alpha() const {
+        return config.premultiplied_alpha;
+    }
 
-            // Transition image to be a transfer destination so the buffer can be copied to it.
-            transition_layout(command_buffer, LayoutTransition{
-                .src_layout = VK_IMAGE_LAYOUT_UNDEFINED,
-                .dst_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                .src_access = 0, // Nothing to wait on.
-                .dst_access = VK_ACCESS_TRANSFER_WRITE_BIT, // The image will be written to.
-                .src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // Nothing to wait on, so start in earlies possible stage.
-                .dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT, // Make the image writable by the transfer stage.
-                .first_mip_level = 0,
-                .mip_level_count = config.mip_levels,
-            });
+    bool VulkanImage::is_ready() const {
+        return ready;
+    }
 
-            // Copy the staging buffer to the base image. The pixels will be copied to the mipmaps when they are generated.
-            copy_to_image(command_buffer, CopyToImage{
-                .buffer = staging_buffer,
-                .image_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // Promise that the image is now in this layout when the copy is executed.
-                .mip_level = 0, // Only copy to the base image.
-            });
+    void VulkanImage::set_ready(bool ready) {
+        this->ready = ready;
+    }
 
+    void VulkanImage::set_pixels(const OnRecordCommandsFn& on_record_commands, u64 pixel_data_size, const void* pixel_data) {
+        constexpr u32 mip_level = 0;
+        constexpr bool first_level = true;
+        copy_mip_level_pixels(on_record_commands, mip_level, pixel_data_size, pixel_data, first_level, [this](const VulkanCommandBuffer& command_buffer) {
             // Generate mipmap, and transition all mip levels in it to be ready to be sampled by the fragment shader.
             generate_mipmap(command_buffer, LayoutTransition{
                 .src_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
@@ -109,11 +126,172 @@ namespace Storytime {
         });
     }
 
+    void VulkanImage::set_mip_level_pixels(const OnRecordCommandsFn& on_record_commands, const std::vector<VulkanImageMipLevelPixels>& mip_levels) {
+        ST_ASSERT(mip_levels.size() == config.mip_levels, "Pixels must be given for all [" << config.mip_levels << "] mip levels of image [" << config.name << "]");
+
+        for (u32 mip_level = 0; mip_level < config.mip_levels; mip_level++) {
+            const VulkanImageMipLevelPixels& mip_level_pixels = mip_levels.at(mip_level);
+            bool first_level = mip_level == 0;
+            bool last_level = mip_level == config.mip_levels - 1;
+
+            copy_mip_level_pixels(on_record_commands, mip_level, mip_level_pixels.size, mip_level_pixels.data, first_level, [this, last_level](const VulkanCommandBuffer& command_buffer) {
+                if (!last_level) {
+                    return;
+                }
+                // Transition all mip levels to be ready to be sampled by the fragment shader.
+                transition_layout(command_buffer, LayoutTransition{
+                    .src_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                    .dst_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    .src_access = VK_ACCESS_TRANSFER_WRITE_BIT,
+                    .dst_access = VK_ACCESS_SHADER_READ_BIT,
+                    .src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+                    .dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                    .first_mip_level = 0,
+                    .mip_level_count = config.mip_levels,
+                });
+            });
+        }
+    }
+
+    void VulkanImage::copy_mip_level_pixels(
+        const OnRecordCommandsFn& on_record_commands,
+        u32 mip_level,
+        u64 pixel_data_size,
+        const void* pixel_data,
+        bool first_level,
+        const std::function<void(const VulkanCommandBuffer&)>& on_last_chunk
+    ) const {
+        // Pixels are always uploaded as four 8-bit channels (RGBA8), regardless of the channels of their source.
+        constexpr u32 bytes_per_pixel = 4;
+        u32 mip_level_width = std::max(config.width >> mip_level, 1u);
+        u32 mip_level_height = std::max(config.height >> mip_level, 1u);
+        ST_ASSERT(config.depth == 1, "Pixels can only be set on two-dimensional image [" << config.name << "]");
+        ST_ASSERT(pixel_data_size == (u64) mip_level_width * mip_level_height * bytes_per_pixel, "Pixel data of size [" << pixel_data_size << "] must have [" << bytes_per_pixel << "] bytes per pixel for mip level [" << mip_level << "] of size [" << mip_level_width << "x" << mip_level_height << "] of image [" << config.name << "]");
+
+        //
+        // Stage the pixels in the device's staging ring.
+        //
+        // Images that are larger than the ring are uploaded in chunks of rows. Every chunk is recorded and submitted
+        // separately, so that the ring can reuse the memory of a chunk once its copy has completed.
+        //
+
+        VulkanStagingRing& staging_ring = config.device->get_staging_ring();
+        VkDeviceSize row_size = pixel_data_size / mip_level_height;
+        ST_ASSERT(row_size <= staging_ring.get_size(), "A row of image [" << config.name << "] must fit in the staging ring");
+        u32 rows_per_chunk = (u32) std::min<VkDeviceSize>(mip_level_height, staging_ring.get_size() / row_size);
+
+        for (u32 first_row = 0; first_row < mip_level_height; first_row += rows_per_chunk) {
+            u32 row_count = std::min(rows_per_chunk, mip_level_height - first_row);
+            bool first_chunk = first_level && first_row == 0;
+            bool last_chunk = first_row + row_count == mip_level_height;
+
+            VulkanStagingRegion staging_region = staging_ring.stage((const u8*) pixel_data + first_row * row_size, row_count * row_size);
+
+            on_record_commands([&](const VulkanCommandBuffer& command_buffer) {
+
+                // Transition image to be a transfer destination so the buffer can be copied to it.
+                if (first_chunk) {
+                    transition_layout(command_buffer, LayoutTransition{
+                        .src_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+                        .dst_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                        .src_access = 0, // Nothing to wait on.
+                        .dst_access = VK_ACCESS_TRANSFER_WRITE_BIT, // The image will be written to.
+                        .src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, // Nothing to wait on, so start in earlies possible stage.
+                        .dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT, // Make the image writable by the transfer stage.
+                        .first_mip_level = 0,
+                        .mip_level_count = config.mip_levels,
+                    });
+                }
+
+                // Copy the staged rows to the mip level.
+                copy_to_image(command_buffer, CopyToImage{
+                    .buffer = staging_region.buffer,
+                    .buffer_offset = staging_region.offset,
+                    .first_row = first_row,
+                    .row_count = row_count,
+                    .image_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, // Promise that the image is now in this layout when the copy is executed.
+                    .mip_level = mip_level,
+                });
+
+                if (last_chunk) {
+                    on_last_chunk(command_buffer);
+                }
+            });
+        }
+    }
+
+    void VulkanImage::record_copy_pixels(const VulkanCommandBuffer& command_buffer, VkBuffer staging_buffer, VkDeviceSize staging_offset, u32 src_queue_family_index, u32 dst_queue_family_index) const {
+        transition_layout(command_buffer, LayoutTransition{
+            .src_layout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .dst_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .src_access = 0,
+            .dst_access = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            .dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .first_mip_level = 0,
+            .mip_level_count = config.mip_levels,
+        });
+
+        copy_to_image(command_buffer, CopyToImage{
+            .buffer = staging_buffer,
+            .buffer_offset = staging_offset,
+            .image_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .mip_level = 0,
+        });
+
+        if (src_queue_family_index == dst_queue_family_index) {
+            return;
+        }
+
+        // Release ownership of all mip levels to the other queue family. The layout is left as is, and the matching
+        // acquire in `record_generate_mipmap` makes the writes visible to the other queue.
+        transition_layout(command_buffer, LayoutTransition{
+            .src_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .dst_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .src_access = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dst_access = 0, // Ignored for releases.
+            .src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .dst_stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            .first_mip_level = 0,
+            .mip_level_count = config.mip_levels,
+            .src_queue_family_index = src_queue_family_index,
+            .dst_queue_family_index = dst_queue_family_index,
+        });
+    }
+
+    void VulkanImage::record_generate_mipmap(const VulkanCommandBuffer& command_buffer, u32 src_queue_family_index, u32 dst_queue_family_index) const {
+        if (src_queue_family_index != dst_queue_family_index) {
+            transition_layout(command_buffer, LayoutTransition{
+                .src_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .dst_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .src_access = 0, // Ignored for acquires.
+                .dst_access = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+                .src_stage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                .dst_stage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+                .first_mip_level = 0,
+                .mip_level_count = config.mip_levels,
+                .src_queue_family_index = src_queue_family_index,
+                .dst_queue_family_index = dst_queue_family_index,
+            });
+        }
+
+        generate_mipmap(command_buffer, LayoutTransition{
+            .src_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .dst_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            .src_access = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dst_access = VK_ACCESS_SHADER_READ_BIT,
+            .src_stage = VK_PIPELINE_STAGE_TRANSFER_BIT,
+            .dst_stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            .first_mip_level = 0,
+            .mip_level_count = config.mip_levels,
+        });
+    }
+
     void VulkanImage::transition_layout(const VulkanCommandBuffer& command_buffer, const LayoutTransition& layout_transition) const {
         VkImageMemoryBarrier image_memory_barrier{};
         image_memory_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        image_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        image_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_memory_barrier.srcQueueFamilyIndex = layout_transition.src_queue_family_index;
+        image_memory_barrier.dstQueueFamilyIndex = layout_transition.dst_queue_family_index;
         image_memory_barrier.image = image;
         image_memory_barrier.oldLayout = layout_transition.src_layout;
         image_memory_barrier.newLayout = layout_transition.dst_layout;
@@ -135,11 +313,14 @@ namespace Storytime {
 
     void VulkanImage::copy_to_image(const VulkanCommandBuffer& command_buffer, const CopyToImage& copy_to_image) const {
         VkBufferImageCopy copy_region{};
-        copy_region.bufferOffset = 0;
+        u32 mip_level_width = std::max(config.width >> copy_to_image.mip_level, 1u);
+        u32 mip_level_height = std::max(config.height >> copy_to_image.mip_level, 1u);
+        u32 row_count = copy_to_image.row_count > 0 ? copy_to_image.row_count : mip_level_height - copy_to_image.first_row;
+        copy_region.bufferOffset = copy_to_image.buffer_offset;
         copy_region.bufferRowLength = 0;
         copy_region.bufferImageHeight = 0;
-        copy_region.imageOffset = { 0, 0, 0 };
-        copy_region.imageExtent = { config.width, config.height, config.depth };
+        copy_region.imageOffset = { 0, (i32) copy_to_image.first_row, 0 };
+        copy_region.imageExtent = { mip_level_width, row_count, config.depth };
         copy_region.imageSubresource.aspectMask = config.aspect;
         copy_region.imageSubresource.mipLevel = copy_to_image.mip_level;
         copy_region.imageSubresource.baseArrayLayer = 0;
@@ -372,33 +553,24 @@ namespace Storytime {
 
     void VulkanImage::allocate_memory() {
         const VulkanDevice& device = *config.device;
-        const VulkanPhysicalDevice& physical_device = device.get_physical_device();
 
         VkMemoryRequirements memory_requirements = device.get_image_memory_requirements(image);
         VkMemoryPropertyFlags required_memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
-        i32 memory_type_index = physical_device.find_supported_memory_type(memory_requirements, required_memory_properties);
-
-        VkMemoryAllocateInfo memory_allocate_info{};
-        memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        memory_allocate_info.allocationSize = memory_requirements.size;
-        memory_allocate_info.memoryTypeIndex = memory_type_index;
-
-        std::string memory_name = std::format("{} memory", config.name);
-
-        ST_ASSERT_THROW_VK(
-            device.allocate_memory(memory_allocate_info, &memory, memory_name),
-            "Could not allocate image memory [" << memory_name << "]"
+        allocation = device.get_memory_allocator().allocate(
+            memory_requirements,
+            required_memory_properties,
+            VulkanMemoryResourceType::IMAGE
         );
 
         ST_ASSERT_THROW_VK(
-            device.bind_image_memory(image, memory),
-            "Could not bind image memory [" << memory_name << "]"
+            device.bind_image_memory(image, allocation.memory, allocation.offset),
+            "Could not bind image memory [" << config.name << "]"
         );
     }
 
     void VulkanImage::free_memory() const {
-        if (memory != nullptr) {
-            config.device->free_memory(memory);
+        if (allocation) {
+            config.device->get_memory_allocator().free(allocation);
         }
     }
 }
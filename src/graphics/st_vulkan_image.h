@@ -15,6 +15,7 @@ namespace Storytime {
         VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
         VkImageUsageFlags usage = 0;
         u32 mip_levels = 1;
+        bool premultiplied_alpha = false; /// Whether the color channels of the pixels are multiplied by their alpha.
 
         const VulkanImageConfig& assert_valid() const {
             ST_ASSERT_NOT_NULL(device);
@@ -24,16 +25,29 @@ namespace Storytime {
         }
     };
 
+    struct VulkanImageMipLevelPixels {
+        const void* data = nullptr;
+        u64 size = 0;
+    };
+
     class VulkanImage {
     public:
         typedef VulkanImageConfig Config;
 
+        static constexpr u32 no_descriptor_index = std::numeric_limits<u32>::max();
+
+    private:
+        static std::atomic<u32> next_id;
+
     private:
         Config config{};
+        u32 id = 0;
+        u32 descriptor_index = no_descriptor_index;
         VkImage image = nullptr;
         VkImageView image_view = nullptr;
-        VkDeviceMemory memory = nullptr;
+        VulkanAllocation allocation{};
         VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+        bool ready = true;
 
     public:
         VulkanImage() = default;
@@ -52,6 +66,18 @@ namespace Storytime {
 
         operator VkImage() const;
 
+        /// A process-wide unique and stable identifier for the image, assigned on creation. Zero is never assigned to
+        /// an image and can be used as an "invalid" identifier.
+        u32 get_id() const;
+
+        const std::string& get_name() const;
+
+        /// The persistent index of the image in a bindless descriptor array, or `no_descriptor_index` if the image has
+        /// not been added to one.
+        u32 get_descriptor_index() const;
+
+        void set_descriptor_index(u32 descriptor_index);
+
         u32 get_width() const;
 
         u32 get_height() const;
@@ -60,8 +86,29 @@ namespace Storytime {
 
         VkFormat get_format() const;
 
+        bool is_premultiplied_alpha() const;
+
+        /// Whether the pixels of the image have been uploaded and it can be sampled. Images that are being uploaded
+        /// asynchronously are not ready until the upload has completed, and the renderer draws them with its
+        /// placeholder texture until then.
+        bool is_ready() const;
+
+        void set_ready(bool ready);
+
         void set_pixels(const OnRecordCommandsFn& on_record_commands, u64 pixel_data_size, const void* pixel_data);
 
+        /// Set the pixels of every mip level from a precomputed mip chain, instead of generating it on the GPU.
+        void set_mip_level_pixels(const OnRecordCommandsFn& on_record_commands, const std::vector<VulkanImageMipLevelPixels>& mip_levels);
+
+        /// Record the first half of an asynchronous upload of staged pixels: the copy to the base image. When the queue
+        /// families differ, ownership of the image is released from the queue family that the commands are recorded for
+        /// to the queue family that will record `record_generate_mipmap`.
+        void record_copy_pixels(const VulkanCommandBuffer& command_buffer, VkBuffer staging_buffer, VkDeviceSize staging_offset, u32 src_queue_family_index, u32 dst_queue_family_index) const;
+
+        /// Record the second half of an asynchronous upload: acquiring ownership of the image when the queue families
+        /// differ, and generating its mipmap on a graphics queue so it's ready to be sampled by fragment shaders.
+        void record_generate_mipmap(const VulkanCommandBuffer& command_buffer, u32 src_queue_family_index, u32 dst_queue_family_index) const;
+
     private:
         struct LayoutTransition {
             VkImageLayout src_layout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -84,6 +131,10 @@ namespace Storytime {
 
             /// The number of mip levels the transition will be applied to, starting from the first mip level.
             u32 mip_level_count = 0; /// Defaults to the image's mip level count.
+
+            /// Queue families to transfer ownership between, when the image is used by queues of different families.
+            u32 src_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
+            u32 dst_queue_family_index = VK_QUEUE_FAMILY_IGNORED;
         };
 
         void transition_layout(const VulkanCommandBuffer& command_buffer, const LayoutTransition& layout_transition) const;
@@ -91,6 +142,13 @@ namespace Storytime {
         struct CopyToImage {
             VkBuffer buffer = nullptr;
 
+            /// The offset in the buffer where the pixels of the first row start.
+            VkDeviceSize buffer_offset = 0;
+
+            /// The rows of the image to copy to, for uploads that are split into chunks.
+            u32 first_row = 0;
+            u32 row_count = 0; /// Defaults to all rows from the first row.
+
             /// The layout that the image must have when the copy is executed.
             VkImageLayout image_layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
 
@@ -100,6 +158,15 @@ namespace Storytime {
 
         void copy_to_image(const VulkanCommandBuffer& command_buffer, const CopyToImage& copy_to_image) const;
 
+        void copy_mip_level_pixels(
+            const OnRecordCommandsFn& on_record_commands,
+            u32 mip_level,
+            u64 pixel_data_size,
+            const void* pixel_data,
+            bool first_level,
+            const std::function<void(const VulkanCommandBuffer&)>& on_last_chunk
+        ) const;
+
         void generate_mipmap(const VulkanCommandBuffer& command_buffer, const LayoutTransition& layout_transition) const;
 
         void create_image();
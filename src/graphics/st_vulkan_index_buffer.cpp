@@ -7,19 +7,16 @@ namespace Storytime {
         : config(config.assert_valid()),
           buffer(create_buffer())
     {
+        // Device local buffers that are copied to are uploaded through the device's staging ring, other buffers are
+        // host visible and written to directly.
         staging_buffer_enabled = is_staging_buffer_enabled();
-        if (staging_buffer_enabled) {
-            staging_buffer = create_staging_buffer();
-            staging_buffer.map_memory();
-        } else {
+        if (!staging_buffer_enabled) {
             buffer.map_memory();
         }
     }
 
     VulkanIndexBuffer::~VulkanIndexBuffer() {
-        if (staging_buffer_enabled) {
-            staging_buffer.unmap_memory();
-        } else {
+        if (!staging_buffer_enabled) {
             buffer.unmap_memory();
         }
     }
@@ -27,13 +24,13 @@ namespace Storytime {
     VulkanIndexBuffer::VulkanIndexBuffer(VulkanIndexBuffer&& other) noexcept
         : config(std::move(other.config)),
           buffer(std::move(other.buffer)),
-          staging_buffer(std::move(other.staging_buffer)) {}
+          staging_buffer_enabled(other.staging_buffer_enabled) {}
 
     VulkanIndexBuffer& VulkanIndexBuffer::operator=(VulkanIndexBuffer&& other) noexcept {
         if (this != &other) {
             config = std::move(other.config);
             buffer = std::move(other.buffer);
-            staging_buffer = std::move(other.staging_buffer);
+            staging_buffer_enabled = other.staging_buffer_enabled;
         }
         return *this;
     }
@@ -53,8 +50,17 @@ namespace Storytime {
 
     void VulkanIndexBuffer::set_data(const VulkanCommandBuffer& command_buffer, const void* data) const {
         ST_ASSERT(staging_buffer_enabled, "Staging buffer must be enabled when setting index data with a command buffer");
-        staging_buffer.set_data(data);
-        staging_buffer.copy_data(command_buffer, buffer);
+        buffer.stage_data(command_buffer, data, config.size);
+    }
+
+    void VulkanIndexBuffer::set_data(const void* data, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT(!staging_buffer_enabled, "Staging buffer must be disabled when setting index data without a command buffer");
+        buffer.set_data(data, size, offset);
+    }
+
+    void VulkanIndexBuffer::set_data(const VulkanCommandBuffer& command_buffer, const void* data, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT(staging_buffer_enabled, "Staging buffer must be enabled when setting index data with a command buffer");
+        buffer.stage_data(command_buffer, data, size, offset);
     }
 
     VulkanBuffer VulkanIndexBuffer::create_buffer() {
@@ -67,16 +73,6 @@ namespace Storytime {
         });
     }
 
-    VulkanBuffer VulkanIndexBuffer::create_staging_buffer() {
-        return VulkanBuffer({
-            .device = config.device,
-            .name = std::format("{} staging buffer", config.name),
-            .size = config.size,
-            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        });
-    }
-
     bool VulkanIndexBuffer::is_staging_buffer_enabled() const {
         bool primary_buffer_will_be_copied_to = config.usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         if (!primary_buffer_will_be_copied_to) {
@@ -28,7 +28,6 @@ namespace Storytime {
     private:
         Config config{};
         VulkanBuffer buffer{};
-        VulkanBuffer staging_buffer{};
         bool staging_buffer_enabled = false;
 
     public:
@@ -54,11 +53,13 @@ namespace Storytime {
 
         void set_data(const VulkanCommandBuffer& command_buffer, const void* data) const;
 
+        void set_data(const void* data, VkDeviceSize size, VkDeviceSize offset = 0) const;
+
+        void set_data(const VulkanCommandBuffer& command_buffer, const void* data, VkDeviceSize size, VkDeviceSize offset = 0) const;
+
     private:
         VulkanBuffer create_buffer();
 
-        VulkanBuffer create_staging_buffer();
-
         bool is_staging_buffer_enabled() const;
     };
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+#include "st_vulkan_memory_allocator.h"
+
+#include "graphics/st_vulkan_device.h"
+
+namespace Storytime {
+    static constexpr u32 resource_type_count = 2;
+    static constexpr u32 usage_count = 2;
+
+    static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+        return alignment > 0 ? (value + alignment - 1) / alignment * alignment : value;
+    }
+
+    VulkanMemoryAllocator::VulkanMemoryAllocator(const Config& config)
+        : config(config.assert_valid()),
+          memory_properties(config.device.get_physical_device().get_memory_properties()),
+          pools(memory_properties.memoryTypeCount * resource_type_count * usage_count)
+    {
+    }
+
+    VulkanMemoryAllocator::~VulkanMemoryAllocator() {
+        for (const Pool& pool : pools) {
+            for (const Unique<VulkanMemoryBlock>& block : pool.blocks) {
+                if (block->allocation_count > 0) {
+                    ST_LOG_W("Destroying memory block of [{}] with [{}] allocations that have not been freed", config.name, block->allocation_count);
+                }
+                destroy_block(*block);
+            }
+        }
+    }
+
+    VulkanAllocation VulkanMemoryAllocator::allocate(
+        const VkMemoryRequirements& memory_requirements,
+        VkMemoryPropertyFlags required_memory_properties,
+        VulkanMemoryResourceType resource_type,
+        VulkanMemoryUsage usage
+    ) {
+        ST_ASSERT_GREATER_THAN_ZERO(memory_requirements.size);
+        const VulkanPhysicalDevice& physical_device = config.device.get_physical_device();
+        u32 memory_type_index = (u32) physical_device.find_supported_memory_type(memory_requirements, required_memory_properties);
+        u32 pool_index = get_pool_index(memory_type_index, resource_type, usage);
+
+        VkDeviceSize size = memory_requirements.size;
+        VkDeviceSize alignment = memory_requirements.alignment;
+        VkDeviceSize block_size = get_block_size(usage);
+
+        std::lock_guard lock(mutex);
+
+        VulkanMemoryBlock* block = nullptr;
+        VkDeviceSize offset = 0;
+
+        // Resources that would take up most of a block get a block of their own, so they don't leave the rest of a
+        // block unusable.
+        if (size > block_size / 2) {
+            block = create_block(memory_type_index, pool_index, size, usage, true);
+            block->free_ranges.clear();
+            block->head = size;
+        } else {
+            for (const Unique<VulkanMemoryBlock>& candidate : pools.at(pool_index).blocks) {
+                if (!candidate->dedicated && allocate_from_block(*candidate, size, alignment, &offset)) {
+                    block = candidate.get();
+                    break;
+                }
+            }
+            if (block == nullptr) {
+                block = create_block(memory_type_index, pool_index, block_size, usage, false);
+                bool allocated = allocate_from_block(*block, size, alignment, &offset);
+                ST_ASSERT(allocated, "Allocation of size [" << size << "] must fit in a new memory block of size [" << block_size << "]");
+            }
+        }
+
+        block->used_size += size;
+        block->allocation_count++;
+
+        VulkanAllocation allocation{};
+        allocation.block = block;
+        allocation.memory = block->memory;
+        allocation.offset = offset;
+        allocation.size = size;
+        allocation.data = block->data != nullptr ? (u8*) block->data + offset : nullptr;
+        return allocation;
+    }
+
+    void VulkanMemoryAllocator::free(const VulkanAllocation& allocation) {
+        if (!allocation) {
+            return;
+        }
+        ST_ASSERT_NOT_NULL(allocation.block);
+
+        std::lock_guard lock(mutex);
+
+        VulkanMemoryBlock* block = allocation.block;
+        ST_ASSERT(block->allocation_count > 0, "Memory block must have allocations to free");
+        block->used_size -= allocation.size;
+        block->allocation_count--;
+
+        if (block->dedicated) {
+            release_block(block);
+            return;
+        }
+        if (block->usage == VulkanMemoryUsage::PERSISTENT) {
+            free_from_block(*block, allocation.offset, allocation.size);
+        }
+        if (block->allocation_count == 0) {
+            block->head = 0;
+            // Keep the last block of the pool around, so that a pool which is repeatedly emptied and refilled (like
+            // a pool of staging buffers) doesn't allocate and free device memory every time.
+            if (pools.at(block->pool_index).blocks.size() > 1) {
+                release_block(block);
+            }
+        }
+    }
+
+    VulkanMemoryStats VulkanMemoryAllocator::get_stats() const {
+        std::lock_guard lock(mutex);
+
+        VulkanMemoryStats stats{};
+        VkDeviceSize free_bytes = 0;
+        VkDeviceSize largest_free_range = 0;
+
+        for (const Pool& pool : pools) {
+            for (const Unique<VulkanMemoryBlock>& block : pool.blocks) {
+                stats.block_count++;
+                stats.dedicated_block_count += block->dedicated ? 1 : 0;
+                stats.allocation_count += block->allocation_count;
+                stats.reserved_bytes += block->size;
+                stats.used_bytes += block->used_size;
+                if (block->usage != VulkanMemoryUsage::PERSISTENT || block->dedicated) {
+                    continue;
+                }
+                for (const auto& [offset, size] : block->free_ranges) {
+                    free_bytes += size;
+                    largest_free_range = std::max(largest_free_range, size);
+                }
+            }
+        }
+
+        if (free_bytes > 0) {
+            stats.fragmentation = 1.0f - (f32) largest_free_range / (f32) free_bytes;
+        }
+        return stats;
+    }
+
+    u32 VulkanMemoryAllocator::get_pool_index(u32 memory_type_index, VulkanMemoryResourceType resource_type, VulkanMemoryUsage usage) const {
+        return (memory_type_index * resource_type_count + (u32) resource_type) * usage_count + (u32) usage;
+    }
+
+    VkDeviceSize VulkanMemoryAllocator::get_block_size(VulkanMemoryUsage usage) const {
+        return usage == VulkanMemoryUsage::TRANSIENT ? config.transient_block_size : config.persistent_block_size;
+    }
+
+    VulkanMemoryBlock* VulkanMemoryAllocator::create_block(u32 memory_type_index, u32 pool_index, VkDeviceSize size, VulkanMemoryUsage usage, bool dedicated) {
+        Pool& pool = pools.at(pool_index);
+
+        VkMemoryAllocateInfo memory_allocate_info{};
+        memory_allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        memory_allocate_info.allocationSize = size;
+        memory_allocate_info.memoryTypeIndex = memory_type_index;
+
+        std::string memory_name = std::format(
+            "{} {} block {} (memory type {})",
+            config.name,
+            usage == VulkanMemoryUsage::TRANSIENT ? "transient" : "persistent",
+            pool.blocks.size(),
+            memory_type_index
+        );
+
+        auto block = std::make_unique<VulkanMemoryBlock>();
+        block->size = size;
+        block->memory_type_index = memory_type_index;
+        block->pool_index = pool_index;
+        block->usage = usage;
+        block->dedicated = dedicated;
+        block->free_ranges.emplace(0, size);
+
+        ST_ASSERT_THROW_VK(
+            config.device.allocate_memory(memory_allocate_info, &block->memory, memory_name),
+            "Could not allocate memory block [" << memory_name << "] of size [" << size << "]"
+        );
+
+        // Host visible blocks are mapped for their whole lifetime, and allocations point into the mapping.
+        VkMemoryPropertyFlags property_flags = memory_properties.memoryTypes[memory_type_index].propertyFlags;
+        if (property_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+            constexpr VkDeviceSize offset = 0;
+            constexpr VkMemoryMapFlags flags = 0;
+            ST_ASSERT_THROW_VK(
+                config.device.map_memory(block->memory, offset, VK_WHOLE_SIZE, flags, &block->data),
+                "Could not map memory block [" << memory_name << "]"
+            );
+        }
+
+        ST_LOG_D("Allocated memory block [{}] of size [{}]", memory_name, size);
+
+        pool.blocks.push_back(std::move(block));
+        return pool.blocks.back().get();
+    }
+
+    void VulkanMemoryAllocator::destroy_block(const VulkanMemoryBlock& block) const {
+        if (block.data != nullptr) {
+            config.device.unmap_memory(block.memory);
+        }
+        config.device.free_memory(block.memory);
+    }
+
+    void VulkanMemoryAllocator::release_block(VulkanMemoryBlock* block) {
+        std::vector<Unique<VulkanMemoryBlock>>& blocks = pools.at(block->pool_index).blocks;
+        auto it = std::ranges::find_if(blocks, [block](const Unique<VulkanMemoryBlock>& candidate) {
+            return candidate.get() == block;
+        });
+        ST_ASSERT(it != blocks.end(), "Memory block must belong to its pool");
+        destroy_block(*block);
+        blocks.erase(it);
+    }
+
+    bool VulkanMemoryAllocator::allocate_from_block(VulkanMemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset) {
+        if (block.usage == VulkanMemoryUsage::TRANSIENT) {
+            VkDeviceSize aligned_offset = align_up(block.head, alignment);
+            if (aligned_offset + size > block.size) {
+                return false;
+            }
+            block.head = aligned_offset + size;
+            *offset = aligned_offset;
+            return true;
+        }
+
+        // First fit. Any padding in front of the aligned offset, and any remainder after the allocation, stay free.
+        for (auto it = block.free_ranges.begin(); it != block.free_ranges.end(); ++it) {
+            auto [range_offset, range_size] = *it;
+            VkDeviceSize aligned_offset = align_up(range_offset, alignment);
+            VkDeviceSize padding = aligned_offset - range_offset;
+            if (padding + size > range_size) {
+                continue;
+            }
+            block.free_ranges.erase(it);
+            if (padding > 0) {
+                block.free_ranges.emplace(range_offset, padding);
+            }
+            VkDeviceSize remainder = range_size - padding - size;
+            if (remainder > 0) {
+                block.free_ranges.emplace(aligned_offset + size, remainder);
+            }
+            *offset = aligned_offset;
+            return true;
+        }
+        return false;
+    }
+
+    void VulkanMemoryAllocator::free_from_block(VulkanMemoryBlock& block, VkDeviceSize offset, VkDeviceSize size) {
+        auto [it, inserted] = block.free_ranges.emplace(offset, size);
+        ST_ASSERT(inserted, "Memory range at offset [" << offset << "] must not already be free");
+
+        // Merge with the following range
+        auto next = std::next(it);
+        if (next != block.free_ranges.end() && it->first + it->second == next->first) {
+            it->second += next->second;
+            block.free_ranges.erase(next);
+        }
+
+        // Merge with the preceding range
+        if (it != block.free_ranges.begin()) {
+            auto previous = std::prev(it);
+            if (previous->first + previous->second == it->first) {
+                previous->second += it->second;
+                block.free_ranges.erase(it);
+            }
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+namespace Storytime {
+    class VulkanDevice;
+
+    enum class VulkanMemoryUsage {
+        PERSISTENT = 0, // Long-lived resources, sub-allocated from free-list blocks
+        TRANSIENT = 1,  // Short-lived resources like staging buffers, sub-allocated from linear blocks
+    };
+
+    enum class VulkanMemoryResourceType {
+        BUFFER = 0,
+        IMAGE = 1,
+    };
+
+    struct VulkanMemoryBlock;
+
+    struct VulkanAllocation {
+        VulkanMemoryBlock* block = nullptr;
+        VkDeviceMemory memory = nullptr;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+
+        /// Pointer to the start of the allocation when its memory is host visible. Blocks of host visible memory are
+        /// mapped once for their lifetime, since the same memory can not be mapped more than once at a time.
+        void* data = nullptr;
+
+        operator bool() const {
+            return memory != nullptr;
+        }
+    };
+
+    struct VulkanMemoryBlock {
+        VkDeviceMemory memory = nullptr;
+        VkDeviceSize size = 0;
+        VkDeviceSize used_size = 0;
+        u32 memory_type_index = 0;
+        u32 pool_index = 0;
+        u32 allocation_count = 0;
+        void* data = nullptr;
+        VulkanMemoryUsage usage = VulkanMemoryUsage::PERSISTENT;
+
+        /// Whether the block holds a single allocation that was too large to share a block.
+        bool dedicated = false;
+
+        /// Free ranges by offset, used by persistent blocks. Adjacent ranges are merged when allocations are freed.
+        std::map<VkDeviceSize, VkDeviceSize> free_ranges;
+
+        /// The end of the last allocation, used by transient blocks. It is rewound when the block becomes empty.
+        VkDeviceSize head = 0;
+    };
+
+    struct VulkanMemoryStats {
+        u32 block_count = 0;
+        u32 dedicated_block_count = 0;
+        u32 allocation_count = 0;
+        VkDeviceSize reserved_bytes = 0;
+        VkDeviceSize used_bytes = 0;
+
+        /// How scattered the free space of persistent blocks is, from 0 when it is all in one range to approaching 1
+        /// when it is split into many small ranges.
+        f32 fragmentation = 0.0f;
+    };
+
+    struct VulkanMemoryAllocatorConfig {
+        const VulkanDevice& device;
+        std::string name = "VulkanMemoryAllocator";
+
+        /// Size of the blocks that persistent allocations are sub-allocated from.
+        VkDeviceSize persistent_block_size = 64 * 1024 * 1024;
+
+        /// Size of the blocks that transient allocations are sub-allocated from.
+        VkDeviceSize transient_block_size = 16 * 1024 * 1024;
+
+        const VulkanMemoryAllocatorConfig& assert_valid() const {
+            ST_ASSERT_GREATER_THAN_ZERO(persistent_block_size);
+            ST_ASSERT_GREATER_THAN_ZERO(transient_block_size);
+            return *this;
+        }
+    };
+
+    ///
+    /// Sub-allocates device memory from large blocks instead of allocating memory for every resource.
+    ///
+    /// The number of device memory allocations is limited (`maxMemoryAllocationCount`, often 4096), and every
+    /// allocation has driver overhead and alignment padding. Resources are instead placed in blocks that are kept in a
+    /// pool per memory type and resource type. Buffers and images have separate pools so that linear and optimal
+    /// resources never share a page (`bufferImageGranularity`).
+    ///
+    /// Persistent allocations are placed first-fit in free-list blocks. Transient allocations are bumped from linear
+    /// blocks that are rewound once all of their allocations have been freed, which suits staging buffers that live
+    /// for a single upload.
+    ///
+    class VulkanMemoryAllocator {
+    public:
+        typedef VulkanMemoryAllocatorConfig Config;
+
+    private:
+        struct Pool {
+            std::vector<Unique<VulkanMemoryBlock>> blocks;
+        };
+
+    private:
+        Config config;
+        VkPhysicalDeviceMemoryProperties memory_properties{};
+        std::vector<Pool> pools;
+        mutable std::mutex mutex;
+
+    public:
+        VulkanMemoryAllocator(const Config& config);
+
+        ~VulkanMemoryAllocator();
+
+        VulkanMemoryAllocator(const VulkanMemoryAllocator& other) = delete;
+
+        VulkanMemoryAllocator& operator=(const VulkanMemoryAllocator& other) = delete;
+
+        VulkanAllocation allocate(
+            const VkMemoryRequirements& memory_requirements,
+            VkMemoryPropertyFlags required_memory_properties,
+            VulkanMemoryResourceType resource_type,
+            VulkanMemoryUsage usage = VulkanMemoryUsage::PERSISTENT
+        );
+
+        void free(const VulkanAllocation& allocation);
+
+        VulkanMemoryStats get_stats() const;
+
+    private:
+        u32 get_pool_index(u32 memory_type_index, VulkanMemoryResourceType resource_type, VulkanMemoryUsage usage) const;
+
+        VkDeviceSize get_block_size(VulkanMemoryUsage usage) const;
+
+        VulkanMemoryBlock* create_block(u32 memory_type_index, u32 pool_index, VkDeviceSize size, VulkanMemoryUsage usage, bool dedicated);
+
+        void destroy_block(const VulkanMemoryBlock& block) const;
+
+        void release_block(VulkanMemoryBlock* block);
+
+        static bool allocate_from_block(VulkanMemoryBlock& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize* offset);
+
+        static void free_from_block(VulkanMemoryBlock& block, VkDeviceSize offset, VkDeviceSize size);
+    };
+}
@@ -1,10 +1,9 @@
 #include "st_vulkan_physical_device.h"
 
 namespace Storytime {
-    const std::vector<const char*> VulkanPhysicalDevice::enabled_extensions = get_enabled_device_extensions();
-
     VulkanPhysicalDevice::VulkanPhysicalDevice(const Config& config)
-        : config(config),
+        : enabled_extensions(get_enabled_device_extensions(config.context.get_surface() != nullptr)),
+          config(config),
           surface(config.context.get_surface()),
           physical_device(pick_physical_device()),
           queue_family_indices(find_queue_family_indices(physical_device))
@@ -24,6 +23,14 @@ namespace Storytime {
         return queue_family_indices.present_family.value();
     }
 
+    bool VulkanPhysicalDevice::has_transfer_queue_family() const {
+        return queue_family_indices.transfer_family.has_value();
+    }
+
+    u32 VulkanPhysicalDevice::get_transfer_queue_family_index() const {
+        return queue_family_indices.transfer_family.value_or(get_graphics_queue_family_index());
+    }
+
     VkResult VulkanPhysicalDevice::create_device(const VkDeviceCreateInfo& device_create_info, VkDevice* device) const {
         VkResult result = vkCreateDevice(physical_device, &device_create_info, ST_VK_ALLOCATOR, device);
         if (result != VK_SUCCESS) {
@@ -42,6 +49,28 @@ namespace Storytime {
         return features;
     }
 
+    void VulkanPhysicalDevice::get_features(VkPhysicalDeviceFeatures2* features) const {
+        vkGetPhysicalDeviceFeatures2(physical_device, features);
+    }
+
+    VkPhysicalDeviceVulkan12Features VulkanPhysicalDevice::get_vulkan_12_features() const {
+        VkPhysicalDeviceVulkan12Features vulkan_12_features{};
+        vulkan_12_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+        // The Vulkan 1.2 feature struct can only be queried from devices that support Vulkan 1.2 or later.
+        if (get_properties().apiVersion < VK_API_VERSION_1_2) {
+            return vulkan_12_features;
+        }
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = &vulkan_12_features;
+        get_features(&features);
+
+        vulkan_12_features.pNext = nullptr;
+        return vulkan_12_features;
+    }
+
     void VulkanPhysicalDevice::get_properties(VkPhysicalDeviceProperties* properties) const {
         vkGetPhysicalDeviceProperties(physical_device, properties);
     }
@@ -52,6 +81,39 @@ namespace Storytime {
         return properties;
     }
 
+    void VulkanPhysicalDevice::get_properties(VkPhysicalDeviceProperties2* properties) const {
+        vkGetPhysicalDeviceProperties2(physical_device, properties);
+    }
+
+    VkPhysicalDeviceVulkan12Properties VulkanPhysicalDevice::get_vulkan_12_properties() const {
+        VkPhysicalDeviceVulkan12Properties vulkan_12_properties{};
+        vulkan_12_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+
+        // The Vulkan 1.2 properties struct can only be queried from devices that support Vulkan 1.2 or later.
+        if (get_properties().apiVersion < VK_API_VERSION_1_2) {
+            return vulkan_12_properties;
+        }
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &vulkan_12_properties;
+        get_properties(&properties);
+
+        vulkan_12_properties.pNext = nullptr;
+        return vulkan_12_properties;
+    }
+
+    bool VulkanPhysicalDevice::supports_descriptor_indexing() const {
+        // The subset of the descriptor indexing features (core in Vulkan 1.2) that is needed to bind all textures as a
+        // single, partially bound array that can be written to while it is bound, and indexed per-instance in shaders.
+        VkPhysicalDeviceVulkan12Features features = get_vulkan_12_features();
+        return features.runtimeDescriptorArray
+            && features.descriptorBindingPartiallyBound
+            && features.descriptorBindingSampledImageUpdateAfterBind
+            && features.descriptorBindingUpdateUnusedWhilePending
+            && features.shaderSampledImageArrayNonUniformIndexing;
+    }
+
     void VulkanPhysicalDevice::get_memory_properties(VkPhysicalDeviceMemoryProperties* memory_properties) const {
         vkGetPhysicalDeviceMemoryProperties(physical_device, memory_properties);
     }
@@ -254,7 +316,7 @@ namespace Storytime {
         if (!has_required_features(physical_device)) {
             return 0;
         }
-        if (!has_required_swapchain_support(physical_device)) {
+        if (surface != nullptr && !has_required_swapchain_support(physical_device)) {
             return 0;
         }
 
@@ -341,8 +403,13 @@ namespace Storytime {
                 queue_family_indices.graphics_family = queue_family_index;
             }
 
+            // Without a surface there is nothing to present to, and frames are only submitted to the graphics queue.
             VkBool32 can_present_to_surface = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, queue_family_index, surface, &can_present_to_surface);
+            if (surface != nullptr) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, queue_family_index, surface, &can_present_to_surface);
+            } else {
+                can_present_to_surface = queue_family_indices.graphics_family == queue_family_index;
+            }
             if (can_present_to_surface) {
                 queue_family_indices.present_family = queue_family_index;
             }
@@ -351,20 +418,35 @@ namespace Storytime {
                 break;
             }
         }
+
+        // Prefer a transfer-only queue family, and fall back to any transfer queue family without graphics support.
+        for (u32 queue_family_index = 0; queue_family_index < queue_family_properties.size(); queue_family_index++) {
+            VkQueueFlags queue_flags = queue_family_properties[queue_family_index].queueFlags;
+            if (!(queue_flags & VK_QUEUE_TRANSFER_BIT) || (queue_flags & VK_QUEUE_GRAPHICS_BIT)) {
+                continue;
+            }
+            if (!queue_family_indices.transfer_family.has_value() || !(queue_flags & VK_QUEUE_COMPUTE_BIT)) {
+                queue_family_indices.transfer_family = queue_family_index;
+            }
+        }
         return queue_family_indices;
     }
 
-    std::vector<const char*> VulkanPhysicalDevice::get_enabled_device_extensions() {
-        return {
-            // Enable VkSwapchainKHR objects so the rendered graphics can be presented to a window surface.
-            VK_KHR_SWAPCHAIN_EXTENSION_NAME,
+    std::vector<const char*> VulkanPhysicalDevice::get_enabled_device_extensions(bool presentation_enabled) {
+        std::vector<const char*> extensions;
+
+        // Enable VkSwapchainKHR objects so the rendered graphics can be presented to a window surface.
+        if (presentation_enabled) {
+            extensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        }
 
 #ifdef ST_PLATFORM_MACOS
-            // macOS does not have native Vulkan drivers, so Vulkan apps have to use the MoltenVK library which layers
-            // Vulkan functionality over Apple's native Metal API, translating Vulkan calls into equivalent Metal calls.
-            "VK_KHR_portability_subset",
+        // macOS does not have native Vulkan drivers, so Vulkan apps have to use the MoltenVK library which layers
+        // Vulkan functionality over Apple's native Metal API, translating Vulkan calls into equivalent Metal calls.
+        extensions.push_back("VK_KHR_portability_subset");
 #endif
-        };
+
+        return extensions;
     }
 
     std::vector<VkExtensionProperties> VulkanPhysicalDevice::get_available_device_extensions(VkPhysicalDevice physical_device) {
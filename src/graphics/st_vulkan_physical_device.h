@@ -15,10 +15,13 @@ namespace Storytime {
         struct QueueFamilyIndices {
             std::optional<u32> graphics_family;
             std::optional<u32> present_family;
+            std::optional<u32> transfer_family;
         };
 
     public:
-        static const std::vector<const char*> enabled_extensions;
+        /// The device extensions to enable, which don't include the swapchain extension when the context has no
+        /// surface to present to.
+        const std::vector<const char*> enabled_extensions;
 
     private:
         Config config;
@@ -35,16 +38,33 @@ namespace Storytime {
 
         u32 get_present_queue_family_index() const;
 
+        /// Whether the device has a queue family that supports transfers but not graphics, which usually maps to a
+        /// dedicated DMA engine that can upload resources while the graphics queue is busy rendering.
+        bool has_transfer_queue_family() const;
+
+        /// The dedicated transfer queue family, or the graphics queue family if there is none.
+        u32 get_transfer_queue_family_index() const;
+
         VkResult create_device(const VkDeviceCreateInfo& device_create_info, VkDevice* device) const;
 
         void get_features(VkPhysicalDeviceFeatures* features) const;
 
         VkPhysicalDeviceFeatures get_features() const;
 
+        void get_features(VkPhysicalDeviceFeatures2* features) const;
+
+        VkPhysicalDeviceVulkan12Features get_vulkan_12_features() const;
+
         void get_properties(VkPhysicalDeviceProperties* properties) const;
 
         VkPhysicalDeviceProperties get_properties() const;
 
+        void get_properties(VkPhysicalDeviceProperties2* properties) const;
+
+        VkPhysicalDeviceVulkan12Properties get_vulkan_12_properties() const;
+
+        bool supports_descriptor_indexing() const;
+
         void get_memory_properties(VkPhysicalDeviceMemoryProperties* memory_properties) const;
 
         VkPhysicalDeviceMemoryProperties get_memory_properties() const;
@@ -92,7 +112,7 @@ namespace Storytime {
 
         QueueFamilyIndices find_queue_family_indices(VkPhysicalDevice physical_device) const;
 
-        static std::vector<const char*> get_enabled_device_extensions();
+        static std::vector<const char*> get_enabled_device_extensions(bool presentation_enabled);
 
         static std::vector<VkExtensionProperties> get_available_device_extensions(VkPhysicalDevice physical_device);
 
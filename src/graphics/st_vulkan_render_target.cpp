@@ -0,0 +1,228 @@
+#include "st_vulkan_render_target.h"
+
+namespace Storytime {
+    VulkanRenderTarget::VulkanRenderTarget(const Config& config)
+        : config(config.assert_valid()),
+          color_image(create_color_image()),
+          depth_image(create_depth_image())
+    {
+        create_render_pass();
+        create_framebuffer();
+    }
+
+    VulkanRenderTarget::~VulkanRenderTarget() {
+        destroy_framebuffer();
+        destroy_render_pass();
+    }
+
+    VkExtent2D VulkanRenderTarget::get_extent() const {
+        return { config.width, config.height };
+    }
+
+    const VulkanImage& VulkanRenderTarget::get_color_image() const {
+        return color_image;
+    }
+
+    void VulkanRenderTarget::begin_render_pass(const VulkanCommandBuffer& command_buffer) const {
+        config.device.insert_cmd_label(command_buffer, "Begin render target render pass");
+
+        VkClearColorValue clear_color_value = {
+            .float32 = {
+                config.clear_color.r,
+                config.clear_color.g,
+                config.clear_color.b,
+                config.clear_color.a
+            }
+        };
+
+        VkClearDepthStencilValue clear_depth_stencil_value = {
+            .depth = depth_far,
+            .stencil = 0,
+        };
+
+        std::array<VkClearValue, 2> clear_values{};
+        clear_values[0].color = clear_color_value;
+        clear_values[1].depthStencil = clear_depth_stencil_value;
+
+        VkExtent2D extent = get_extent();
+
+        VkRenderPassBeginInfo render_pass_begin_info{};
+        render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        render_pass_begin_info.renderPass = render_pass;
+        render_pass_begin_info.framebuffer = framebuffer;
+        render_pass_begin_info.renderArea.offset = {0, 0};
+        render_pass_begin_info.renderArea.extent = extent;
+        render_pass_begin_info.clearValueCount = (u32) clear_values.size();
+        render_pass_begin_info.pClearValues = clear_values.data();
+
+        command_buffer.begin_render_pass(render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+        config.device.insert_cmd_label(command_buffer, "Set render target viewport");
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = (f32) extent.width;
+        viewport.height = (f32) extent.height;
+        viewport.minDepth = depth_near;
+        viewport.maxDepth = depth_far;
+
+        command_buffer.set_viewport(viewport);
+
+        config.device.insert_cmd_label(command_buffer, "Set render target scissor");
+
+        VkRect2D scissor{};
+        scissor.offset = {0, 0};
+        scissor.extent = extent;
+
+        command_buffer.set_scissor(scissor);
+    }
+
+    void VulkanRenderTarget::end_render_pass(const VulkanCommandBuffer& command_buffer) const {
+        config.device.insert_cmd_label(command_buffer, "End render target render pass");
+        command_buffer.end_render_pass();
+    }
+
+    VulkanImage VulkanRenderTarget::create_color_image() const {
+        return VulkanImage({
+            .name = std::format("{} color image", config.name),
+            .device = &config.device,
+            .width = config.width,
+            .height = config.height,
+            .format = config.color_format,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+            .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        });
+    }
+
+    VulkanImage VulkanRenderTarget::create_depth_image() const {
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+        bool format_has_stencil_component = config.depth_format == VK_FORMAT_D32_SFLOAT_S8_UINT || config.depth_format == VK_FORMAT_D24_UNORM_S8_UINT;
+        if (format_has_stencil_component) {
+            aspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+        }
+        return VulkanImage({
+            .name = std::format("{} depth image", config.name),
+            .device = &config.device,
+            .width = config.width,
+            .height = config.height,
+            .format = config.depth_format,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .aspect = aspect,
+            .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        });
+    }
+
+    void VulkanRenderTarget::create_render_pass() {
+        VkAttachmentDescription color_attachment_description{};
+        color_attachment_description.format = config.color_format;
+        color_attachment_description.samples = VK_SAMPLE_COUNT_1_BIT;
+        color_attachment_description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        color_attachment_description.storeOp = VK_ATTACHMENT_STORE_OP_STORE; // Stored to be sampled after the render pass.
+        color_attachment_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        color_attachment_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        color_attachment_description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        color_attachment_description.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        VkAttachmentDescription depth_attachment_description{};
+        depth_attachment_description.format = config.depth_format;
+        depth_attachment_description.samples = VK_SAMPLE_COUNT_1_BIT;
+        depth_attachment_description.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depth_attachment_description.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth_attachment_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depth_attachment_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depth_attachment_description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depth_attachment_description.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        std::array<VkAttachmentDescription, 2> attachment_descriptions = {
+            color_attachment_description,
+            depth_attachment_description
+        };
+
+        VkAttachmentReference color_attachment_reference{};
+        color_attachment_reference.attachment = 0;
+        color_attachment_reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference depth_attachment_reference{};
+        depth_attachment_reference.attachment = 1;
+        depth_attachment_reference.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkSubpassDescription subpass_description{};
+        subpass_description.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass_description.colorAttachmentCount = 1;
+        subpass_description.pColorAttachments = &color_attachment_reference;
+        subpass_description.pDepthStencilAttachment = &depth_attachment_reference;
+
+        // The images are shared by all frames in flight. Wait for the previous frame to finish sampling the color image
+        // and testing against the depth image before they are cleared and written to again.
+        VkSubpassDependency begin_subpass_dependency{};
+        begin_subpass_dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        begin_subpass_dependency.dstSubpass = 0;
+        begin_subpass_dependency.srcStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        begin_subpass_dependency.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        begin_subpass_dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        begin_subpass_dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        // Make the rendered color image visible to the fragment shaders that sample it after the render pass.
+        VkSubpassDependency end_subpass_dependency{};
+        end_subpass_dependency.srcSubpass = 0;
+        end_subpass_dependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+        end_subpass_dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        end_subpass_dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        end_subpass_dependency.dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        end_subpass_dependency.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+
+        std::array<VkSubpassDependency, 2> subpass_dependencies = {
+            begin_subpass_dependency,
+            end_subpass_dependency,
+        };
+
+        VkRenderPassCreateInfo render_pass_create_info{};
+        render_pass_create_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        render_pass_create_info.attachmentCount = (u32) attachment_descriptions.size();
+        render_pass_create_info.pAttachments = attachment_descriptions.data();
+        render_pass_create_info.subpassCount = 1;
+        render_pass_create_info.pSubpasses = &subpass_description;
+        render_pass_create_info.dependencyCount = (u32) subpass_dependencies.size();
+        render_pass_create_info.pDependencies = subpass_dependencies.data();
+
+        std::string render_pass_name = std::format("{} render pass", config.name);
+
+        ST_ASSERT_THROW_VK(
+            config.device.create_render_pass(render_pass_create_info, &render_pass, render_pass_name),
+            "Could not create render target render pass [" << render_pass_name << "]"
+        );
+    }
+
+    void VulkanRenderTarget::destroy_render_pass() const {
+        config.device.destroy_render_pass(render_pass);
+    }
+
+    void VulkanRenderTarget::create_framebuffer() {
+        std::array<VkImageView, 2> attachments = {
+            color_image.get_view(),
+            depth_image.get_view(),
+        };
+
+        VkFramebufferCreateInfo framebuffer_create_info{};
+        framebuffer_create_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+        framebuffer_create_info.renderPass = render_pass;
+        framebuffer_create_info.attachmentCount = (u32) attachments.size();
+        framebuffer_create_info.pAttachments = attachments.data();
+        framebuffer_create_info.width = config.width;
+        framebuffer_create_info.height = config.height;
+        framebuffer_create_info.layers = 1;
+
+        std::string framebuffer_name = std::format("{} framebuffer", config.name);
+
+        ST_ASSERT_THROW_VK(
+            config.device.create_framebuffer(framebuffer_create_info, &framebuffer, framebuffer_name),
+            "Could not create render target framebuffer [" << framebuffer_name << "]"
+        );
+    }
+
+    void VulkanRenderTarget::destroy_framebuffer() const {
+        config.device.destroy_framebuffer(framebuffer);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "graphics/st_vulkan_command_buffer.h"
+#include "graphics/st_vulkan_device.h"
+#include "graphics/st_vulkan_image.h"
+
+namespace Storytime {
+    struct VulkanRenderTargetConfig {
+        std::string name = "VulkanRenderTarget";
+        VulkanDevice& device;
+        u32 width = 0;
+        u32 height = 0;
+        VkFormat color_format = VK_FORMAT_UNDEFINED;
+        VkFormat depth_format = VK_FORMAT_UNDEFINED;
+        glm::vec4 clear_color = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+        const VulkanRenderTargetConfig& assert_valid() const {
+            ST_ASSERT_GREATER_THAN_ZERO(width);
+            ST_ASSERT_GREATER_THAN_ZERO(height);
+            ST_ASSERT(color_format != VK_FORMAT_UNDEFINED, "Render target [" << name << "] must have a color format");
+            ST_ASSERT(depth_format != VK_FORMAT_UNDEFINED, "Render target [" << name << "] must have a depth format");
+            return *this;
+        }
+    };
+
+    ///
+    /// An offscreen color and depth target with a fixed resolution, that is rendered to instead of the swapchain and
+    /// sampled afterwards.
+    ///
+    /// The attachments of its render pass have the same formats as the swapchain render pass, which makes the two
+    /// render passes compatible, so pipelines that were created for the swapchain can draw to the target as well. The
+    /// color image is left in `VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL` when the render pass ends, ready to be
+    /// sampled by fragment shaders.
+    ///
+    class VulkanRenderTarget {
+    public:
+        typedef VulkanRenderTargetConfig Config;
+
+    private:
+        static constexpr f32 depth_near = 0.0f;
+        static constexpr f32 depth_far = 1.0f;
+
+    private:
+        Config config;
+        VulkanImage color_image;
+        VulkanImage depth_image;
+        VkRenderPass render_pass = nullptr;
+        VkFramebuffer framebuffer = nullptr;
+
+    public:
+        VulkanRenderTarget(const Config& config);
+
+        ~VulkanRenderTarget();
+
+        VulkanRenderTarget(const VulkanRenderTarget& other) = delete;
+
+        VulkanRenderTarget& operator=(const VulkanRenderTarget& other) = delete;
+
+        VkExtent2D get_extent() const;
+
+        const VulkanImage& get_color_image() const;
+
+        void begin_render_pass(const VulkanCommandBuffer& command_buffer) const;
+
+        void end_render_pass(const VulkanCommandBuffer& command_buffer) const;
+
+    private:
+        VulkanImage create_color_image() const;
+
+        VulkanImage create_depth_image() const;
+
+        void create_render_pass();
+
+        void destroy_render_pass() const;
+
+        void create_framebuffer();
+
+        void destroy_framebuffer() const;
+    };
+}
@@ -0,0 +1,183 @@
+#include "st_vulkan_staging_ring.h"
+
+namespace Storytime {
+    static VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    VulkanStagingRing::VulkanStagingRing(const Config& config)
+        : config(config.assert_valid()),
+          buffer({
+              .device = config.device,
+              .name = std::format("{} buffer", config.name),
+              .size = config.size,
+              .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+              .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+          })
+    {
+        buffer.map_memory();
+
+        // Regions are aligned so that they can be copied to images of any format (the offset must be a multiple of the
+        // texel size), and to the optimal offset alignment of the device.
+        VkPhysicalDeviceProperties properties = config.device->get_physical_device().get_properties();
+        alignment = std::max(alignment, properties.limits.optimalBufferCopyOffsetAlignment);
+    }
+
+    VulkanStagingRing::~VulkanStagingRing() {
+        for (const Submission& submission : submissions) {
+            if (submission.owns_fence) {
+                config.device->wait_for_fence(submission.fence, UINT64_MAX);
+                config.device->destroy_fence(submission.fence);
+            }
+        }
+        for (VkFence fence : free_fences) {
+            config.device->destroy_fence(fence);
+        }
+    }
+
+    VkDeviceSize VulkanStagingRing::get_size() const {
+        return config.size;
+    }
+
+    VulkanStagingRegion VulkanStagingRing::allocate(VkDeviceSize size) {
+        ST_ASSERT_GREATER_THAN_ZERO(size);
+        ST_ASSERT(size <= config.size, "Staging region of size [" << size << "] must fit in staging ring [" << config.name << "] of size [" << config.size << "]");
+
+        std::lock_guard lock(mutex);
+
+        VkDeviceSize offset = 0;
+        while (true) {
+            reclaim_completed_submissions();
+            if (try_reserve(size, &offset)) {
+                break;
+            }
+            if (submissions.empty()) {
+                ST_THROW("Could not allocate staging region of size [" << size << "] from staging ring [" << config.name << "] because it is full of pending uploads, uploads must be ended before more can be staged");
+            }
+            // Wait for the oldest submission to complete to free up its regions.
+            VkFence fence = submissions.front().fence;
+            if (fence != nullptr) {
+                ST_ASSERT_THROW_VK(
+                    config.device->wait_for_fence(fence, UINT64_MAX),
+                    "Could not wait for staging ring [" << config.name << "] submission to complete"
+                );
+            }
+        }
+
+        VulkanStagingRegion region{};
+        region.buffer = buffer;
+        region.offset = offset;
+        region.size = size;
+        region.data = (u8*) buffer.get_data() + offset;
+        return region;
+    }
+
+    VulkanStagingRegion VulkanStagingRing::stage(const void* data, VkDeviceSize size) {
+        VulkanStagingRegion region = allocate(size);
+        memcpy(region.data, data, size);
+        return region;
+    }
+
+    void VulkanStagingRing::end_uploads(VkFence fence) {
+        std::lock_guard lock(mutex);
+        if (pending_size == 0) {
+            return;
+        }
+        submissions.push_back({
+            .fence = fence,
+            .end = head,
+            .size = pending_size,
+        });
+        pending_size = 0;
+    }
+
+    VkFence VulkanStagingRing::submit_uploads() {
+        std::lock_guard lock(mutex);
+        VkFence fence = get_free_fence();
+        submissions.push_back({
+            .fence = fence,
+            .end = head,
+            .size = pending_size,
+            .owns_fence = true,
+        });
+        pending_size = 0;
+        return fence;
+    }
+
+    bool VulkanStagingRing::try_reserve(VkDeviceSize size, VkDeviceSize* offset) {
+        if (used_size == 0) {
+            head = 0;
+            tail = 0;
+        }
+        VkDeviceSize aligned_head = align_up(head, alignment);
+        VkDeviceSize reserved_offset = 0;
+        VkDeviceSize reserved_end = 0;
+
+        if (head > tail || used_size == 0) {
+            // The free space is at the end of the ring and in front of the tail.
+            if (aligned_head + size <= config.size) {
+                reserved_offset = aligned_head;
+            } else if (size <= tail) {
+                // Wrap around, and let the region also cover the unused space at the end of the ring.
+                reserved_offset = 0;
+            } else {
+                return false;
+            }
+        } else if (head < tail) {
+            // The free space is between the head and the tail.
+            if (aligned_head + size > tail) {
+                return false;
+            }
+            reserved_offset = aligned_head;
+        } else {
+            // The head has caught up with the tail, so the ring is full.
+            return false;
+        }
+
+        reserved_end = reserved_offset + size;
+        VkDeviceSize consumed_size = reserved_end > head ? reserved_end - head : config.size - head + reserved_end;
+        used_size += consumed_size;
+        pending_size += consumed_size;
+        head = reserved_end;
+        *offset = reserved_offset;
+        return true;
+    }
+
+    void VulkanStagingRing::reclaim_completed_submissions() {
+        while (!submissions.empty()) {
+            const Submission& submission = submissions.front();
+            if (submission.fence != nullptr && config.device->get_fence_status(submission.fence) != VK_SUCCESS) {
+                break;
+            }
+            if (submission.owns_fence) {
+                ST_ASSERT_THROW_VK(
+                    config.device->reset_fence(submission.fence),
+                    "Could not reset staging ring [" << config.name << "] fence"
+                );
+                free_fences.push_back(submission.fence);
+            }
+            tail = submission.end;
+            used_size -= submission.size;
+            submissions.pop_front();
+        }
+    }
+
+    VkFence VulkanStagingRing::get_free_fence() {
+        if (!free_fences.empty()) {
+            VkFence fence = free_fences.back();
+            free_fences.pop_back();
+            return fence;
+        }
+
+        VkFenceCreateInfo fence_create_info{};
+        fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        VkFence fence = nullptr;
+        std::string fence_name = std::format("{} fence {}", config.name, fence_count++);
+        ST_ASSERT_THROW_VK(
+            config.device->create_fence(fence_create_info, &fence, fence_name),
+            "Could not create staging ring fence [" << fence_name << "]"
+        );
+        return fence;
+    }
+}
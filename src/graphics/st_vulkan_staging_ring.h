@@ -0,0 +1,94 @@
+#pragma once
+
+#include "graphics/st_vulkan_buffer.h"
+
+namespace Storytime {
+    struct VulkanStagingRegion {
+        VkBuffer buffer = nullptr;
+        VkDeviceSize offset = 0;
+        VkDeviceSize size = 0;
+        void* data = nullptr;
+    };
+
+    struct VulkanStagingRingConfig {
+        VulkanDevice* device = nullptr;
+        std::string name = "VulkanStagingRing";
+
+        /// The fixed budget of host visible memory for uploads. Uploads larger than this must be split into chunks
+        /// that are submitted separately.
+        VkDeviceSize size = 32 * 1024 * 1024;
+
+        const VulkanStagingRingConfig& assert_valid() const {
+            ST_ASSERT_NOT_NULL(device);
+            ST_ASSERT_GREATER_THAN_ZERO(size);
+            return *this;
+        }
+    };
+
+    ///
+    /// A persistently mapped ring of host visible memory that uploads to device local buffers and images are staged in.
+    ///
+    /// Regions are handed out from the head of the ring and are pending until `end_uploads` is called, which tags
+    /// them with the fence of the submission that reads from them. The tail of the ring advances past regions once
+    /// their fence has been signaled, and allocations that can't find room wait for the oldest submission to
+    /// complete.
+    ///
+    class VulkanStagingRing {
+    public:
+        typedef VulkanStagingRingConfig Config;
+
+    private:
+        struct Submission {
+            VkFence fence = nullptr;
+            VkDeviceSize end = 0;
+            VkDeviceSize size = 0;
+            bool owns_fence = false;
+        };
+
+    private:
+        Config config;
+        VulkanBuffer buffer;
+        VkDeviceSize alignment = 16;
+        VkDeviceSize head = 0;
+        VkDeviceSize tail = 0;
+        VkDeviceSize used_size = 0;
+        VkDeviceSize pending_size = 0;
+        std::deque<Submission> submissions;
+        std::vector<VkFence> free_fences;
+        u32 fence_count = 0;
+        std::mutex mutex;
+
+    public:
+        VulkanStagingRing(const Config& config);
+
+        ~VulkanStagingRing();
+
+        VulkanStagingRing(const VulkanStagingRing& other) = delete;
+
+        VulkanStagingRing& operator=(const VulkanStagingRing& other) = delete;
+
+        /// The largest region that can be allocated at once.
+        VkDeviceSize get_size() const;
+
+        VulkanStagingRegion allocate(VkDeviceSize size);
+
+        /// Allocate a region and copy the data into it.
+        VulkanStagingRegion stage(const void* data, VkDeviceSize size);
+
+        /// Hand the regions that have been allocated since the last call over to a submission that is guarded by the
+        /// fence. The fence can be null when the caller has already waited for the submission to complete.
+        void end_uploads(VkFence fence = nullptr);
+
+        /// Hand the regions that have been allocated since the last call over to a submission that the caller makes
+        /// with the returned fence. The fence belongs to the ring and is reused once the ring has seen it signaled, so
+        /// it must be submitted right away and must not be waited on or reset by the caller afterwards.
+        VkFence submit_uploads();
+
+    private:
+        bool try_reserve(VkDeviceSize size, VkDeviceSize* offset);
+
+        void reclaim_completed_submissions();
+
+        VkFence get_free_fence();
+    };
+}
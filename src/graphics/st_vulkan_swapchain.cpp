@@ -52,10 +52,30 @@ namespace Storytime {
         return image_extent;
     }
 
+    VkFormat VulkanSwapchain::get_color_format() const {
+        return surface_format.format;
+    }
+
+    VkFormat VulkanSwapchain::get_depth_format() const {
+        return depth_image->get_format();
+    }
+
+    const glm::vec4& VulkanSwapchain::get_clear_color() const {
+        return config.clear_color;
+    }
+
     u32 VulkanSwapchain::get_image_count() const {
         return color_images.size();
     }
 
+    VkImage VulkanSwapchain::get_image() const {
+        return color_images.at(image_index);
+    }
+
+    bool VulkanSwapchain::is_headless() const {
+        return config.headless;
+    }
+
     bool VulkanSwapchain::acquire_frame(const Frame& frame) {
         VkFence in_flight_fence = frame.in_flight_fence;
         VkSemaphore image_available_semaphore = frame.image_available_semaphore;
@@ -82,6 +102,18 @@ namespace Storytime {
         //
         // Acquire an image from the swapchain to use for the current frame.
         //
+        // Offscreen images are not owned by a presentation engine, so they are used round-robin and are available as
+        // soon as the frame that last rendered to them has finished.
+        //
+
+        if (config.headless) {
+            image_index = (image_index + 1) % (u32) color_images.size();
+            VkResult reset_fence_result = config.device.reset_fences(1, &in_flight_fence);
+            if (reset_fence_result != VK_SUCCESS) {
+                ST_THROW("Could not reset 'in flight' fence: " << format_vk_result(reset_fence_result));
+            }
+            return true;
+        }
 
         u64 next_image_timeout = UINT64_MAX; // Wait forever until an image becomes available.
         VkFence image_available_fence = VK_NULL_HANDLE; // No fences to signal when an image becomes available.
@@ -135,11 +167,16 @@ namespace Storytime {
         submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
         submit_info.commandBufferCount = 1;
         submit_info.pCommandBuffers = &command_buffer;
-        submit_info.waitSemaphoreCount = 1;
-        submit_info.pWaitSemaphores = &image_available_semaphore; // Wait until an image is available.
-        submit_info.pWaitDstStageMask = &color_output_pipeline_stage; // Wait at the color output pipeline stage.
-        submit_info.signalSemaphoreCount = 1;
-        submit_info.pSignalSemaphores = &render_finished_semaphore; // Signal that the rendering to the image is complete.
+
+        // Offscreen images are neither acquired from nor presented by a presentation engine, so there is nothing to
+        // wait for or to signal.
+        if (!config.headless) {
+            submit_info.waitSemaphoreCount = 1;
+            submit_info.pWaitSemaphores = &image_available_semaphore; // Wait until an image is available.
+            submit_info.pWaitDstStageMask = &color_output_pipeline_stage; // Wait at the color output pipeline stage.
+            submit_info.signalSemaphoreCount = 1;
+            submit_info.pSignalSemaphores = &render_finished_semaphore; // Signal that the rendering to the image is complete.
+        }
 
         config.device.insert_queue_label(graphics_queue, "Submit render commands");
 
@@ -150,6 +187,10 @@ namespace Storytime {
 
         config.device.end_queue_label(graphics_queue);
 
+        if (config.headless) {
+            return;
+        }
+
         //
         // Present the rendered image to the surface (screen).
         //
@@ -241,6 +282,11 @@ namespace Storytime {
     }
 
     void VulkanSwapchain::create_swapchain() {
+        if (config.headless) {
+            create_offscreen_images();
+            return;
+        }
+
         const VulkanPhysicalDevice& physical_device = config.device.get_physical_device();
 
         std::vector<VkPresentModeKHR> present_modes;
@@ -308,10 +354,53 @@ namespace Storytime {
         );
     }
 
-    void VulkanSwapchain::destroy_swapchain() const {
+    void VulkanSwapchain::destroy_swapchain() {
+        if (config.headless) {
+            destroy_offscreen_images();
+            return;
+        }
         config.device.destroy_swapchain(swapchain);
     }
 
+    void VulkanSwapchain::create_offscreen_images() {
+        // Use the format that is preferred for surfaces, so that headless frames are rendered the same way as the
+        // frames that are presented.
+        surface_format = {
+            .format = VK_FORMAT_B8G8R8A8_SRGB,
+            .colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+        };
+
+        WindowSize window_size_px = config.window.get_size_in_pixels();
+        image_extent = { (u32) window_size_px.width, (u32) window_size_px.height };
+
+        u32 image_count = config.offscreen_image_count;
+        offscreen_images.resize(image_count);
+        color_images.resize(image_count);
+
+        for (u32 i = 0; i < image_count; i++) {
+            // Created on the heap so they can be destroyed at the correct time when the swapchain is recreated.
+            offscreen_images[i] = ST_NEW VulkanImage({
+                .name = std::format("{} offscreen image {}/{}", config.name, i + 1, image_count),
+                .device = &config.device,
+                .width = image_extent.width,
+                .height = image_extent.height,
+                .format = surface_format.format,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+                .usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            });
+            color_images[i] = *offscreen_images[i];
+        }
+    }
+
+    void VulkanSwapchain::destroy_offscreen_images() {
+        for (VulkanImage* offscreen_image : offscreen_images) {
+            delete offscreen_image;
+        }
+        offscreen_images.clear();
+        color_images.clear();
+    }
+
     VkSurfaceFormatKHR VulkanSwapchain::find_surface_format(const std::vector<VkSurfaceFormatKHR>& surface_formats) const {
         for (const auto& surface_format : surface_formats) {
             if (surface_format.format == VK_FORMAT_B8G8R8A8_SRGB && surface_format.colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
@@ -437,7 +526,8 @@ namespace Storytime {
         color_attachment_description.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         color_attachment_description.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         color_attachment_description.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-        color_attachment_description.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        // Offscreen images are left ready to be copied from, so that a rendered frame can be read back.
+        color_attachment_description.finalLayout = config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentDescription depth_attachment_description{};
         depth_attachment_description.format = depth_image->get_format();
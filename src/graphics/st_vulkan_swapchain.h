@@ -18,8 +18,19 @@ namespace Storytime {
         glm::vec4 clear_color = { 0.0f, 0.0f, 0.0f, 1.0f };
         bool vsync_enabled = false;
 
+        /// Render to offscreen images that are never presented instead of to the images of a surface, so that frames
+        /// can be rendered without a display.
+        bool headless = false;
+
+        /// The number of offscreen images to cycle through when headless.
+        u32 offscreen_image_count = 3;
+
         const VulkanSwapchainConfig& assert_valid() const {
-            ST_ASSERT_NOT_NULL(surface);
+            if (headless) {
+                ST_ASSERT_GREATER_THAN_ZERO(offscreen_image_count);
+            } else {
+                ST_ASSERT_NOT_NULL(surface);
+            }
             return *this;
         }
     };
@@ -39,6 +50,7 @@ namespace Storytime {
         VkPresentModeKHR present_mode = VK_PRESENT_MODE_MAX_ENUM_KHR;
         VkExtent2D image_extent{};
         std::vector<VkImage> color_images{};
+        std::vector<VulkanImage*> offscreen_images{};
         std::vector<VkImageView> color_image_views{};
         VulkanImage* depth_image = nullptr;
         VkRenderPass render_pass = nullptr;
@@ -62,8 +74,19 @@ namespace Storytime {
 
         const VkExtent2D& get_image_extent() const;
 
+        VkFormat get_color_format() const;
+
+        VkFormat get_depth_format() const;
+
+        const glm::vec4& get_clear_color() const;
+
         u32 get_image_count() const;
 
+        /// The color image of the frame that was acquired last.
+        VkImage get_image() const;
+
+        bool is_headless() const;
+
         bool acquire_frame(const Frame& frame);
 
         void present_frame(const Frame& frame);
@@ -75,7 +98,11 @@ namespace Storytime {
     private:
         void create_swapchain();
 
-        void destroy_swapchain() const;
+        void destroy_swapchain();
+
+        void create_offscreen_images();
+
+        void destroy_offscreen_images();
 
         VkSurfaceFormatKHR find_surface_format(const std::vector<VkSurfaceFormatKHR>& surface_formats) const;
 
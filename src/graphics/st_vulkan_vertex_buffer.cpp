@@ -7,19 +7,16 @@ namespace Storytime {
         : config(config.assert_valid()),
           buffer(create_buffer())
     {
+        // Device local buffers that are copied to are uploaded through the device's staging ring, other buffers are
+        // host visible and written to directly.
         staging_buffer_enabled = is_staging_buffer_enabled();
-        if (staging_buffer_enabled) {
-            staging_buffer = create_staging_buffer();
-            staging_buffer.map_memory();
-        } else {
+        if (!staging_buffer_enabled) {
             buffer.map_memory();
         }
     }
 
     VulkanVertexBuffer::~VulkanVertexBuffer() {
-        if (staging_buffer_enabled) {
-            staging_buffer.unmap_memory();
-        } else {
+        if (!staging_buffer_enabled) {
             buffer.unmap_memory();
         }
     }
@@ -27,13 +24,13 @@ namespace Storytime {
     VulkanVertexBuffer::VulkanVertexBuffer(VulkanVertexBuffer&& other) noexcept
         : config(std::move(other.config)),
           buffer(std::move(other.buffer)),
-          staging_buffer(std::move(other.staging_buffer)) {}
+          staging_buffer_enabled(other.staging_buffer_enabled) {}
 
     VulkanVertexBuffer& VulkanVertexBuffer::operator=(VulkanVertexBuffer&& other) noexcept {
         if (this != &other) {
             config = std::move(other.config);
             buffer = std::move(other.buffer);
-            staging_buffer = std::move(other.staging_buffer);
+            staging_buffer_enabled = other.staging_buffer_enabled;
         }
         return *this;
     }
@@ -52,6 +49,11 @@ namespace Storytime {
         command_buffer.bind_vertex_buffer(binding, buffer, offsets);
     }
 
+    void* VulkanVertexBuffer::get_data() const {
+        ST_ASSERT(!staging_buffer_enabled, "Staging buffer must be disabled when accessing mapped vertex data");
+        return buffer.get_data();
+    }
+
     void VulkanVertexBuffer::set_data(const void* data) const {
         ST_ASSERT(!staging_buffer_enabled, "Staging buffer must be disabled when setting vertex data without a command buffer");
         buffer.set_data(data);
@@ -59,8 +61,17 @@ namespace Storytime {
 
     void VulkanVertexBuffer::set_data(const VulkanCommandBuffer& command_buffer, const void* data) const {
         ST_ASSERT(staging_buffer_enabled, "Staging buffer must be enabled when setting vertex data with a command buffer");
-        staging_buffer.set_data(data);
-        staging_buffer.copy_data(command_buffer, buffer);
+        buffer.stage_data(command_buffer, data, config.size);
+    }
+
+    void VulkanVertexBuffer::set_data(const void* data, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT(!staging_buffer_enabled, "Staging buffer must be disabled when setting vertex data without a command buffer");
+        buffer.set_data(data, size, offset);
+    }
+
+    void VulkanVertexBuffer::set_data(const VulkanCommandBuffer& command_buffer, const void* data, VkDeviceSize size, VkDeviceSize offset) const {
+        ST_ASSERT(staging_buffer_enabled, "Staging buffer must be enabled when setting vertex data with a command buffer");
+        buffer.stage_data(command_buffer, data, size, offset);
     }
 
     VulkanBuffer VulkanVertexBuffer::create_buffer() {
@@ -73,16 +84,6 @@ namespace Storytime {
         });
     }
 
-    VulkanBuffer VulkanVertexBuffer::create_staging_buffer() {
-        return VulkanBuffer({
-            .device = config.device,
-            .name = std::format("{} staging buffer", config.name),
-            .size = config.size,
-            .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-            .memory_properties = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-        });
-    }
-
     bool VulkanVertexBuffer::is_staging_buffer_enabled() const {
         bool primary_buffer_will_be_copied_to = config.usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT;
         if (!primary_buffer_will_be_copied_to) {
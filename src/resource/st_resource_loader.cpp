@@ -1,4 +1,5 @@
 #include "st_resource_loader.h"
+#include "graphics/st_vulkan_command_buffer.h"
 
 #include <stb_image.h>
 #include <nlohmann/json.hpp>
@@ -11,46 +12,35 @@ namespace Storytime {
               .device = config.vulkan_device,
               .queue_family_index = config.vulkan_device.get_graphics_queue_family_index(),
               .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+          }),
+          transfer_command_pool({
+              .name = "ResourceLoader texture transfer command pool",
+              .device = config.vulkan_device,
+              .queue_family_index = config.vulkan_device.get_transfer_queue_family_index(),
+              .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
           })
     {
     }
 
+    ResourceLoader::~ResourceLoader() {
+        for (const TextureUpload& texture_upload : texture_uploads) {
+            config.vulkan_device.wait_for_fence(texture_upload.graphics_fence, UINT64_MAX);
+            destroy_texture_upload(texture_upload);
+        }
+    }
+
     Shared<Texture> ResourceLoader::load_texture(const std::filesystem::path& path) const {
         ST_ASSERT(!path.empty(), "Texture path must not be empty");
         ST_ASSERT(std::filesystem::exists(path), "Texture must exist on path [" << path << "]");
 
-        ST_LOG_TRACE("Loading texture [{}]", path.c_str());
-
-        ImageFile image_file = load_image(path);
-
-        // Ensure the image file dimensions are not too large.
-        const VulkanPhysicalDevice& physical_device = config.vulkan_device.get_physical_device();
-        const u32 max_image_dimension = physical_device.get_properties().limits.maxImageDimension2D;
-        if (image_file.width > max_image_dimension) {
-            ST_THROW("Could not load texture [" << path << "] because its width [" << image_file.width << "] is larger than the largest allowed dimension [" << max_image_dimension << "]");
-        }
-        if (image_file.height > max_image_dimension) {
-            ST_THROW("Could not load texture [" << path << "] because its height [" << image_file.height << "] is larger than the largest allowed dimension [" << max_image_dimension << "]");
+        if (TextureFile::is_texture_file(path)) {
+            return load_texture_file(path);
         }
 
-        // Calculate the number of levels in the mip chain.
-        // - The `max` function selects the largest dimension.
-        // - The `log2` function calculates how many times that dimension can be divided by 2.
-        // - The `floor` function handles cases where the largest dimension is not a power of 2.
-        // - 1 is added so that the original image has a mip level.
-        u32 mip_levels = (u32) std::floor(std::log2(std::max(image_file.width, image_file.height))) + 1;
+        ST_LOG_TRACE("Loading texture [{}]", path.c_str());
 
-        auto texture = std::make_shared<Texture>(TextureConfig{
-            .name = path.string(),
-            .device = &config.vulkan_device,
-            .width = (u32) image_file.width,
-            .height = (u32) image_file.height,
-            .format = VK_FORMAT_R8G8B8A8_SRGB,
-            .tiling = VK_IMAGE_TILING_OPTIMAL,
-            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
-            .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            .mip_levels = mip_levels,
-        });
+        ImageFile image_file = load_image(path);
+        Shared<Texture> texture = create_texture(path, image_file);
 
         vulkan_command_pool.record_and_submit_commands([&texture, &image_file](const OnRecordCommandsFn &on_record_commands) {
             texture->set_pixels(on_record_commands, image_file.get_byte_size(), image_file.pixels);
@@ -58,10 +48,135 @@ namespace Storytime {
 
         free_image(image_file);
 
+        // Give the texture its persistent index in the bindless texture array (if enabled) up front, so that it's ready
+        // to be rendered without any extra work on the render path.
+        config.renderer.register_texture(texture);
+
         ST_LOG_DEBUG("Loaded texture [{}]", path.c_str());
         return texture;
     }
 
+    Shared<Texture> ResourceLoader::load_texture_async(const std::filesystem::path& path) {
+        ST_ASSERT(!path.empty(), "Texture path must not be empty");
+        ST_ASSERT(std::filesystem::exists(path), "Texture must exist on path [" << path << "]");
+
+        // Cooked textures are neither decoded nor have their mipmap generated, so they are cheap to load synchronously.
+        if (TextureFile::is_texture_file(path)) {
+            return load_texture_file(path);
+        }
+
+        ST_LOG_TRACE("Loading texture [{}] asynchronously", path.c_str());
+
+        ImageFile image_file = load_image(path);
+
+        // Textures that don't fit in the staging ring at once are uploaded in chunks, which is done synchronously.
+        if (image_file.get_byte_size() > config.vulkan_device.get_staging_ring().get_size()) {
+            free_image(image_file);
+            ST_LOG_W("Texture [{}] is too large to be uploaded asynchronously, loading it synchronously", path.c_str());
+            return load_texture(path);
+        }
+
+        Shared<Texture> texture = create_texture(path, image_file);
+        texture->set_ready(false);
+
+        submit_texture_upload(texture, image_file);
+
+        free_image(image_file);
+
+        ST_LOG_DEBUG("Submitted upload of texture [{}]", path.c_str());
+        return texture;
+    }
+
+    void ResourceLoader::update() {
+        for (u32 i = 0; i < texture_uploads.size();) {
+            const TextureUpload& texture_upload = texture_uploads.at(i);
+            if (config.vulkan_device.get_fence_status(texture_upload.graphics_fence) != VK_SUCCESS) {
+                i++;
+                continue;
+            }
+
+            // The texture is registered once it has been uploaded, so that its bindless descriptor is never written
+            // while the image is in any other layout than the one it's sampled in.
+            texture_upload.texture->set_ready(true);
+            config.renderer.register_texture(texture_upload.texture);
+            ST_LOG_DEBUG("Loaded texture [{}]", texture_upload.texture->get_name());
+
+            destroy_texture_upload(texture_upload);
+            texture_uploads.erase(texture_uploads.begin() + i);
+        }
+    }
+
+    Shared<TextureAtlas> ResourceLoader::load_texture_atlas(const std::vector<std::filesystem::path>& paths, const TextureAtlasConfig& atlas_config) const {
+        ST_ASSERT(!paths.empty(), "Texture atlas [" << atlas_config.name << "] must have images");
+
+        ST_LOG_TRACE("Loading texture atlas [{}]", atlas_config.name);
+
+        // Pages can't be larger than the largest image the device supports.
+        TextureAtlasConfig page_config = atlas_config;
+        const VulkanPhysicalDevice& physical_device = config.vulkan_device.get_physical_device();
+        page_config.page_size = std::min(page_config.page_size, physical_device.get_properties().limits.maxImageDimension2D);
+
+        TextureAtlasBuilder atlas_builder(page_config);
+        for (const std::filesystem::path& path : paths) {
+            ST_ASSERT(std::filesystem::exists(path), "Texture atlas image must exist on path [" << path << "]");
+            ImageFile image_file = load_image(path);
+            if (image_file.pixels == nullptr) {
+                ST_THROW("Could not load texture atlas image [" << path << "]");
+            }
+            atlas_builder.add_image(path.string(), (u32) image_file.width, (u32) image_file.height, image_file.pixels);
+            free_image(image_file);
+        }
+
+        TextureAtlasBuilder::Result atlas = atlas_builder.build();
+
+        std::vector<Shared<Texture>> page_textures;
+        page_textures.reserve(atlas.pages.size());
+        for (u32 i = 0; i < atlas.pages.size(); i++) {
+            const TextureAtlasPage& page = atlas.pages[i];
+
+            // Small pages can have fewer mip levels than the atlas is configured with.
+            u32 full_mip_levels = (u32) std::floor(std::log2(std::max(page.width, page.height))) + 1;
+
+            auto texture = std::make_shared<Texture>(TextureConfig{
+                .name = std::format("{} page {}", atlas_config.name, i),
+                .device = &config.vulkan_device,
+                .width = page.width,
+                .height = page.height,
+                .format = VK_FORMAT_R8G8B8A8_SRGB,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+                .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                .mip_levels = std::min(page_config.mip_levels, full_mip_levels),
+            });
+
+            vulkan_command_pool.record_and_submit_commands([&texture, &page](const OnRecordCommandsFn &on_record_commands) {
+                texture->set_pixels(on_record_commands, page.pixels.size(), page.pixels.data());
+            });
+
+            config.renderer.register_texture(texture);
+            page_textures.push_back(texture);
+        }
+
+        ST_LOG_DEBUG("Loaded texture atlas [{}] with [{}] images in [{}] pages", atlas_config.name, paths.size(), page_textures.size());
+        return std::make_shared<TextureAtlas>(page_textures, atlas.regions);
+    }
+
+    Shared<TextureAtlas> ResourceLoader::load_texture_atlas(const std::filesystem::path& directory_path, const TextureAtlasConfig& atlas_config) const {
+        ST_ASSERT(std::filesystem::is_directory(directory_path), "Texture atlas directory must exist on path [" << directory_path << "]");
+
+        std::vector<std::filesystem::path> paths;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory_path)) {
+            std::filesystem::path extension = entry.path().extension();
+            if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg")) {
+                paths.push_back(entry.path());
+            }
+        }
+
+        // Directory iteration order is unspecified, so sort the paths to pack the atlas the same way every time.
+        std::ranges::sort(paths);
+        return load_texture_atlas(paths, atlas_config);
+    }
+
     Shared<Audio> ResourceLoader::load_audio(const std::filesystem::path& path) const {
         ST_LOG_TRACE("Loading audio [{}]", path.c_str());
 
@@ -157,4 +272,168 @@ namespace Storytime {
             stbi_image_free(image.pixels);
         }
     }
+
+    Shared<Texture> ResourceLoader::load_texture_file(const std::filesystem::path& path) const {
+        ST_LOG_TRACE("Loading cooked texture [{}]", path.c_str());
+
+        TextureFile texture_file(path);
+        assert_texture_dimensions(path, texture_file.get_width(), texture_file.get_height());
+
+        auto texture = std::make_shared<Texture>(TextureConfig{
+            .name = path.string(),
+            .device = &config.vulkan_device,
+            .width = texture_file.get_width(),
+            .height = texture_file.get_height(),
+            .format = texture_file.get_format(),
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+            .usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            .mip_levels = texture_file.get_mip_level_count(),
+            .premultiplied_alpha = texture_file.has_flag(TextureFileFlag::PREMULTIPLIED_ALPHA),
+        });
+
+        // The mip levels are staged straight from the file mapping.
+        std::vector<VulkanImageMipLevelPixels> mip_level_pixels = texture_file.get_mip_level_pixels();
+        vulkan_command_pool.record_and_submit_commands([&texture, &mip_level_pixels](const OnRecordCommandsFn &on_record_commands) {
+            texture->set_mip_level_pixels(on_record_commands, mip_level_pixels);
+        });
+
+        config.renderer.register_texture(texture);
+
+        ST_LOG_DEBUG("Loaded cooked texture [{}]", path.c_str());
+        return texture;
+    }
+
+    Shared<Texture> ResourceLoader::create_texture(const std::filesystem::path& path, const ImageFile& image_file) const {
+        assert_texture_dimensions(path, image_file.width, image_file.height);
+
+        // Calculate the number of levels in the mip chain.
+        // - The `max` function selects the largest dimension.
+        // - The `log2` function calculates how many times that dimension can be divided by 2.
+        // - The `floor` function handles cases where the largest dimension is not a power of 2.
+        // - 1 is added so that the original image has a mip level.
+        u32 mip_levels = (u32) std::floor(std::log2(std::max(image_file.width, image_file.height))) + 1;
+
+        return std::make_shared<Texture>(TextureConfig{
+            .name = path.string(),
+            .device = &config.vulkan_device,
+            .width = (u32) image_file.width,
+            .height = (u32) image_file.height,
+            .format = VK_FORMAT_R8G8B8A8_SRGB,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .aspect = VK_IMAGE_ASPECT_COLOR_BIT,
+            .usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            .mip_levels = mip_levels,
+        });
+    }
+
+    void ResourceLoader::assert_texture_dimensions(const std::filesystem::path& path, u32 width, u32 height) const {
+        // Ensure the image file dimensions are not too large.
+        const VulkanPhysicalDevice& physical_device = config.vulkan_device.get_physical_device();
+        const u32 max_image_dimension = physical_device.get_properties().limits.maxImageDimension2D;
+        if (width > max_image_dimension) {
+            ST_THROW("Could not load texture [" << path << "] because its width [" << width << "] is larger than the largest allowed dimension [" << max_image_dimension << "]");
+        }
+        if (height > max_image_dimension) {
+            ST_THROW("Could not load texture [" << path << "] because its height [" << height << "] is larger than the largest allowed dimension [" << max_image_dimension << "]");
+        }
+    }
+
+    void ResourceLoader::submit_texture_upload(const Shared<Texture>& texture, const ImageFile& image_file) {
+        const VulkanDevice& device = config.vulkan_device;
+        u32 transfer_queue_family_index = device.get_transfer_queue_family_index();
+        u32 graphics_queue_family_index = device.get_graphics_queue_family_index();
+        u32 upload_index = texture_upload_count++;
+
+        TextureUpload texture_upload{};
+        texture_upload.texture = texture;
+
+        //
+        // Copy the pixels to the base image on the transfer queue.
+        //
+        // Dedicated transfer queue families can't blit, so the copy releases ownership of the image to the graphics
+        // queue family that generates the mipmap.
+        //
+
+        VulkanStagingRing& staging_ring = device.get_staging_ring();
+        VulkanStagingRegion staging_region = staging_ring.stage(image_file.pixels, image_file.get_byte_size());
+
+        VulkanCommandBuffer transfer_command_buffer = transfer_command_pool.begin_one_time_submit_command_buffer(
+            std::format("Texture upload {} transfer command buffer", upload_index)
+        );
+        texture->record_copy_pixels(transfer_command_buffer, staging_region.buffer, staging_region.offset, transfer_queue_family_index, graphics_queue_family_index);
+        ST_ASSERT_THROW_VK(
+            transfer_command_buffer.end(),
+            "Could not end transfer command buffer for texture [" << texture->get_name() << "]"
+        );
+        texture_upload.transfer_command_buffer = transfer_command_buffer;
+
+        VkSemaphoreCreateInfo semaphore_create_info{};
+        semaphore_create_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+        ST_ASSERT_THROW_VK(
+            device.create_semaphore(semaphore_create_info, &texture_upload.transfer_semaphore, std::format("Texture upload {} semaphore", upload_index)),
+            "Could not create transfer semaphore for texture [" << texture->get_name() << "]"
+        );
+
+        VkSubmitInfo transfer_submit_info{};
+        transfer_submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        transfer_submit_info.commandBufferCount = 1;
+        transfer_submit_info.pCommandBuffers = &texture_upload.transfer_command_buffer;
+        transfer_submit_info.signalSemaphoreCount = 1;
+        transfer_submit_info.pSignalSemaphores = &texture_upload.transfer_semaphore;
+
+        // The staging region is only read by the copy, so it's handed back to the ring as soon as the transfer
+        // submission has completed.
+        ST_ASSERT_THROW_VK(
+            device.submit_queue(device.get_transfer_queue(), 1, &transfer_submit_info, staging_ring.submit_uploads()),
+            "Could not submit transfer commands for texture [" << texture->get_name() << "]"
+        );
+
+        //
+        // Generate the mipmap on the graphics queue once the copy has completed.
+        //
+
+        VulkanCommandBuffer graphics_command_buffer = vulkan_command_pool.begin_one_time_submit_command_buffer(
+            std::format("Texture upload {} graphics command buffer", upload_index)
+        );
+        texture->record_generate_mipmap(graphics_command_buffer, transfer_queue_family_index, graphics_queue_family_index);
+        ST_ASSERT_THROW_VK(
+            graphics_command_buffer.end(),
+            "Could not end graphics command buffer for texture [" << texture->get_name() << "]"
+        );
+        texture_upload.graphics_command_buffer = graphics_command_buffer;
+
+        VkFenceCreateInfo fence_create_info{};
+        fence_create_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+        ST_ASSERT_THROW_VK(
+            device.create_fence(fence_create_info, &texture_upload.graphics_fence, std::format("Texture upload {} fence", upload_index)),
+            "Could not create upload fence for texture [" << texture->get_name() << "]"
+        );
+
+        VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+        VkSubmitInfo graphics_submit_info{};
+        graphics_submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        graphics_submit_info.waitSemaphoreCount = 1;
+        graphics_submit_info.pWaitSemaphores = &texture_upload.transfer_semaphore;
+        graphics_submit_info.pWaitDstStageMask = &wait_stage;
+        graphics_submit_info.commandBufferCount = 1;
+        graphics_submit_info.pCommandBuffers = &texture_upload.graphics_command_buffer;
+
+        ST_ASSERT_THROW_VK(
+            device.submit_queue(device.get_graphics_queue(), 1, &graphics_submit_info, texture_upload.graphics_fence),
+            "Could not submit mipmap commands for texture [" << texture->get_name() << "]"
+        );
+
+        texture_uploads.push_back(texture_upload);
+    }
+
+    void ResourceLoader::destroy_texture_upload(const TextureUpload& texture_upload) const {
+        transfer_command_pool.free_command_buffer(texture_upload.transfer_command_buffer);
+        vulkan_command_pool.free_command_buffer(texture_upload.graphics_command_buffer);
+        config.vulkan_device.destroy_semaphore(texture_upload.transfer_semaphore);
+        config.vulkan_device.destroy_fence(texture_upload.graphics_fence);
+    }
 }
@@ -2,7 +2,10 @@
 
 #include "audio/st_audio.h"
 #include "audio/st_audio_engine.h"
+#include "graphics/st_renderer.h"
 #include "graphics/st_spritesheet.h"
+#include "graphics/st_texture_atlas.h"
+#include "graphics/st_texture_file.h"
 #include "graphics/st_vulkan_command_pool.h"
 #include "system/st_file_reader.h"
 #include "tiled/st_tiled_map.h"
@@ -16,18 +19,48 @@ namespace Storytime {
         const FileReader& file_reader;
         AudioEngine& audio_engine;
         VulkanDevice& vulkan_device;
+        Renderer& renderer;
     };
 
     class ResourceLoader {
+    private:
+        struct TextureUpload {
+            Shared<Texture> texture = nullptr;
+            VkCommandBuffer transfer_command_buffer = nullptr;
+            VkCommandBuffer graphics_command_buffer = nullptr;
+            VkSemaphore transfer_semaphore = nullptr;
+            VkFence graphics_fence = nullptr;
+        };
+
     private:
         ResourceLoaderConfig config;
         VulkanCommandPool vulkan_command_pool;
+        VulkanCommandPool transfer_command_pool;
+        std::vector<TextureUpload> texture_uploads;
+        u32 texture_upload_count = 0;
 
     public:
         ResourceLoader(const ResourceLoaderConfig& config);
 
+        ~ResourceLoader();
+
+        /// Load a texture from an image file, or from a cooked `.sttex` texture file that has a precomputed mip chain.
         Shared<Texture> load_texture(const std::filesystem::path& path) const;
 
+        /// Load a texture without waiting for its pixels to be uploaded to the GPU. The upload is copied on the
+        /// transfer queue (if the device has a dedicated one) and its mipmap is generated on the graphics queue. The
+        /// texture is drawn with the renderer's placeholder texture until `update` has seen the upload complete.
+        Shared<Texture> load_texture_async(const std::filesystem::path& path);
+
+        /// Complete the asynchronous texture uploads that have finished on the GPU. Called once per frame.
+        void update();
+
+        /// Pack images into the pages of a texture atlas. The sprites of the atlas are named by their image paths.
+        Shared<TextureAtlas> load_texture_atlas(const std::vector<std::filesystem::path>& paths, const TextureAtlasConfig& atlas_config = {}) const;
+
+        /// Pack all images in a directory (e.g. of sprites, or a Tiled image collection) into a texture atlas.
+        Shared<TextureAtlas> load_texture_atlas(const std::filesystem::path& directory_path, const TextureAtlasConfig& atlas_config = {}) const;
+
         Shared<Audio> load_audio(const std::filesystem::path& path) const;
 
         Shared<Spritesheet> load_spritesheet(const std::filesystem::path& path) const;
@@ -42,18 +75,31 @@ namespace Storytime {
 
     private:
         struct ImageFile {
+            /// Images are always loaded with four 8-bit channels (`STBI_rgb_alpha`).
+            static constexpr u32 bytes_per_pixel = 4;
+
             i32 width = 0;
             i32 height = 0;
-            i32 channels = 0;
+            i32 channels = 0; /// The channels in the file, not of the loaded pixels.
             void* pixels = nullptr;
 
             u64 get_byte_size() const {
-                return width * height * channels;
+                return (u64) width * height * bytes_per_pixel;
             }
         };
 
         ImageFile load_image(const std::filesystem::path& path) const;
 
+        Shared<Texture> load_texture_file(const std::filesystem::path& path) const;
+
+        Shared<Texture> create_texture(const std::filesystem::path& path, const ImageFile& image_file) const;
+
+        void assert_texture_dimensions(const std::filesystem::path& path, u32 width, u32 height) const;
+
+        void submit_texture_upload(const Shared<Texture>& texture, const ImageFile& image_file);
+
+        void destroy_texture_upload(const TextureUpload& texture_upload) const;
+
         void free_image(const ImageFile& image) const;
     };
 }
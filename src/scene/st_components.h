@@ -0,0 +1,32 @@
+#pragma once
+
+#include "graphics/st_texture.h"
+
+namespace Storytime {
+    struct Transform {
+        /// The position of the top left corner in world space. The Z-component is the depth.
+        glm::vec3 position = { 0.0f, 0.0f, 0.0f };
+
+        /// The rotation in radians around the Z-axis, relative to the position.
+        f32 rotation = 0.0f;
+
+        /// The size in world units.
+        glm::vec2 scale = { 1.0f, 1.0f };
+    };
+
+    struct SpriteRenderer {
+        Shared<Texture> texture = nullptr;
+
+        /// Normalized coordinates for a rectangular area on the texture to sample from (left, top, right, bottom), like
+        /// `Quad::texture_rectangle`.
+        glm::vec4 texture_rectangle = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+        /// Blended with the texture.
+        glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+        u16 layer = 0;
+
+        /// Whether the sprite is fully opaque (see `Quad::opaque`).
+        bool opaque = false;
+    };
+}
@@ -35,8 +35,9 @@ namespace Storytime {
         template<typename T>
         T& get() const {
             ST_ASSERT_VALID_ENTITY();
-            ST_ASSERT(has<T>(), "Entity [" << (u32) entity << "] must have component [" << type_name<T>() << "]");
-            return entity_registry.get<T>(entity);
+            T* component = entity_registry.try_get<T>(entity);
+            ST_ASSERT(component != nullptr, "Entity [" << (u32) entity << "] must have component [" << type_name<T>() << "]");
+            return *component;
         }
 
         template<typename T, typename... Args>
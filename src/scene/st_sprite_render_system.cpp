@@ -0,0 +1,67 @@
+#include "st_sprite_render_system.h"
+
+namespace Storytime {
+    SpriteRenderSystem::SpriteRenderSystem(const Config& config) : config(config) {
+        // Create the group up front, so that the components are arranged as they are added instead of on first render.
+        config.entity_registry.group<Transform, SpriteRenderer>();
+    }
+
+    void SpriteRenderSystem::render() const {
+        auto group = config.entity_registry.group<Transform, SpriteRenderer>();
+        u32 remaining_count = (u32) group.size();
+
+        QuadReservation reservation{};
+        const Texture* texture = nullptr;
+        u16 layer = 0;
+        bool opaque = false;
+        u32 quad_count = 0;
+
+        for (auto [entity, transform, sprite] : group.each()) {
+            // Start a new reservation when the run of sprites that share texture, layer and opacity ends, or the
+            // reserved memory is full.
+            bool same_run = quad_count > 0 && sprite.texture.get() == texture && sprite.layer == layer && sprite.opaque == opaque;
+            if (!same_run || quad_count == reservation.capacity) {
+                if (quad_count > 0) {
+                    config.renderer.commit_quads(quad_count);
+                }
+                reservation = config.renderer.reserve_quads(sprite.texture, remaining_count, sprite.layer, sprite.opaque);
+                texture = sprite.texture.get();
+                layer = sprite.layer;
+                opaque = sprite.opaque;
+                quad_count = 0;
+            }
+
+            f32 cos = glm::cos(transform.rotation);
+            f32 sin = glm::sin(transform.rotation);
+
+            QuadInstanceData& quad = reservation.quads[quad_count];
+            quad.transform = { cos * transform.scale.x, sin * transform.scale.x, -sin * transform.scale.y, cos * transform.scale.y };
+            quad.position = { transform.position.x, transform.position.y };
+            quad.depth = transform.position.z;
+            quad.color = glm::packUnorm4x8(sprite.color);
+            quad.texture_rectangle = glm::packUnorm4x16(sprite.texture_rectangle);
+            quad.texture_index = reservation.texture_index;
+            quad.layer = reservation.layer;
+
+            quad_count++;
+            remaining_count--;
+        }
+
+        if (quad_count > 0) {
+            config.renderer.commit_quads(quad_count);
+        }
+    }
+
+    void SpriteRenderSystem::sort() const {
+        auto group = config.entity_registry.group<Transform, SpriteRenderer>();
+        group.sort<SpriteRenderer>([](const SpriteRenderer& a, const SpriteRenderer& b) {
+            if (a.layer != b.layer) {
+                return a.layer < b.layer;
+            }
+            if (a.opaque != b.opaque) {
+                return a.opaque;
+            }
+            return a.texture.get() < b.texture.get();
+        });
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "graphics/st_renderer.h"
+#include "scene/st_components.h"
+
+#include <entt/entt.hpp>
+
+namespace Storytime {
+    struct SpriteRenderSystemConfig {
+        entt::registry& entity_registry;
+        Renderer& renderer;
+    };
+
+    ///
+    /// Renders all entities that have a `Transform` and a `SpriteRenderer`.
+    ///
+    /// The components are iterated with an owning group, which keeps both components of every sprite packed at the
+    /// front of their pools in the same order, so the loop reads them sequentially. Instance data is written straight
+    /// into the renderer's instance memory, one reservation per run of sprites that share texture and layer, instead
+    /// of rendering quads one by one.
+    ///
+    /// The group owns `Transform` and `SpriteRenderer`, so no other owning group may own either of them.
+    ///
+    class SpriteRenderSystem {
+    public:
+        typedef SpriteRenderSystemConfig Config;
+
+    private:
+        Config config;
+
+    public:
+        SpriteRenderSystem(const Config& config);
+
+        void render() const;
+
+        /// Sort the sprites by layer, opacity and texture, so that they are rendered in as few runs as possible. The
+        /// order is kept until sprites are added or removed, so this only needs to be called when the sprites change.
+        void sort() const;
+    };
+}
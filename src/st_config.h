@@ -7,6 +7,9 @@ namespace Storytime {
         std::string app_name = "Storytime App";
         CommandLineArguments command_line_arguments{};
         LogLevel log_level = LogLevel::info;
+        /// Directory for files written by the engine at runtime, like caches. Defaults to a per-user, per-app
+        /// directory for the platform when empty.
+        std::filesystem::path user_data_directory_path = "";
 
         // Window
         i32 window_width = 1280;
@@ -17,9 +20,26 @@ namespace Storytime {
         bool window_resizable = true;
         bool window_vsync = false;
 
+        // Headless
+        bool headless = false; // Render to offscreen images without a display, f.ex. for benchmarks and golden image tests on CI.
+        u32 headless_frame_count = 0; // Stop after rendering this many frames (0 = run until stopped).
+        std::filesystem::path headless_frame_file_path = ""; // Save the last frame to this PNG file when stopping (empty = disabled).
+
         // Renderer
         u32 rendering_buffer_count = 3;
         glm::vec4 rendering_clear_color = { 0.0f, 0.0f, 0.0f, 1.0f };
+        bool rendering_direct_instance_writes_enabled = true;
+        bool rendering_bindless_textures_enabled = true;
+        bool rendering_deferred_enabled = false;
+        bool rendering_quad_culling_enabled = false;
+        bool rendering_indirect_draws_enabled = true;
+        u32 rendering_internal_width = 0; // Render to an offscreen target of this size, and upscale it to the window (0 = disabled).
+        u32 rendering_internal_height = 0;
+        bool rendering_integer_scaling_enabled = true;
+        bool rendering_gpu_timestamps_enabled = true;
+        bool rendering_gpu_draw_timestamps_enabled = false; // Time every draw of quad batches, see `Metrics::gpu_draw_durations_ms`.
+        bool rendering_pipeline_cache_enabled = true;
+        std::filesystem::path rendering_pipeline_cache_file_name = "pipeline_cache.bin";
         std::string vulkan_app_name = "Storytime";
         std::string vulkan_engine_name = "Storytime Engine";
         u32 vulkan_app_version = VK_MAKE_API_VERSION(0, 1, 0, 0);
@@ -2,13 +2,17 @@
 
 #include "st_app.h"
 #include "event/st_window_closed_event.h"
-#include "system/st_clock.h"
 
 namespace Storytime {
     typedef Renderer Renderer;
 
     Engine::Engine(const Config& config)
-        : service_locator(),
+        : start_time(Time::now()),
+          user_data_directory_path(get_user_data_directory_path(config)),
+          headless(config.headless),
+          headless_frame_count(config.headless_frame_count),
+          headless_frame_file_path(config.headless_frame_file_path),
+          service_locator(),
           dispatcher(),
           window({
               .dispatcher = dispatcher,
@@ -20,6 +24,7 @@ namespace Storytime {
               .maximized = config.window_maximized,
               .resizable = config.window_resizable,
               .vsync = config.window_vsync,
+              .headless = config.headless,
           }),
           keyboard({
               .window = window,
@@ -38,6 +43,7 @@ namespace Storytime {
               .engine_name = config.vulkan_engine_name.size() > 0 ? config.vulkan_engine_name : std::format("{} Engine", config.app_name),
               .engine_version = config.vulkan_engine_version,
               .validation_layers_enabled = config.vulkan_validation_layers_enabled,
+              .headless = config.headless,
           }),
           vulkan_physical_device({
               .context = vulkan_context,
@@ -45,6 +51,8 @@ namespace Storytime {
           vulkan_device({
               .name = std::format("{} device", config.app_name),
               .physical_device = vulkan_physical_device,
+              .descriptor_indexing_enabled = config.rendering_bindless_textures_enabled,
+              .pipeline_cache_file_path = config.rendering_pipeline_cache_enabled ? user_data_directory_path / config.rendering_pipeline_cache_file_name : std::filesystem::path(),
           }),
           vulkan_swapchain({
               .name = std::format("{} swapchain", config.app_name),
@@ -54,6 +62,8 @@ namespace Storytime {
               .surface = vulkan_context.get_surface(),
               .clear_color = config.rendering_clear_color,
               .vsync_enabled = config.vsync_enabled,
+              .headless = config.headless,
+              .offscreen_image_count = config.rendering_buffer_count,
           }),
           renderer({
               .name = std::format("{} renderer", config.app_name),
@@ -65,6 +75,15 @@ namespace Storytime {
               .device = vulkan_device,
               .swapchain = vulkan_swapchain,
               .frame_count = config.rendering_buffer_count,
+              .direct_instance_writes_enabled = config.rendering_direct_instance_writes_enabled,
+              .deferred_rendering_enabled = config.rendering_deferred_enabled,
+              .quad_culling_enabled = config.rendering_quad_culling_enabled,
+              .indirect_draws_enabled = config.rendering_indirect_draws_enabled,
+              .internal_width = config.rendering_internal_width,
+              .internal_height = config.rendering_internal_height,
+              .integer_scaling_enabled = config.rendering_integer_scaling_enabled,
+              .gpu_timestamps_enabled = config.rendering_gpu_timestamps_enabled,
+              .gpu_draw_timestamps_enabled = config.rendering_gpu_draw_timestamps_enabled,
           }),
           imgui_renderer({
               .name = std::format("{} imgui renderer", config.app_name),
@@ -79,13 +98,14 @@ namespace Storytime {
               .frame_count = config.rendering_buffer_count,
               .settings_file_path = config.imgui_settings_file_path,
               .docking_enabled = config.imgui_docking_enabled,
-              .viewports_enabled = config.imgui_viewports_enabled,
+              .viewports_enabled = config.imgui_viewports_enabled && !config.headless, // Viewports are platform windows.
           }),
           audio_engine(),
           resource_loader({
               .file_reader = file_reader,
               .audio_engine = audio_engine,
               .vulkan_device = vulkan_device,
+              .renderer = renderer,
           }),
           process_manager()
     {
@@ -110,6 +130,9 @@ namespace Storytime {
         running = true;
         game_loop(app);
         renderer.wait_until_idle();
+        if (headless && !headless_frame_file_path.empty()) {
+            renderer.save_frame(headless_frame_file_path);
+        }
     }
 
     void Engine::stop() {
@@ -127,6 +150,13 @@ namespace Storytime {
         // Use the duration of the last game loop cycle to increment game clock lag
         TimePoint last_cycle_start_time = Time::now();
 
+        bool first_frame_rendered = false;
+
+        // Totals of headless runs, to report render throughput when the loop ends.
+        u32 rendered_frame_count = 0;
+        u64 rendered_quad_count = 0;
+        f64 total_render_duration_ms = 0.0;
+
         while (running) {
 
             //
@@ -142,6 +172,12 @@ namespace Storytime {
                 last_cycle_duration_ms = timestep_ms;
             }
 
+            // Headless runs advance the game clock by exactly one timestep per cycle, so that the same frames are
+            // rendered regardless of how fast the device can render them.
+            if (headless) {
+                last_cycle_duration_ms = timestep_ms;
+            }
+
             last_cycle_start_time = cycle_start_time;
             game_clock_lag_ms += last_cycle_duration_ms;
 
@@ -153,6 +189,9 @@ namespace Storytime {
             window.poll_events();
             TimePoint window_event_end_time = Time::now();
 
+            // Make textures that finished uploading since the last cycle available to the game.
+            resource_loader.update();
+
             //
             // UPDATE
             //
@@ -195,10 +234,17 @@ namespace Storytime {
                 imgui_render_start_time = Time::now();
                 imgui_renderer.begin_render();
                 app.render_imgui();
+                renderer.write_gpu_timestamp(GpuTimestamp::IMGUI_BEGIN);
                 imgui_renderer.end_render(frame->command_buffer);
+                renderer.write_gpu_timestamp(GpuTimestamp::IMGUI_END);
                 imgui_render_end_time = Time::now();
 
                 renderer.end_frame();
+
+                if (!first_frame_rendered) {
+                    first_frame_rendered = true;
+                    ST_LOG_I("Time to first frame: {} ms", Time::as<Microseconds>(Time::now() - start_time).count() / 1000.0);
+                }
             }
             TimePoint render_end_time = Time::now();
 
@@ -223,10 +269,61 @@ namespace Storytime {
                 metrics.imgui_render_duration_ms = Time::as<Microseconds>(imgui_render_end_time - imgui_render_start_time).count() / 1000.0;
                 metrics.scene_render_duration_ms = Time::as<Microseconds>(scene_render_end_time - scene_render_start_time).count() / 1000.0;
                 metrics.frames_per_second = 1.0 / (metrics.render_duration_ms / 1000.0);
+
+                rendered_frame_count++;
+                rendered_quad_count += metrics.quad_count;
+                total_render_duration_ms += metrics.render_duration_ms;
+                if (headless && headless_frame_count > 0 && rendered_frame_count >= headless_frame_count) {
+                    running = false;
+                }
             }
 
+            VulkanMemoryStats memory_stats = vulkan_device.get_memory_allocator().get_stats();
+            metrics.memory_block_count = memory_stats.block_count;
+            metrics.memory_allocation_count = memory_stats.allocation_count;
+            metrics.memory_reserved_bytes = memory_stats.reserved_bytes;
+            metrics.memory_used_bytes = memory_stats.used_bytes;
+            metrics.memory_fragmentation = memory_stats.fragmentation;
+
             metrics.window_events_duration_ms = Time::as<Microseconds>(window_event_end_time - window_event_start_time).count() / 1000.0;
             metrics.cycle_duration_ms = Time::as<Microseconds>(cycle_end_time - cycle_start_time).count() / 1000.0;
         }
+
+        if (headless && rendered_frame_count > 0) {
+            ST_LOG_I(
+                "Rendered [{}] frames headless: {} ms/frame, {} quads/s",
+                rendered_frame_count,
+                total_render_duration_ms / rendered_frame_count,
+                rendered_quad_count / (total_render_duration_ms / 1000.0)
+            );
+        }
+    }
+
+    std::filesystem::path Engine::get_user_data_directory_path(const Config& config) {
+        if (!config.user_data_directory_path.empty()) {
+            return config.user_data_directory_path;
+        }
+#if defined(ST_PLATFORM_WINDOWS)
+        const char* base_directory = std::getenv("LOCALAPPDATA");
+        if (base_directory != nullptr) {
+            return std::filesystem::path(base_directory) / config.app_name;
+        }
+#elif defined(ST_PLATFORM_MACOS)
+        const char* home_directory = std::getenv("HOME");
+        if (home_directory != nullptr) {
+            return std::filesystem::path(home_directory) / "Library" / "Application Support" / config.app_name;
+        }
+#else
+        const char* base_directory = std::getenv("XDG_DATA_HOME");
+        if (base_directory != nullptr && base_directory[0] != '\0') {
+            return std::filesystem::path(base_directory) / config.app_name;
+        }
+        const char* home_directory = std::getenv("HOME");
+        if (home_directory != nullptr) {
+            return std::filesystem::path(home_directory) / ".local" / "share" / config.app_name;
+        }
+#endif
+        ST_LOG_W("Could not find user data directory, using working directory");
+        return std::filesystem::current_path() / ".storytime";
     }
 }
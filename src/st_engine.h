@@ -14,6 +14,7 @@
 #include "system/st_dispatcher.h"
 #include "system/st_file_reader.h"
 #include "system/st_metrics.h"
+#include "system/st_clock.h"
 #include "system/st_service_locator.h"
 #include "window/st_keyboard.h"
 #include "window/st_mouse.h"
@@ -24,6 +25,11 @@ namespace Storytime {
         friend class Storytime;
 
     private:
+        TimePoint start_time;
+        std::filesystem::path user_data_directory_path;
+        bool headless = false;
+        u32 headless_frame_count = 0;
+        std::filesystem::path headless_frame_file_path;
         bool running = false;
         ServiceLocator service_locator;
         Dispatcher dispatcher;
@@ -63,5 +69,7 @@ namespace Storytime {
 
     private:
         void game_loop(App& app);
+
+        static std::filesystem::path get_user_data_directory_path(const Config& config);
     };
 }
@@ -7,11 +7,15 @@
 #include <algorithm>
 #include <any>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <deque>
 #include <expected>
 #include <filesystem>
 #include <iostream>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <map>
 #include <print>
 #include <ranges>
@@ -21,6 +25,7 @@
 #include <string>
 #include <string_view>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // --------------------------------------------------------------------------------------------------------------
@@ -43,6 +48,7 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 
@@ -0,0 +1,157 @@
+#include "st_mapped_file.h"
+
+#if defined(ST_PLATFORM_WINDOWS)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#elif defined(ST_PLATFORM_UNIX)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace Storytime {
+    MappedFile::MappedFile(const std::filesystem::path& path) : path(path) {
+        map();
+    }
+
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : path(std::move(other.path)),
+          data(other.data),
+          size(other.size)
+#ifdef ST_PLATFORM_WINDOWS
+          , file_handle(other.file_handle),
+          mapping_handle(other.mapping_handle)
+#endif
+    {
+        other.data = nullptr;
+        other.size = 0;
+#ifdef ST_PLATFORM_WINDOWS
+        other.file_handle = nullptr;
+        other.mapping_handle = nullptr;
+#endif
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            path = std::move(other.path);
+            data = other.data;
+            size = other.size;
+            other.data = nullptr;
+            other.size = 0;
+#ifdef ST_PLATFORM_WINDOWS
+            file_handle = other.file_handle;
+            mapping_handle = other.mapping_handle;
+            other.file_handle = nullptr;
+            other.mapping_handle = nullptr;
+#endif
+        }
+        return *this;
+    }
+
+    const std::filesystem::path& MappedFile::get_path() const {
+        return path;
+    }
+
+    const void* MappedFile::get_data() const {
+        return data;
+    }
+
+    u64 MappedFile::get_size() const {
+        return size;
+    }
+
+#if defined(ST_PLATFORM_WINDOWS)
+
+    void MappedFile::map() {
+        file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE) {
+            file_handle = nullptr;
+            ST_THROW("Could not open file [" << path << "]");
+        }
+
+        LARGE_INTEGER file_size{};
+        if (!GetFileSizeEx(file_handle, &file_size)) {
+            unmap();
+            ST_THROW("Could not get size of file [" << path << "]");
+        }
+        size = (u64) file_size.QuadPart;
+        if (size == 0) {
+            return;
+        }
+
+        mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle == nullptr) {
+            unmap();
+            ST_THROW("Could not create mapping of file [" << path << "]");
+        }
+
+        data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+        if (data == nullptr) {
+            unmap();
+            ST_THROW("Could not map file [" << path << "]");
+        }
+    }
+
+    void MappedFile::unmap() {
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+            data = nullptr;
+        }
+        if (mapping_handle != nullptr) {
+            CloseHandle(mapping_handle);
+            mapping_handle = nullptr;
+        }
+        if (file_handle != nullptr) {
+            CloseHandle(file_handle);
+            file_handle = nullptr;
+        }
+        size = 0;
+    }
+
+#elif defined(ST_PLATFORM_UNIX)
+
+    void MappedFile::map() {
+        int file_descriptor = open(path.c_str(), O_RDONLY);
+        if (file_descriptor == -1) {
+            ST_THROW("Could not open file [" << path << "]: " << strerror(errno));
+        }
+
+        struct stat file_stat{};
+        if (fstat(file_descriptor, &file_stat) == -1) {
+            close(file_descriptor);
+            ST_THROW("Could not get size of file [" << path << "]: " << strerror(errno));
+        }
+        size = (u64) file_stat.st_size;
+        if (size == 0) {
+            close(file_descriptor);
+            return;
+        }
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+
+        // The mapping keeps its own reference to the file, so the descriptor is not needed after the file is mapped.
+        close(file_descriptor);
+
+        if (mapping == MAP_FAILED) {
+            size = 0;
+            ST_THROW("Could not map file [" << path << "]: " << strerror(errno));
+        }
+        data = mapping;
+    }
+
+    void MappedFile::unmap() {
+        if (data != nullptr) {
+            munmap(const_cast<void*>(data), size);
+            data = nullptr;
+        }
+        size = 0;
+    }
+
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+namespace Storytime {
+    ///
+    /// A read-only memory mapping of a whole file.
+    ///
+    /// The pages of the file are loaded by the OS as they are accessed, so reading a file through a mapping doesn't
+    /// copy it into a heap allocation first.
+    ///
+    class MappedFile {
+    private:
+        std::filesystem::path path;
+        const void* data = nullptr;
+        u64 size = 0;
+#ifdef ST_PLATFORM_WINDOWS
+        void* file_handle = nullptr;
+        void* mapping_handle = nullptr;
+#endif
+
+    public:
+        MappedFile() = default;
+
+        MappedFile(const std::filesystem::path& path);
+
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+
+        MappedFile(const MappedFile& other) = delete;
+
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        MappedFile& operator=(const MappedFile& other) = delete;
+
+        const std::filesystem::path& get_path() const;
+
+        const void* get_data() const;
+
+        u64 get_size() const;
+
+    private:
+        void map();
+
+        void unmap();
+    };
+}
@@ -20,5 +20,28 @@ namespace Storytime {
         u64 vertex_count = 0;
         u64 index_count = 0;
         u64 texture_count = 0;
+        u64 instance_bytes_uploaded = 0;
+        u64 batch_count = 0;             // Batches allocated across all frames in flight
+        u64 batch_high_water_mark = 0;   // Most batches used by a single frame
+        f64 quad_sort_duration_ms = 0.0; // Time spent sorting deferred quads and adding them to batches
+        u64 visible_quad_count = 0;      // Quads that passed the culling test
+        u64 culled_quad_count = 0;       // Quads that were skipped because they were outside of the view
+        u64 static_quad_count = 0;       // Quads drawn from static batches
+        u64 tile_count = 0;              // Tiles drawn from tile layers
+        u64 descriptor_writes = 0;       // Descriptor set updates (vkUpdateDescriptorSets)
+
+        // GPU (measured with timestamp queries, and as many frames behind as there are frames in flight)
+        f64 gpu_frame_duration_ms = 0.0;          // The whole command buffer of the frame
+        f64 gpu_scene_render_duration_ms = 0.0;   // From `Renderer::begin_render` to `Renderer::end_render`
+        f64 gpu_imgui_render_duration_ms = 0.0;
+        f64 gpu_draw_duration_ms = 0.0;           // Sum of the timed draws of quad batches, when draws are timed
+        std::vector<f64> gpu_draw_durations_ms{}; // Every timed draw of quad batches, in draw order
+
+        // Device memory
+        u64 memory_block_count = 0;      // Device memory allocations made by the memory allocator
+        u64 memory_allocation_count = 0; // Buffers and images sub-allocated from the blocks
+        u64 memory_reserved_bytes = 0;   // Total size of the blocks
+        u64 memory_used_bytes = 0;       // Bytes of the blocks in use by buffers and images
+        f64 memory_fragmentation = 0.0;  // 0 when the free memory of the blocks is contiguous, approaching 1 as it is split up
     };
 }
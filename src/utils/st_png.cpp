@@ -0,0 +1,132 @@
+#include "st_png.h"
+
+#include <fstream>
+
+namespace Storytime {
+    static constexpr std::array<u8, 8> png_signature = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    // The largest amount of data a stored (uncompressed) deflate block can hold.
+    static constexpr u32 max_stored_block_size = 0xFFFF;
+
+    static std::array<u32, 256> create_crc_table() {
+        std::array<u32, 256> crc_table{};
+        for (u32 i = 0; i < crc_table.size(); i++) {
+            u32 crc = i;
+            for (u32 bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? 0xEDB88320 ^ (crc >> 1) : crc >> 1;
+            }
+            crc_table[i] = crc;
+        }
+        return crc_table;
+    }
+
+    static u32 update_crc(u32 crc, const u8* data, u64 size) {
+        static const std::array<u32, 256> crc_table = create_crc_table();
+        for (u64 i = 0; i < size; i++) {
+            crc = crc_table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+    static u32 get_adler32(const u8* data, u64 size) {
+        // The largest number of bytes that can be summed before the sums must be reduced to not overflow 32 bits.
+        constexpr u64 max_run_size = 5552;
+        constexpr u32 modulus = 65521;
+        u32 a = 1;
+        u32 b = 0;
+        while (size > 0) {
+            u64 run_size = std::min(size, max_run_size);
+            for (u64 i = 0; i < run_size; i++) {
+                a += data[i];
+                b += a;
+            }
+            a %= modulus;
+            b %= modulus;
+            data += run_size;
+            size -= run_size;
+        }
+        return (b << 16) | a;
+    }
+
+    static void append_u32_big_endian(std::vector<u8>& bytes, u32 value) {
+        bytes.push_back((u8) (value >> 24));
+        bytes.push_back((u8) (value >> 16));
+        bytes.push_back((u8) (value >> 8));
+        bytes.push_back((u8) value);
+    }
+
+    static void write_chunk(std::ofstream& output_stream, const char* type, const std::vector<u8>& data) {
+        std::vector<u8> chunk;
+        chunk.reserve(data.size() + 12);
+        append_u32_big_endian(chunk, (u32) data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+
+        // The checksum covers the chunk type and data, but not the length.
+        u32 crc = update_crc(0xFFFFFFFF, chunk.data() + 4, data.size() + 4) ^ 0xFFFFFFFF;
+        append_u32_big_endian(chunk, crc);
+
+        output_stream.write((const char*) chunk.data(), (std::streamsize) chunk.size());
+    }
+
+    void write_png(const std::filesystem::path& path, u32 width, u32 height, const u8* pixels) {
+        ST_ASSERT_GREATER_THAN_ZERO(width);
+        ST_ASSERT_GREATER_THAN_ZERO(height);
+        ST_ASSERT_NOT_NULL(pixels);
+
+        constexpr u32 bytes_per_pixel = 4;
+        u64 row_size = (u64) width * bytes_per_pixel;
+
+        // Every row is prefixed with the filter type it has been encoded with, which is none.
+        std::vector<u8> scanlines;
+        scanlines.reserve((row_size + 1) * height);
+        for (u32 y = 0; y < height; y++) {
+            const u8* row = pixels + y * row_size;
+            scanlines.push_back(0);
+            scanlines.insert(scanlines.end(), row, row + row_size);
+        }
+
+        std::vector<u8> header;
+        append_u32_big_endian(header, width);
+        append_u32_big_endian(header, height);
+        header.push_back(8); // Bit depth
+        header.push_back(6); // Color type (RGBA)
+        header.push_back(0); // Compression method (deflate)
+        header.push_back(0); // Filter method
+        header.push_back(0); // Interlace method (none)
+
+        // A zlib stream of stored deflate blocks: a two byte header with the compression method and window size, the
+        // blocks, and a checksum of the uncompressed data.
+        u64 block_count = (scanlines.size() + max_stored_block_size - 1) / max_stored_block_size;
+        std::vector<u8> image_data;
+        image_data.reserve(2 + scanlines.size() + block_count * 5 + 4);
+        image_data.push_back(0x78);
+        image_data.push_back(0x01);
+        for (u64 offset = 0; offset < scanlines.size(); offset += max_stored_block_size) {
+            u16 block_size = (u16) std::min<u64>(scanlines.size() - offset, max_stored_block_size);
+            u16 inverted_block_size = (u16) ~block_size;
+            bool last_block = offset + block_size == scanlines.size();
+            image_data.push_back(last_block ? 1 : 0);
+            image_data.push_back((u8) block_size);
+            image_data.push_back((u8) (block_size >> 8));
+            image_data.push_back((u8) inverted_block_size);
+            image_data.push_back((u8) (inverted_block_size >> 8));
+            image_data.insert(image_data.end(), scanlines.begin() + offset, scanlines.begin() + offset + block_size);
+        }
+        append_u32_big_endian(image_data, get_adler32(scanlines.data(), scanlines.size()));
+
+        std::ofstream output_stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!output_stream) {
+            ST_THROW("Could not open PNG file [" << path << "] for writing");
+        }
+
+        output_stream.write((const char*) png_signature.data(), (std::streamsize) png_signature.size());
+        write_chunk(output_stream, "IHDR", header);
+        write_chunk(output_stream, "IDAT", image_data);
+        write_chunk(output_stream, "IEND", {});
+
+        if (!output_stream) {
+            ST_THROW("Could not write PNG file [" << path << "]");
+        }
+    }
+}
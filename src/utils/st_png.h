@@ -0,0 +1,14 @@
+#pragma once
+
+namespace Storytime {
+    /// Write 8-bit RGBA pixels to a PNG file.
+    ///
+    /// The image data is stored without compression, which keeps the encoder small and makes it fast enough to write
+    /// frames from tests and benchmarks, at the cost of files that are about as large as the pixels themselves.
+    ///
+    /// @param path The file to write, which is replaced if it exists
+    /// @param width The width of the image in pixels
+    /// @param height The height of the image in pixels
+    /// @param pixels Tightly packed rows of RGBA pixels, from the top row to the bottom row
+    void write_png(const std::filesystem::path& path, u32 width, u32 height, const u8* pixels);
+}
@@ -0,0 +1,61 @@
+#include "st_radix_sort.h"
+
+namespace Storytime {
+    void radix_sort(std::vector<RadixSortEntry>& entries, std::vector<RadixSortEntry>& scratch) {
+        constexpr u32 bits_per_digit = 8;
+        constexpr u32 bucket_count = 1 << bits_per_digit;
+        constexpr u32 digit_mask = bucket_count - 1;
+        constexpr u32 pass_count = (sizeof(u64) * 8) / bits_per_digit;
+
+        if (entries.size() <= 1) {
+            return;
+        }
+        ST_ASSERT(entries.size() <= std::numeric_limits<u32>::max(), "Entry count [" << entries.size() << "] must fit in 32 bits");
+        u32 entry_count = (u32) entries.size();
+
+        // Count the occurrences of every digit for all passes in a single read of the entries.
+        std::array<std::array<u32, bucket_count>, pass_count> histograms{};
+        for (const RadixSortEntry& entry : entries) {
+            for (u32 pass = 0; pass < pass_count; pass++) {
+                histograms[pass][(entry.key >> (pass * bits_per_digit)) & digit_mask]++;
+            }
+        }
+
+        scratch.resize(entry_count);
+
+        RadixSortEntry* source = entries.data();
+        RadixSortEntry* destination = scratch.data();
+        u32 sorted_pass_count = 0;
+
+        for (u32 pass = 0; pass < pass_count; pass++) {
+            u32 shift = pass * bits_per_digit;
+            const std::array<u32, bucket_count>& histogram = histograms[pass];
+
+            // All keys have the same digit, so this pass would not change the order of the entries.
+            if (histogram[(source[0].key >> shift) & digit_mask] == entry_count) {
+                continue;
+            }
+
+            // Exclusive prefix sum of the histogram gives the first destination index of every digit.
+            std::array<u32, bucket_count> offsets;
+            u32 offset = 0;
+            for (u32 i = 0; i < bucket_count; i++) {
+                offsets[i] = offset;
+                offset += histogram[i];
+            }
+
+            for (u32 i = 0; i < entry_count; i++) {
+                const RadixSortEntry& entry = source[i];
+                destination[offsets[(entry.key >> shift) & digit_mask]++] = entry;
+            }
+
+            std::swap(source, destination);
+            sorted_pass_count++;
+        }
+
+        // After an odd number of passes, the sorted entries are in the scratch buffer.
+        if (sorted_pass_count % 2 != 0) {
+            entries.swap(scratch);
+        }
+    }
+}
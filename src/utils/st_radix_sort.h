@@ -0,0 +1,19 @@
+#pragma once
+
+namespace Storytime {
+    /// An entry to be sorted by `radix_sort`. The index typically refers to an element in another container, so the
+    /// (potentially large) elements themselves never have to be moved while sorting.
+    struct RadixSortEntry {
+        u64 key = 0;
+        u32 index = 0;
+    };
+
+    /// Sort entries in ascending order by their key, using a least-significant-digit radix sort with 8-bit digits.
+    ///
+    /// The sort is stable, so entries with equal keys keep their relative order. Digits that are the same for all keys
+    /// are skipped, which makes sorting keys that only use some of their bits (f.ex. few distinct high bits) cheaper.
+    ///
+    /// @param entries The entries to sort
+    /// @param scratch A buffer to sort into, resized to the entry count. Reuse it between calls to avoid allocating.
+    void radix_sort(std::vector<RadixSortEntry>& entries, std::vector<RadixSortEntry>& scratch);
+}
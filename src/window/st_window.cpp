@@ -20,6 +20,12 @@ namespace Storytime {
         ST_ASSERT(config.height > 0 || config.aspect_ratio > 0.0f, "Window height or aspect ratio must be greater than zero");
         i32 height = config.aspect_ratio > 0.0f ? (f32) config.width / config.aspect_ratio : config.height;
 
+        // The null platform runs without a display server and its windows are never shown, but they still have a size
+        // and process events, so the input and ImGui code paths work the same as with a real window.
+        if (config.headless) {
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+        }
+
         ST_LOG_TRACE("Initializing GLFW");
         if (!glfwInit()) {
             ST_THROW("Could not initialize GLFW");
@@ -24,6 +24,7 @@ namespace Storytime {
         bool maximized;
         bool resizable;
         bool vsync;
+        bool headless; // Use a window that is never shown, on a platform that does not need a display.
         u32 context_version_major;
         u32 context_version_minor;
     };
@@ -0,0 +1,343 @@
+//
+// Memory allocator stress test
+//
+// Allocates and frees buffers and images in random patterns through a `VulkanMemoryAllocator` with small blocks, so
+// that blocks are created, shared, emptied and released all the time. After every step, the live allocations are
+// checked to be aligned and to never overlap, and the stats of the allocator must add up. Host visible allocations are
+// filled with a pattern that must still be intact when they are freed.
+//
+// The device is created headless, so the test also runs on a software device without a display, f.ex. lavapipe:
+//
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json st_memory_allocator_stress --iterations 100000
+//
+// Usage: st_memory_allocator_stress [--iterations <count>] [--seed <seed>] [--validation]
+//
+
+#include "graphics/st_vulkan_context.h"
+#include "graphics/st_vulkan_device.h"
+#include "graphics/st_vulkan_physical_device.h"
+#include "graphics/st_vulkan_utils.h"
+#include "system/st_dispatcher.h"
+#include "window/st_window.h"
+
+#include <charconv>
+#include <cstring>
+#include <random>
+
+namespace Storytime {
+    struct MemoryAllocatorStressOptions {
+        u32 iterations = 10000;
+        u32 seed = 1;
+        bool validation_layers_enabled = false;
+    };
+
+    struct StressResource {
+        VulkanMemoryResourceType resource_type = VulkanMemoryResourceType::BUFFER;
+        VulkanMemoryUsage usage = VulkanMemoryUsage::PERSISTENT;
+        VkBuffer buffer = nullptr;
+        VkImage image = nullptr;
+        VulkanAllocation allocation{};
+        VkDeviceSize alignment = 0;
+        u8 pattern = 0;
+    };
+
+    // Small blocks, so that a moderate number of resources spans many blocks and resources larger than half a block
+    // get dedicated blocks.
+    static constexpr VkDeviceSize persistent_block_size = 4 * 1024 * 1024;
+    static constexpr VkDeviceSize transient_block_size = 1024 * 1024;
+
+    static constexpr u32 max_live_resource_count = 512;
+
+    class MemoryAllocatorStress {
+    private:
+        const VulkanDevice& device;
+        VulkanMemoryAllocator allocator;
+        std::mt19937 generator;
+        std::vector<StressResource> resources;
+        u32 allocation_count = 0;
+        u32 free_count = 0;
+
+    public:
+        MemoryAllocatorStress(const VulkanDevice& device, u32 seed)
+            : device(device),
+              allocator({
+                  .device = device,
+                  .name = "Stress test memory allocator",
+                  .persistent_block_size = persistent_block_size,
+                  .transient_block_size = transient_block_size,
+              }),
+              generator(seed)
+        {
+        }
+
+        ~MemoryAllocatorStress() {
+            for (const StressResource& resource : resources) {
+                destroy_resource(resource);
+            }
+        }
+
+        void run(u32 iterations) {
+            for (u32 i = 0; i < iterations; i++) {
+                // Alternate between phases that mostly allocate and phases that mostly free, so that the live set
+                // grows and shrinks and blocks are emptied and released.
+                bool growing = (i / 1000) % 2 == 0;
+                f32 allocate_probability = growing ? 0.7f : 0.3f;
+                if (resources.empty() || (resources.size() < max_live_resource_count && get_float() < allocate_probability)) {
+                    resources.push_back(create_resource());
+                    allocation_count++;
+                } else {
+                    u32 index = get_int(0, (u32) resources.size() - 1);
+                    free_resource(resources[index]);
+                    resources[index] = resources.back();
+                    resources.pop_back();
+                    free_count++;
+                }
+                check_invariants(i);
+            }
+
+            for (const StressResource& resource : resources) {
+                free_resource(resource);
+                free_count++;
+            }
+            resources.clear();
+
+            VulkanMemoryStats stats = allocator.get_stats();
+            if (stats.allocation_count != 0 || stats.used_bytes != 0) {
+                ST_THROW("Allocator must be empty after freeing all resources, but has [" << stats.allocation_count << "] allocations of [" << stats.used_bytes << "] bytes");
+            }
+            if (stats.dedicated_block_count != 0) {
+                ST_THROW("Allocator must have released all dedicated blocks, but has [" << stats.dedicated_block_count << "]");
+            }
+            ST_LOG_I("Made [{}] allocations and [{}] frees, [{}] blocks of [{}] bytes are kept for reuse", allocation_count, free_count, stats.block_count, stats.reserved_bytes);
+        }
+
+    private:
+        StressResource create_resource() {
+            StressResource resource{};
+            resource.resource_type = get_float() < 0.75f ? VulkanMemoryResourceType::BUFFER : VulkanMemoryResourceType::IMAGE;
+            resource.usage = get_float() < 0.7f ? VulkanMemoryUsage::PERSISTENT : VulkanMemoryUsage::TRANSIENT;
+            resource.pattern = (u8) get_int(1, 255);
+
+            VkMemoryRequirements memory_requirements{};
+            VkMemoryPropertyFlags memory_properties = 0;
+
+            if (resource.resource_type == VulkanMemoryResourceType::BUFFER) {
+                VkBufferCreateInfo buffer_create_info{};
+                buffer_create_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+                buffer_create_info.size = get_buffer_size(resource.usage);
+                buffer_create_info.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+                buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                ST_ASSERT_THROW_VK(
+                    device.create_buffer(buffer_create_info, &resource.buffer, "Stress test buffer"),
+                    "Could not create stress test buffer of size [" << buffer_create_info.size << "]"
+                );
+                memory_requirements = device.get_buffer_memory_requirements(resource.buffer);
+
+                // Transient buffers are staging buffers. Persistent buffers are either mapped or device local.
+                bool host_visible = resource.usage == VulkanMemoryUsage::TRANSIENT || get_float() < 0.5f;
+                memory_properties = host_visible ? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            } else {
+                VkImageCreateInfo image_create_info{};
+                image_create_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+                image_create_info.imageType = VK_IMAGE_TYPE_2D;
+                image_create_info.extent.width = get_int(1, 512);
+                image_create_info.extent.height = get_int(1, 512);
+                image_create_info.extent.depth = 1;
+                image_create_info.mipLevels = 1;
+                image_create_info.arrayLayers = 1;
+                image_create_info.format = VK_FORMAT_R8G8B8A8_UNORM;
+                image_create_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+                image_create_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+                image_create_info.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+                image_create_info.samples = VK_SAMPLE_COUNT_1_BIT;
+                image_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+                ST_ASSERT_THROW_VK(
+                    device.create_image(image_create_info, &resource.image, "Stress test image"),
+                    "Could not create stress test image of size [" << image_create_info.extent.width << "x" << image_create_info.extent.height << "]"
+                );
+                memory_requirements = device.get_image_memory_requirements(resource.image);
+                memory_properties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+            }
+
+            resource.alignment = memory_requirements.alignment;
+            resource.allocation = allocator.allocate(memory_requirements, memory_properties, resource.resource_type, resource.usage);
+
+            if (resource.resource_type == VulkanMemoryResourceType::BUFFER) {
+                ST_ASSERT_THROW_VK(
+                    device.bind_buffer_memory(resource.buffer, resource.allocation.memory, resource.allocation.offset),
+                    "Could not bind stress test buffer memory at offset [" << resource.allocation.offset << "]"
+                );
+            } else {
+                ST_ASSERT_THROW_VK(
+                    device.bind_image_memory(resource.image, resource.allocation.memory, resource.allocation.offset),
+                    "Could not bind stress test image memory at offset [" << resource.allocation.offset << "]"
+                );
+            }
+
+            if (resource.allocation.data != nullptr) {
+                memset(resource.allocation.data, resource.pattern, resource.allocation.size);
+            }
+            return resource;
+        }
+
+        void free_resource(const StressResource& resource) {
+            // Any allocation that overlapped this one would have overwritten its pattern.
+            if (resource.allocation.data != nullptr) {
+                const u8* data = (const u8*) resource.allocation.data;
+                for (VkDeviceSize i = 0; i < resource.allocation.size; i++) {
+                    if (data[i] != resource.pattern) {
+                        ST_THROW("Allocation at offset [" << resource.allocation.offset << "] of size [" << resource.allocation.size << "] was overwritten at byte [" << i << "]");
+                    }
+                }
+            }
+            destroy_resource(resource);
+            allocator.free(resource.allocation);
+        }
+
+        void destroy_resource(const StressResource& resource) const {
+            if (resource.buffer != nullptr) {
+                device.destroy_buffer(resource.buffer);
+            }
+            if (resource.image != nullptr) {
+                device.destroy_image(resource.image);
+            }
+        }
+
+        void check_invariants(u32 iteration) const {
+            VulkanMemoryStats stats = allocator.get_stats();
+
+            VkDeviceSize used_bytes = 0;
+            for (const StressResource& resource : resources) {
+                used_bytes += resource.allocation.size;
+            }
+            if (stats.allocation_count != resources.size()) {
+                ST_THROW("Iteration [" << iteration << "]: allocator has [" << stats.allocation_count << "] allocations but [" << resources.size() << "] are live");
+            }
+            if (stats.used_bytes != used_bytes) {
+                ST_THROW("Iteration [" << iteration << "]: allocator uses [" << stats.used_bytes << "] bytes but [" << used_bytes << "] are live");
+            }
+            if (stats.used_bytes > stats.reserved_bytes) {
+                ST_THROW("Iteration [" << iteration << "]: allocator uses [" << stats.used_bytes << "] bytes but only reserves [" << stats.reserved_bytes << "]");
+            }
+            if (stats.fragmentation < 0.0f || stats.fragmentation > 1.0f) {
+                ST_THROW("Iteration [" << iteration << "]: fragmentation [" << stats.fragmentation << "] must be between 0 and 1");
+            }
+
+            // Sort the live allocations by memory and offset, so that overlapping allocations are next to each other.
+            std::vector<const VulkanAllocation*> allocations;
+            allocations.reserve(resources.size());
+            for (const StressResource& resource : resources) {
+                if (resource.allocation.offset % resource.alignment != 0) {
+                    ST_THROW("Iteration [" << iteration << "]: offset [" << resource.allocation.offset << "] must be aligned to [" << resource.alignment << "]");
+                }
+                if (resource.allocation.offset + resource.allocation.size > resource.allocation.block->size) {
+                    ST_THROW("Iteration [" << iteration << "]: allocation at offset [" << resource.allocation.offset << "] of size [" << resource.allocation.size << "] exceeds its block of size [" << resource.allocation.block->size << "]");
+                }
+                allocations.push_back(&resource.allocation);
+            }
+            std::ranges::sort(allocations, [](const VulkanAllocation* a, const VulkanAllocation* b) {
+                return a->memory != b->memory ? a->memory < b->memory : a->offset < b->offset;
+            });
+            for (u32 i = 1; i < allocations.size(); i++) {
+                const VulkanAllocation& previous = *allocations[i - 1];
+                const VulkanAllocation& current = *allocations[i];
+                if (previous.memory == current.memory && previous.offset + previous.size > current.offset) {
+                    ST_THROW("Iteration [" << iteration << "]: allocation at offset [" << previous.offset << "] of size [" << previous.size << "] overlaps allocation at offset [" << current.offset << "]");
+                }
+            }
+        }
+
+        VkDeviceSize get_buffer_size(VulkanMemoryUsage usage) {
+            VkDeviceSize block_size = usage == VulkanMemoryUsage::PERSISTENT ? persistent_block_size : transient_block_size;
+            f32 size_class = get_float();
+            // Mostly small buffers, some that take up a good part of a block, and a few that get a dedicated block.
+            if (size_class < 0.8f) {
+                return get_int(1, 64 * 1024);
+            }
+            if (size_class < 0.97f) {
+                return get_int(64 * 1024, (u32) (block_size / 2));
+            }
+            return get_int((u32) (block_size / 2) + 1, (u32) (block_size * 2));
+        }
+
+        f32 get_float() {
+            return std::uniform_real_distribution<f32>(0.0f, 1.0f)(generator);
+        }
+
+        u32 get_int(u32 min, u32 max) {
+            return std::uniform_int_distribution<u32>(min, max)(generator);
+        }
+    };
+
+    static void run_memory_allocator_stress(const MemoryAllocatorStressOptions& options) {
+        Dispatcher dispatcher;
+        Window window({
+            .dispatcher = dispatcher,
+            .title = "Memory allocator stress test",
+            .width = 1,
+            .height = 1,
+            .aspect_ratio = 1.0f,
+            .headless = true,
+        });
+        VulkanContext context({
+            .window = window,
+            .app_name = "Memory allocator stress test",
+            .validation_layers_enabled = options.validation_layers_enabled,
+            .headless = true,
+        });
+        VulkanPhysicalDevice physical_device({
+            .context = context,
+        });
+        VulkanDevice device({
+            .name = "Memory allocator stress test device",
+            .physical_device = physical_device,
+        });
+
+        ST_LOG_I("Running [{}] iterations with seed [{}]", options.iterations, options.seed);
+        {
+            MemoryAllocatorStress stress(device, options.seed);
+            stress.run(options.iterations);
+        }
+        device.wait_until_idle();
+    }
+
+    static u32 parse_u32(std::string_view arg, std::string_view value) {
+        u32 result = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (error != std::errc() || end != value.data() + value.size()) {
+            ST_THROW("Invalid value [" << value << "] for option [" << arg << "]");
+        }
+        return result;
+    }
+
+    static MemoryAllocatorStressOptions parse_options(i32 argc, char** argv) {
+        MemoryAllocatorStressOptions options{};
+        for (i32 i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--iterations" && i + 1 < argc) {
+                options.iterations = parse_u32(arg, argv[++i]);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = parse_u32(arg, argv[++i]);
+            } else if (arg == "--validation") {
+                options.validation_layers_enabled = true;
+            } else {
+                ST_THROW("Usage: st_memory_allocator_stress [--iterations <count>] [--seed <seed>] [--validation]");
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    Storytime::initialize_log(Storytime::LogLevel::info);
+    try {
+        Storytime::run_memory_allocator_stress(Storytime::parse_options(argc, argv));
+    } catch (const Storytime::Error& e) {
+        ST_LOG_CRITICAL("Memory allocator stress test failed: {}", e.what());
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        ST_LOG_CRITICAL("Memory allocator stress test failed [{}]: {}", ST_TYPE_NAME(e), e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
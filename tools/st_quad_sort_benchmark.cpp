@@ -0,0 +1,211 @@
+//
+// Quad sort benchmark
+//
+// Measures the CPU cost of the deferred render queue: building the sort keys of random quads with
+// `Renderer::get_quad_sort_key`, sorting them with `radix_sort`, and emitting them to batches in sorted order. Emitting
+// follows the renderer: the instance data of every quad is copied to a batch buffer, and a batch is flushed when it's
+// full, runs out of texture slots, or the quads move on to the other pass. No device is created, so only the CPU side
+// is measured.
+//
+// Runs 100k and 1M quads by default.
+//
+// Usage: st_quad_sort_benchmark [--quads <count>] [--textures <count>] [--layers <count>] [--iterations <count>]
+//                               [--seed <seed>]
+//
+
+#include "graphics/st_renderer.h"
+#include "system/st_clock.h"
+#include "utils/st_radix_sort.h"
+
+#include <charconv>
+#include <random>
+
+namespace Storytime {
+    struct QuadSortBenchmarkOptions {
+        std::vector<u32> quad_counts = { 100'000, 1'000'000 };
+        u32 texture_count = 64;
+        u32 layer_count = 8;
+        u32 iterations = 10;
+        u32 seed = 1;
+    };
+
+    struct BenchmarkQuad {
+        QuadInstanceData instance_data{};
+        u32 texture_id = 0;
+        bool opaque = false;
+    };
+
+    struct QuadSortBenchmarkResult {
+        f64 key_duration_ms = std::numeric_limits<f64>::max();
+        f64 sort_duration_ms = std::numeric_limits<f64>::max();
+        f64 emit_duration_ms = std::numeric_limits<f64>::max();
+        u32 batch_count = 0;
+    };
+
+    class QuadSortBenchmark {
+    private:
+        std::vector<BenchmarkQuad> quads;
+        std::vector<RadixSortEntry> sort_entries;
+        std::vector<RadixSortEntry> sort_scratch;
+        std::vector<QuadInstanceData> batch_quads;
+        std::unordered_map<u32, u32> batch_texture_slots;
+
+    public:
+        QuadSortBenchmark(const QuadSortBenchmarkOptions& options, u32 quad_count)
+            : batch_quads(Renderer::max_quads_per_batch)
+        {
+            std::mt19937 generator(options.seed);
+            std::uniform_int_distribution<u32> texture_distribution(1, options.texture_count);
+            std::uniform_int_distribution<u32> layer_distribution(0, options.layer_count - 1);
+            std::uniform_real_distribution<f32> depth_distribution(-1.0f, 1.0f);
+            std::uniform_real_distribution<f32> opaque_distribution(0.0f, 1.0f);
+
+            quads.resize(quad_count);
+            for (BenchmarkQuad& quad : quads) {
+                quad.instance_data.depth = depth_distribution(generator);
+                quad.instance_data.layer = layer_distribution(generator);
+                quad.texture_id = texture_distribution(generator);
+                quad.opaque = opaque_distribution(generator) < 0.5f;
+            }
+            sort_entries.reserve(quad_count);
+        }
+
+        QuadSortBenchmarkResult run(u32 iterations) {
+            QuadSortBenchmarkResult result{};
+            for (u32 i = 0; i < iterations; i++) {
+                TimePoint key_start_time = Time::now();
+                build_sort_entries();
+                TimePoint sort_start_time = Time::now();
+                radix_sort(sort_entries, sort_scratch);
+                TimePoint emit_start_time = Time::now();
+                result.batch_count = emit_batches();
+                TimePoint end_time = Time::now();
+
+                // The fastest iteration is the least disturbed by the rest of the system.
+                result.key_duration_ms = std::min(result.key_duration_ms, Time::as<Milliseconds>(sort_start_time - key_start_time).count());
+                result.sort_duration_ms = std::min(result.sort_duration_ms, Time::as<Milliseconds>(emit_start_time - sort_start_time).count());
+                result.emit_duration_ms = std::min(result.emit_duration_ms, Time::as<Milliseconds>(end_time - emit_start_time).count());
+            }
+            return result;
+        }
+
+    private:
+        void build_sort_entries() {
+            constexpr u32 view_index = 0;
+            sort_entries.clear();
+            for (u32 i = 0; i < quads.size(); i++) {
+                const BenchmarkQuad& quad = quads[i];
+                sort_entries.push_back({
+                    .key = Renderer::get_quad_sort_key(view_index, quad.opaque, (u16) quad.instance_data.layer, quad.texture_id, quad.instance_data.depth),
+                    .index = i,
+                });
+            }
+        }
+
+        u32 emit_batches() {
+            u32 batch_count = 0;
+            u32 batch_quad_index = 0;
+            bool batch_opaque = false;
+            batch_texture_slots.clear();
+
+            auto flush = [&] {
+                if (batch_quad_index > 0) {
+                    batch_count++;
+                }
+                batch_quad_index = 0;
+                batch_texture_slots.clear();
+            };
+
+            for (const RadixSortEntry& sort_entry : sort_entries) {
+                const BenchmarkQuad& quad = quads[sort_entry.index];
+                if (quad.opaque != batch_opaque) {
+                    flush();
+                    batch_opaque = quad.opaque;
+                }
+
+                auto [texture_slot, texture_added] = batch_texture_slots.try_emplace(quad.texture_id, (u32) batch_texture_slots.size());
+
+                QuadInstanceData& quad_instance_data = batch_quads[batch_quad_index];
+                quad_instance_data = quad.instance_data;
+                quad_instance_data.texture_index = texture_slot->second;
+                batch_quad_index++;
+
+                bool batch_is_full = batch_quad_index >= Renderer::max_quads_per_batch || batch_texture_slots.size() >= Renderer::max_textures_per_batch;
+                if (batch_is_full) {
+                    flush();
+                }
+            }
+            flush();
+
+            return batch_count;
+        }
+    };
+
+    static void run_quad_sort_benchmark(const QuadSortBenchmarkOptions& options) {
+        ST_LOG_I("Sorting quads with [{}] textures on [{}] layers, fastest of [{}] iterations", options.texture_count, options.layer_count, options.iterations);
+        for (u32 quad_count : options.quad_counts) {
+            QuadSortBenchmark benchmark(options, quad_count);
+            QuadSortBenchmarkResult result = benchmark.run(options.iterations);
+            ST_LOG_I(
+                "[{}] quads: keys [{:.3f}] ms, sort [{:.3f}] ms, emit [{:.3f}] ms, sort and emit [{:.3f}] ms, [{}] batches",
+                quad_count,
+                result.key_duration_ms,
+                result.sort_duration_ms,
+                result.emit_duration_ms,
+                result.sort_duration_ms + result.emit_duration_ms,
+                result.batch_count
+            );
+        }
+    }
+
+    static u32 parse_u32(std::string_view arg, std::string_view value) {
+        u32 result = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (error != std::errc() || end != value.data() + value.size()) {
+            ST_THROW("Invalid value [" << value << "] for option [" << arg << "]");
+        }
+        return result;
+    }
+
+    static QuadSortBenchmarkOptions parse_options(i32 argc, char** argv) {
+        QuadSortBenchmarkOptions options{};
+        std::vector<u32> quad_counts;
+        for (i32 i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--quads" && i + 1 < argc) {
+                quad_counts.push_back(parse_u32(arg, argv[++i]));
+            } else if (arg == "--textures" && i + 1 < argc) {
+                options.texture_count = parse_u32(arg, argv[++i]);
+            } else if (arg == "--layers" && i + 1 < argc) {
+                options.layer_count = std::min(parse_u32(arg, argv[++i]), (u32) std::numeric_limits<u16>::max() + 1);
+            } else if (arg == "--iterations" && i + 1 < argc) {
+                options.iterations = parse_u32(arg, argv[++i]);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = parse_u32(arg, argv[++i]);
+            } else {
+                ST_THROW("Usage: st_quad_sort_benchmark [--quads <count>] [--textures <count>] [--layers <count>] [--iterations <count>] [--seed <seed>]");
+            }
+        }
+        if (!quad_counts.empty()) {
+            options.quad_counts = quad_counts;
+        }
+        if (options.texture_count == 0 || options.layer_count == 0 || options.iterations == 0 || std::ranges::contains(options.quad_counts, 0u)) {
+            ST_THROW("Quad, texture, layer and iteration counts must be greater than zero");
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    Storytime::initialize_log(Storytime::LogLevel::info);
+    try {
+        Storytime::run_quad_sort_benchmark(Storytime::parse_options(argc, argv));
+    } catch (const Storytime::Error& e) {
+        ST_LOG_CRITICAL("Quad sort benchmark failed: {}", e.what());
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        ST_LOG_CRITICAL("Quad sort benchmark failed [{}]: {}", ST_TYPE_NAME(e), e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,563 @@
+//
+// Renderer benchmark
+//
+// Runs the engine headless and renders a fixed workload every frame, to measure the CPU side of the renderer:
+//
+// - quads:         Quads that are rendered one by one with `Renderer::render_quad`, in random texture order.
+// - text:          Characters of text that is laid out once and rendered from cached `TextMesh` instances.
+// - text_uncached: The same text, laid out every frame with `BitmapFont::render_text`.
+// - particles:     Particles of a `ParticleSystem` that is kept full, updated on one core and written to the renderer.
+// - sprites:       Sprite entities that are rendered by the `SpriteRenderSystem`.
+// - threads:       Quads that are rendered to `RenderContext`s by 1 to N threads, one thread count after the other.
+//
+// After warming up, the benchmark reports per frame: the CPU time of rendering the scene (from `begin_render` to
+// `end_render`, which includes recording the command buffer), the quads per second of that time, the draw calls, the
+// texture slot lookups that added a texture to a batch, and the instance bytes uploaded. Scenarios that update on the
+// CPU also report the update time, and the threads scenario reports the time it took the threads to render their
+// quads for every thread count.
+//
+// The textures are generated and written to a temporary directory, so the benchmark needs no resources besides the
+// shaders. Like the other headless runs, it also runs on a software device without a display, f.ex. lavapipe:
+//
+//   VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json st_renderer_benchmark --scenario quads
+//
+// Usage: st_renderer_benchmark [--scenario <name>] [--count <count>] [--textures <count>] [--threads <count>]
+//                              [--frames <count>] [--seed <seed>] [--deferred] [--culling] [--no-bindless]
+//                              [--no-direct-writes] [--no-indirect] [--validation]
+//
+
+#include "st_main.h"
+#include "graphics/st_bitmap_font.h"
+#include "graphics/st_particle_system.h"
+#include "graphics/st_render_context.h"
+#include "graphics/st_text_mesh.h"
+#include "scene/st_sprite_render_system.h"
+#include "utils/st_png.h"
+
+#include <charconv>
+#include <cstring>
+#include <random>
+#include <thread>
+
+namespace Storytime {
+    enum class RendererBenchmarkScenario {
+        QUADS,
+        TEXT,
+        TEXT_UNCACHED,
+        PARTICLES,
+        SPRITES,
+        THREADS,
+    };
+
+    struct RendererBenchmarkOptions {
+        RendererBenchmarkScenario scenario = RendererBenchmarkScenario::QUADS;
+        u32 count = 0; /// Defaults to the count of the scenario, see `get_default_count`.
+        u32 texture_count = 16;
+        u32 thread_count = std::clamp(std::thread::hardware_concurrency(), 1u, 8u);
+        u32 frame_count = 300; /// Frames per thread count in the threads scenario.
+        u32 warmup_frame_count = 30;
+        u32 seed = 1;
+        bool deferred_rendering_enabled = false;
+        bool quad_culling_enabled = false;
+        bool bindless_textures_enabled = true;
+        bool direct_instance_writes_enabled = true;
+        bool indirect_draws_enabled = true;
+        bool validation_layers_enabled = false;
+    };
+
+    /// Totals of the measured frames of a run, or of one thread count in the threads scenario.
+    struct RendererBenchmarkTotals {
+        u32 frame_count = 0;
+        f64 scene_render_duration_ms = 0.0;
+        f64 update_duration_ms = 0.0;
+        f64 submit_duration_ms = 0.0;
+        u64 quad_count = 0;
+        u64 draw_calls = 0;
+        u64 texture_count = 0;
+        u64 instance_bytes_uploaded = 0;
+    };
+
+    static constexpr u32 window_width = 1280;
+    static constexpr u32 window_height = 768;
+
+    static constexpr u32 texture_size = 64;
+    static constexpr u32 text_line_length = 100;
+
+    // A font texture of 16 columns and 6 rows of 8x16 glyphs, for the printable ASCII characters.
+    static constexpr u32 font_glyph_width = 8;
+    static constexpr u32 font_glyph_height = 16;
+    static constexpr u32 font_columns = 16;
+    static constexpr u32 font_rows = 6;
+    static constexpr char font_first_character = ' ';
+
+    static u32 get_default_count(RendererBenchmarkScenario scenario) {
+        switch (scenario) {
+            case RendererBenchmarkScenario::TEXT:
+            case RendererBenchmarkScenario::TEXT_UNCACHED:
+                return 10'000;
+            case RendererBenchmarkScenario::PARTICLES:
+                return 200'000;
+            default:
+                return 100'000;
+        }
+    }
+
+    /// The frames that are measured, one run of `frame_count` frames per thread count in the threads scenario.
+    static u32 get_measured_frame_count(const RendererBenchmarkOptions& options) {
+        u32 run_count = options.scenario == RendererBenchmarkScenario::THREADS ? options.thread_count : 1;
+        return options.frame_count * run_count;
+    }
+
+    /// The engine reports the scene render duration of a frame after the frame has ended, so the benchmark renders one
+    /// more frame than it measures to read the duration of the last measured frame.
+    static u32 get_run_frame_count(const RendererBenchmarkOptions& options) {
+        return options.warmup_frame_count + get_measured_frame_count(options) + 1;
+    }
+
+    static std::string_view get_scenario_name(RendererBenchmarkScenario scenario) {
+        switch (scenario) {
+            case RendererBenchmarkScenario::QUADS:
+                return "quads";
+            case RendererBenchmarkScenario::TEXT:
+                return "text";
+            case RendererBenchmarkScenario::TEXT_UNCACHED:
+                return "text_uncached";
+            case RendererBenchmarkScenario::PARTICLES:
+                return "particles";
+            case RendererBenchmarkScenario::SPRITES:
+                return "sprites";
+            case RendererBenchmarkScenario::THREADS:
+                return "threads";
+        }
+        return "unknown";
+    }
+
+    class RendererBenchmark final : public App {
+    private:
+        RendererBenchmarkOptions options;
+        Renderer& renderer;
+        ResourceLoader& resource_loader;
+        Metrics& metrics;
+        std::mt19937 generator;
+        std::filesystem::path texture_directory_path;
+        std::vector<Shared<Texture>> textures;
+        ViewProjection view_projection{};
+        u32 frame_index = 0;
+
+        // Scenarios
+        std::vector<Quad> quads;
+        Unique<BitmapFont> font = nullptr;
+        std::vector<std::string> text_lines;
+        std::vector<TextMesh> text_meshes;
+        Unique<ParticleSystem> particle_system = nullptr;
+        entt::registry entity_registry;
+        Unique<SpriteRenderSystem> sprite_render_system = nullptr;
+        std::vector<RenderContext> render_contexts;
+
+        // Results, one per thread count in the threads scenario
+        std::vector<RendererBenchmarkTotals> totals;
+        f64 last_update_duration_ms = 0.0;
+        f64 last_submit_duration_ms = 0.0;
+
+    public:
+        RendererBenchmark(Storytime& storytime, const RendererBenchmarkOptions& options)
+            : options(options),
+              renderer(storytime.get<Renderer>()),
+              resource_loader(storytime.get<ResourceLoader>()),
+              metrics(storytime.get<Metrics>()),
+              generator(options.seed),
+              texture_directory_path(std::filesystem::temp_directory_path() / "st_renderer_benchmark"),
+              totals(options.scenario == RendererBenchmarkScenario::THREADS ? options.thread_count : 1)
+        {
+            view_projection.projection = glm::ortho(0.0f, (f32) window_width, 0.0f, (f32) window_height, -1.0f, 1.0f);
+            create_textures();
+            create_scenario();
+        }
+
+        ~RendererBenchmark() override {
+            std::error_code error;
+            std::filesystem::remove_all(texture_directory_path, error);
+        }
+
+        void update(f64 timestep) override {
+            if (particle_system == nullptr) {
+                return;
+            }
+            TimePoint start_time = Time::now();
+
+            // Keep the system full, so that every frame updates and renders the same number of particles.
+            particle_system->emit({
+                .count = particle_system->get_capacity() - particle_system->get_count(),
+                .position = { window_width / 2.0f, window_height / 2.0f, 0.0f },
+                .position_variance = { window_width / 2.0f, window_height / 2.0f },
+                .velocity_variance = { 100.0f, 100.0f },
+                .lifetime = 1.0f,
+                .lifetime_variance = 0.5f,
+                .size = 2.0f,
+                .size_variance = 1.0f,
+            });
+            particle_system->update(timestep);
+
+            last_update_duration_ms = Time::as<Microseconds>(Time::now() - start_time).count() / 1000.0;
+        }
+
+        void render() override {
+            // The scene render duration is set by the engine after the frame has ended, so it's read one frame late.
+            if (is_measured_frame(frame_index - 1)) {
+                get_totals(frame_index - 1).scene_render_duration_ms += metrics.scene_render_duration_ms;
+            }
+
+            renderer.set_view_projection(view_projection);
+
+            switch (options.scenario) {
+                case RendererBenchmarkScenario::QUADS:
+                    for (const Quad& quad : quads) {
+                        renderer.render_quad(quad);
+                    }
+                    break;
+                case RendererBenchmarkScenario::TEXT:
+                    for (TextMesh& text_mesh : text_meshes) {
+                        text_mesh.render();
+                    }
+                    break;
+                case RendererBenchmarkScenario::TEXT_UNCACHED:
+                    for (u32 i = 0; i < text_lines.size(); i++) {
+                        font->render_text(text_lines[i], get_text_config(i));
+                    }
+                    break;
+                case RendererBenchmarkScenario::PARTICLES:
+                    particle_system->render();
+                    break;
+                case RendererBenchmarkScenario::SPRITES:
+                    sprite_render_system->render();
+                    break;
+                case RendererBenchmarkScenario::THREADS:
+                    render_threads(get_thread_count(frame_index));
+                    break;
+            }
+        }
+
+        void render_imgui() override {
+            // The renderer's counters are complete once the scene has been rendered, and are reset when the frame ends.
+            if (is_measured_frame(frame_index)) {
+                RendererBenchmarkTotals& frame_totals = get_totals(frame_index);
+                frame_totals.frame_count++;
+                frame_totals.update_duration_ms += last_update_duration_ms;
+                frame_totals.submit_duration_ms += last_submit_duration_ms;
+                frame_totals.quad_count += metrics.quad_count;
+                frame_totals.draw_calls += metrics.draw_calls;
+                frame_totals.texture_count += metrics.texture_count;
+                frame_totals.instance_bytes_uploaded += metrics.instance_bytes_uploaded;
+            }
+            frame_index++;
+        }
+
+        void log_results() const {
+            ST_LOG_I("Scenario [{}] with [{}] items and [{}] textures, [{}] frames after [{}] warmup frames", get_scenario_name(options.scenario), options.count, options.texture_count, options.frame_count, options.warmup_frame_count);
+            for (u32 i = 0; i < totals.size(); i++) {
+                const RendererBenchmarkTotals& result = totals[i];
+                if (result.frame_count == 0) {
+                    continue;
+                }
+                f64 frame_count = result.frame_count;
+                f64 scene_render_duration_ms = result.scene_render_duration_ms / frame_count;
+                f64 quad_count = result.quad_count / frame_count;
+                if (options.scenario == RendererBenchmarkScenario::THREADS) {
+                    ST_LOG_I("[{}] threads: submit [{:.3f}] ms/frame", i + 1, result.submit_duration_ms / frame_count);
+                }
+                if (options.scenario == RendererBenchmarkScenario::PARTICLES) {
+                    ST_LOG_I("Update [{:.3f}] ms/frame", result.update_duration_ms / frame_count);
+                }
+                ST_LOG_I(
+                    "Scene render [{:.3f}] ms/frame, [{:.0f}] quads/frame, [{:.0f}] quads/s, [{:.1f}] draw calls/frame, [{:.1f}] texture slots/frame, [{:.0f}] instance bytes uploaded/frame",
+                    scene_render_duration_ms,
+                    quad_count,
+                    scene_render_duration_ms > 0.0 ? quad_count / (scene_render_duration_ms / 1000.0) : 0.0,
+                    result.draw_calls / frame_count,
+                    result.texture_count / frame_count,
+                    result.instance_bytes_uploaded / frame_count
+                );
+            }
+        }
+
+    private:
+        bool is_measured_frame(u32 index) const {
+            return index >= options.warmup_frame_count && index < options.warmup_frame_count + get_measured_frame_count(options);
+        }
+
+        RendererBenchmarkTotals& get_totals(u32 index) {
+            u32 totals_index = std::min((index - options.warmup_frame_count) / options.frame_count, (u32) totals.size() - 1);
+            return totals[totals_index];
+        }
+
+        /// The threads scenario warms up with one thread, and then renders `frame_count` frames per thread count.
+        u32 get_thread_count(u32 index) const {
+            if (index < options.warmup_frame_count) {
+                return 1;
+            }
+            return std::min((index - options.warmup_frame_count) / options.frame_count + 1, options.thread_count);
+        }
+
+        void render_threads(u32 thread_count) {
+            TimePoint start_time = Time::now();
+            {
+                std::vector<std::jthread> threads;
+                threads.reserve(thread_count);
+                for (u32 i = 0; i < thread_count; i++) {
+                    threads.emplace_back([this, i, thread_count] {
+                        u64 first_quad = (u64) quads.size() * i / thread_count;
+                        u64 end_quad = (u64) quads.size() * (i + 1) / thread_count;
+                        for (u64 j = first_quad; j < end_quad; j++) {
+                            render_contexts[i].render_quad(quads[j]);
+                        }
+                    });
+                }
+            }
+            last_submit_duration_ms = Time::as<Microseconds>(Time::now() - start_time).count() / 1000.0;
+
+            for (u32 i = 0; i < thread_count; i++) {
+                renderer.submit_render_context(render_contexts[i]);
+            }
+        }
+
+        void create_textures() {
+            std::filesystem::create_directories(texture_directory_path);
+
+            std::uniform_int_distribution<u32> color_distribution(64, 255);
+            std::vector<u8> pixels(texture_size * texture_size * 4);
+            for (u32 i = 0; i < options.texture_count; i++) {
+                std::array<u8, 4> color = { (u8) color_distribution(generator), (u8) color_distribution(generator), (u8) color_distribution(generator), 255 };
+                for (u32 j = 0; j < texture_size * texture_size; j++) {
+                    std::memcpy(pixels.data() + j * 4, color.data(), color.size());
+                }
+                std::filesystem::path path = texture_directory_path / std::format("texture_{}.png", i);
+                write_png(path, texture_size, texture_size, pixels.data());
+                textures.push_back(resource_loader.load_texture(path));
+            }
+        }
+
+        Shared<Texture> create_font_texture() const {
+            u32 width = font_columns * font_glyph_width;
+            u32 height = font_rows * font_glyph_height;
+
+            // Every glyph is a filled box with a transparent border, which is enough to sample like a real font.
+            std::vector<u8> pixels(width * height * 4);
+            for (u32 y = 0; y < height; y++) {
+                for (u32 x = 0; x < width; x++) {
+                    u32 glyph_x = x % font_glyph_width;
+                    u32 glyph_y = y % font_glyph_height;
+                    bool border = glyph_x == 0 || glyph_y == 0 || glyph_x == font_glyph_width - 1 || glyph_y == font_glyph_height - 1;
+                    std::memset(pixels.data() + (y * width + x) * 4, 255, 3);
+                    pixels[(y * width + x) * 4 + 3] = border ? 0 : 255;
+                }
+            }
+            std::filesystem::path path = texture_directory_path / "font.png";
+            write_png(path, width, height, pixels.data());
+            return resource_loader.load_texture(path);
+        }
+
+        void create_scenario() {
+            switch (options.scenario) {
+                case RendererBenchmarkScenario::QUADS:
+                case RendererBenchmarkScenario::THREADS:
+                    create_quads();
+                    break;
+                case RendererBenchmarkScenario::TEXT:
+                case RendererBenchmarkScenario::TEXT_UNCACHED:
+                    create_text();
+                    break;
+                case RendererBenchmarkScenario::PARTICLES:
+                    particle_system = std::make_unique<ParticleSystem>(ParticleSystemConfig{
+                        .renderer = renderer,
+                        .capacity = options.count,
+                    });
+                    break;
+                case RendererBenchmarkScenario::SPRITES:
+                    create_sprites();
+                    break;
+            }
+            if (options.scenario == RendererBenchmarkScenario::THREADS) {
+                for (u32 i = 0; i < options.thread_count; i++) {
+                    render_contexts.emplace_back(RenderContextConfig{
+                        .name = std::format("Benchmark render context {}", i + 1),
+                        .priority = (i32) i,
+                    });
+                }
+            }
+        }
+
+        void create_quads() {
+            std::uniform_int_distribution<u32> texture_distribution(0, options.texture_count - 1);
+            std::uniform_real_distribution<f32> x_distribution(0.0f, (f32) window_width);
+            std::uniform_real_distribution<f32> y_distribution(0.0f, (f32) window_height);
+            std::uniform_real_distribution<f32> size_distribution(4.0f, 32.0f);
+
+            // The textures are picked at random for every quad, so that the batches have to look up texture slots
+            // instead of seeing the same texture over and over.
+            quads.resize(options.count);
+            for (Quad& quad : quads) {
+                f32 size = size_distribution(generator);
+                quad.model = glm::translate(glm::mat4(1.0f), glm::vec3(x_distribution(generator), y_distribution(generator), 0.0f));
+                quad.model = glm::scale(quad.model, glm::vec3(size, size, 1.0f));
+                quad.texture = textures[texture_distribution(generator)];
+            }
+        }
+
+        void create_text() {
+            std::map<const char, std::pair<u32, u32>> coordinates;
+            for (u32 i = 0; i < font_columns * font_rows; i++) {
+                coordinates[(char) (font_first_character + i)] = { i % font_columns, i / font_columns };
+            }
+            font = std::make_unique<BitmapFont>(BitmapFontConfig{
+                .renderer = renderer,
+                .texture = create_font_texture(),
+                .glyph_width = (f32) font_glyph_width,
+                .glyph_height = (f32) font_glyph_height,
+                .coordinates = coordinates,
+            });
+
+            std::uniform_int_distribution<u32> character_distribution(0, font_columns * font_rows - 2); // Without DEL.
+            u32 line_count = (options.count + text_line_length - 1) / text_line_length;
+            for (u32 i = 0; i < line_count; i++) {
+                u32 line_length = std::min(text_line_length, options.count - i * text_line_length);
+                std::string line(line_length, ' ');
+                for (char& character : line) {
+                    character = (char) (font_first_character + character_distribution(generator));
+                }
+                text_lines.push_back(line);
+            }
+
+            text_meshes.reserve(text_lines.size());
+            for (u32 i = 0; i < text_lines.size(); i++) {
+                text_meshes.emplace_back(*font, text_lines[i], get_text_config(i));
+            }
+        }
+
+        static BitmapTextConfig get_text_config(u32 line_index) {
+            constexpr f32 font_size = 8.0f;
+            return {
+                .position = { 0.0f, (f32) (line_index * (u32) font_size % window_height), 0.0f },
+                .font_size = font_size,
+            };
+        }
+
+        void create_sprites() {
+            sprite_render_system = std::make_unique<SpriteRenderSystem>(SpriteRenderSystemConfig{
+                .entity_registry = entity_registry,
+                .renderer = renderer,
+            });
+
+            std::uniform_int_distribution<u32> texture_distribution(0, options.texture_count - 1);
+            std::uniform_int_distribution<u32> layer_distribution(0, 3);
+            std::uniform_real_distribution<f32> x_distribution(0.0f, (f32) window_width);
+            std::uniform_real_distribution<f32> y_distribution(0.0f, (f32) window_height);
+            std::uniform_real_distribution<f32> rotation_distribution(0.0f, glm::two_pi<f32>());
+
+            for (u32 i = 0; i < options.count; i++) {
+                entt::entity entity = entity_registry.create();
+                entity_registry.emplace<Transform>(entity, Transform{
+                    .position = { x_distribution(generator), y_distribution(generator), 0.0f },
+                    .rotation = rotation_distribution(generator),
+                    .scale = { 16.0f, 16.0f },
+                });
+                entity_registry.emplace<SpriteRenderer>(entity, SpriteRenderer{
+                    .texture = textures[texture_distribution(generator)],
+                    .layer = (u16) layer_distribution(generator),
+                });
+            }
+            sprite_render_system->sort();
+        }
+    };
+
+    static u32 parse_u32(std::string_view arg, std::string_view value) {
+        u32 result = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+        if (error != std::errc() || end != value.data() + value.size()) {
+            ST_THROW("Invalid value [" << value << "] for option [" << arg << "]");
+        }
+        return result;
+    }
+
+    static RendererBenchmarkScenario parse_scenario(std::string_view value) {
+        for (RendererBenchmarkScenario scenario : { RendererBenchmarkScenario::QUADS, RendererBenchmarkScenario::TEXT, RendererBenchmarkScenario::TEXT_UNCACHED, RendererBenchmarkScenario::PARTICLES, RendererBenchmarkScenario::SPRITES, RendererBenchmarkScenario::THREADS }) {
+            if (value == get_scenario_name(scenario)) {
+                return scenario;
+            }
+        }
+        ST_THROW("Unknown scenario [" << value << "], expected quads, text, text_uncached, particles, sprites or threads");
+    }
+
+    static RendererBenchmarkOptions parse_options(i32 argc, char** argv) {
+        RendererBenchmarkOptions options{};
+        for (i32 i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--scenario" && i + 1 < argc) {
+                options.scenario = parse_scenario(argv[++i]);
+            } else if (arg == "--count" && i + 1 < argc) {
+                options.count = parse_u32(arg, argv[++i]);
+            } else if (arg == "--textures" && i + 1 < argc) {
+                options.texture_count = parse_u32(arg, argv[++i]);
+            } else if (arg == "--threads" && i + 1 < argc) {
+                options.thread_count = parse_u32(arg, argv[++i]);
+            } else if (arg == "--frames" && i + 1 < argc) {
+                options.frame_count = parse_u32(arg, argv[++i]);
+            } else if (arg == "--seed" && i + 1 < argc) {
+                options.seed = parse_u32(arg, argv[++i]);
+            } else if (arg == "--deferred") {
+                options.deferred_rendering_enabled = true;
+            } else if (arg == "--culling") {
+                options.quad_culling_enabled = true;
+            } else if (arg == "--no-bindless") {
+                options.bindless_textures_enabled = false;
+            } else if (arg == "--no-direct-writes") {
+                options.direct_instance_writes_enabled = false;
+            } else if (arg == "--no-indirect") {
+                options.indirect_draws_enabled = false;
+            } else if (arg == "--validation") {
+                options.validation_layers_enabled = true;
+            } else {
+                ST_THROW("Usage: st_renderer_benchmark [--scenario <name>] [--count <count>] [--textures <count>] [--threads <count>] [--frames <count>] [--seed <seed>] [--deferred] [--culling] [--no-bindless] [--no-direct-writes] [--no-indirect] [--validation]");
+            }
+        }
+        if (options.count == 0) {
+            options.count = get_default_count(options.scenario);
+        }
+        if (options.texture_count == 0 || options.thread_count == 0 || options.frame_count == 0) {
+            ST_THROW("Texture, thread and frame counts must be greater than zero");
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    Storytime::RendererBenchmarkOptions options{};
+    try {
+        options = Storytime::parse_options(argc, argv);
+    } catch (const Storytime::Error& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Storytime::Config config{};
+    config.app_name = "Renderer benchmark";
+    config.command_line_arguments = Storytime::CommandLineArguments(argc, argv);
+    config.window_width = (i32) Storytime::window_width;
+    config.window_height = (i32) Storytime::window_height;
+    config.headless = true;
+    config.headless_frame_count = Storytime::get_run_frame_count(options);
+    config.rendering_bindless_textures_enabled = options.bindless_textures_enabled;
+    config.rendering_direct_instance_writes_enabled = options.direct_instance_writes_enabled;
+    config.rendering_deferred_enabled = options.deferred_rendering_enabled;
+    config.rendering_quad_culling_enabled = options.quad_culling_enabled;
+    config.rendering_indirect_draws_enabled = options.indirect_draws_enabled;
+    config.rendering_pipeline_cache_enabled = false;
+    config.vulkan_validation_layers_enabled = options.validation_layers_enabled;
+    config.imgui_docking_enabled = false;
+    config.imgui_viewports_enabled = false;
+
+    ST_MAIN(config, [&options](Storytime::Storytime& storytime) {
+        Storytime::RendererBenchmark benchmark(storytime, options);
+        storytime.run(benchmark);
+        benchmark.log_results();
+    });
+}
@@ -0,0 +1,174 @@
+//
+// Texture cooker
+//
+// Cooks images (PNG, JPG, etc.) into `.sttex` texture files with a precomputed mip chain, so that they can be uploaded
+// straight to the GPU at load time without being decoded or having their mipmap generated.
+//
+// Usage: st_texture_cooker [--premultiplied-alpha] [--no-mipmap] <input image> <output texture file>
+//
+
+#include "graphics/st_texture_file.h"
+
+#include <stb_image.h>
+
+namespace Storytime {
+    struct TextureCookerOptions {
+        std::filesystem::path input_path;
+        std::filesystem::path output_path;
+        bool premultiplied_alpha = false;
+        bool mipmap = true;
+    };
+
+    static f32 srgb_to_linear(f32 value) {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    static f32 linear_to_srgb(f32 value) {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    static u8 to_unorm8(f32 value) {
+        return (u8) std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f);
+    }
+
+    // A mip level with linear color channels, so that filtering and blending is done in linear space like the GPU
+    // does for sRGB images.
+    struct LinearImage {
+        u32 width = 0;
+        u32 height = 0;
+        std::vector<glm::vec4> pixels;
+    };
+
+    static LinearImage to_linear_image(const u8* pixels, u32 width, u32 height, bool premultiplied_alpha) {
+        std::array<f32, 256> srgb_table{};
+        for (u32 i = 0; i < srgb_table.size(); i++) {
+            srgb_table[i] = srgb_to_linear((f32) i / 255.0f);
+        }
+
+        LinearImage image{};
+        image.width = width;
+        image.height = height;
+        image.pixels.resize((u64) width * height);
+        for (u64 i = 0; i < image.pixels.size(); i++) {
+            const u8* pixel = pixels + i * 4;
+            f32 alpha = (f32) pixel[3] / 255.0f;
+            glm::vec4 color = { srgb_table[pixel[0]], srgb_table[pixel[1]], srgb_table[pixel[2]], alpha };
+            if (premultiplied_alpha) {
+                color.r *= alpha;
+                color.g *= alpha;
+                color.b *= alpha;
+            }
+            image.pixels[i] = color;
+        }
+        return image;
+    }
+
+    // Box filter every 2x2 block of pixels into one pixel. Odd dimensions are handled by clamping to the last row
+    // or column.
+    static LinearImage downsample(const LinearImage& image) {
+        LinearImage mip_level{};
+        mip_level.width = std::max(image.width / 2, 1u);
+        mip_level.height = std::max(image.height / 2, 1u);
+        mip_level.pixels.resize((u64) mip_level.width * mip_level.height);
+        for (u32 y = 0; y < mip_level.height; y++) {
+            u32 y0 = std::min(y * 2, image.height - 1);
+            u32 y1 = std::min(y * 2 + 1, image.height - 1);
+            for (u32 x = 0; x < mip_level.width; x++) {
+                u32 x0 = std::min(x * 2, image.width - 1);
+                u32 x1 = std::min(x * 2 + 1, image.width - 1);
+                glm::vec4 sum = image.pixels[(u64) y0 * image.width + x0]
+                    + image.pixels[(u64) y0 * image.width + x1]
+                    + image.pixels[(u64) y1 * image.width + x0]
+                    + image.pixels[(u64) y1 * image.width + x1];
+                mip_level.pixels[(u64) y * mip_level.width + x] = sum * 0.25f;
+            }
+        }
+        return mip_level;
+    }
+
+    static std::vector<u8> to_srgb_pixels(const LinearImage& image) {
+        std::vector<u8> pixels(image.pixels.size() * 4);
+        for (u64 i = 0; i < image.pixels.size(); i++) {
+            const glm::vec4& color = image.pixels[i];
+            pixels[i * 4 + 0] = to_unorm8(linear_to_srgb(color.r));
+            pixels[i * 4 + 1] = to_unorm8(linear_to_srgb(color.g));
+            pixels[i * 4 + 2] = to_unorm8(linear_to_srgb(color.b));
+            pixels[i * 4 + 3] = to_unorm8(color.a);
+        }
+        return pixels;
+    }
+
+    static void cook_texture(const TextureCookerOptions& options) {
+        i32 width = 0;
+        i32 height = 0;
+        i32 channels = 0;
+        u8* pixels = stbi_load(options.input_path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (pixels == nullptr) {
+            ST_THROW("Could not load image [" << options.input_path << "]: " << stbi_failure_reason());
+        }
+
+        LinearImage image = to_linear_image(pixels, (u32) width, (u32) height, options.premultiplied_alpha);
+        stbi_image_free(pixels);
+
+        // Same mip chain length as textures that have their mipmap generated at load time.
+        u32 mip_level_count = options.mipmap ? (u32) std::floor(std::log2(std::max(width, height))) + 1 : 1;
+
+        std::vector<std::vector<u8>> mip_levels;
+        mip_levels.reserve(mip_level_count);
+        mip_levels.push_back(to_srgb_pixels(image));
+        for (u32 i = 1; i < mip_level_count; i++) {
+            image = downsample(image);
+            mip_levels.push_back(to_srgb_pixels(image));
+        }
+
+        TextureFileHeader header{};
+        header.format = TextureFile::format;
+        header.width = (u32) width;
+        header.height = (u32) height;
+        header.flags = options.premultiplied_alpha ? (u32) TextureFileFlag::PREMULTIPLIED_ALPHA : 0;
+
+        if (options.output_path.has_parent_path()) {
+            std::filesystem::create_directories(options.output_path.parent_path());
+        }
+        TextureFile::write(options.output_path, header, mip_levels);
+
+        ST_LOG_I("Cooked texture [{}] ({}x{}, {} mip levels) to [{}]", options.input_path.string(), width, height, mip_level_count, options.output_path.string());
+    }
+
+    static TextureCookerOptions parse_options(i32 argc, char** argv) {
+        TextureCookerOptions options{};
+        std::vector<std::filesystem::path> paths;
+        for (i32 i = 1; i < argc; i++) {
+            std::string_view arg = argv[i];
+            if (arg == "--premultiplied-alpha") {
+                options.premultiplied_alpha = true;
+            } else if (arg == "--no-mipmap") {
+                options.mipmap = false;
+            } else if (arg.starts_with("--")) {
+                ST_THROW("Unknown option [" << arg << "]");
+            } else {
+                paths.emplace_back(arg);
+            }
+        }
+        if (paths.size() != 2) {
+            ST_THROW("Usage: st_texture_cooker [--premultiplied-alpha] [--no-mipmap] <input image> <output texture file>");
+        }
+        options.input_path = paths[0];
+        options.output_path = paths[1];
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    Storytime::initialize_log(Storytime::LogLevel::info);
+    try {
+        Storytime::cook_texture(Storytime::parse_options(argc, argv));
+    } catch (const Storytime::Error& e) {
+        ST_LOG_CRITICAL("Could not cook texture: {}", e.what());
+        return EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        ST_LOG_CRITICAL("Could not cook texture [{}]: {}", ST_TYPE_NAME(e), e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}